@@ -1,4 +1,5 @@
 #include "model_converter.h"
+#include "../core/model_blob_store.h"
 #ifdef PLATFORM_ANDROID
 #include <android/log.h>
 #define LOG_ERROR(...) __android_log_print(ANDROID_LOG_ERROR, "ModelConverter", __VA_ARGS__)
@@ -29,19 +30,20 @@ public:
         try {
             // Load source model
             auto model_data = LoadModel(input_path, source_format);
-            if (model_data.empty()) {
+            if (!model_data) {
                 return false;
             }
 
             // Convert model
             auto converted_data = ConvertModelFormat(
-                model_data, source_format, target_format, config);
+                model_data->data(), model_data->size(), source_format, target_format, config);
             if (converted_data.empty()) {
                 return false;
             }
 
             // Validate if required
-            if (config.validate && !ValidateModel(converted_data, target_format)) {
+            if (config.validate &&
+                !ValidateModel(converted_data.data(), converted_data.size(), target_format)) {
                 return false;
             }
 
@@ -87,30 +89,21 @@ public:
     bool ValidateModel(const std::string& model_path, ModelFormat format) {
         try {
             auto model_data = LoadModel(model_path, format);
-            return ValidateModel(model_data, format);
+            return model_data && ValidateModel(model_data->data(), model_data->size(), format);
         } catch (const std::exception& e) {
             return false;
         }
     }
 
 private:
-    std::vector<uint8_t> LoadModel(const std::string& path, ModelFormat format) {
-        std::ifstream file(path, std::ios::binary | std::ios::ate);
-        if (!file.is_open()) {
+    // Source models are read through the shared blob store, so converting a
+    // model an engine already has loaded reuses its mapping
+    std::shared_ptr<const core::ModelBlob> LoadModel(const std::string& path, ModelFormat format) {
+        auto blob = core::ModelBlobStore::Instance().Acquire(path);
+        if (!blob) {
             LOG_ERROR("Failed to open model file: %s", path.c_str());
-            return std::vector<uint8_t>();
         }
-
-        std::streamsize size = file.tellg();
-        file.seekg(0, std::ios::beg);
-
-        std::vector<uint8_t> buffer(size);
-        if (!file.read(reinterpret_cast<char*>(buffer.data()), size)) {
-            LOG_ERROR("Failed to read model file");
-            return std::vector<uint8_t>();
-        }
-
-        return buffer;
+        return blob;
     }
 
     bool SaveModel(const std::string& path, const std::vector<uint8_t>& data) {
@@ -124,7 +117,8 @@ private:
     }
 
     std::vector<uint8_t> ConvertModelFormat(
-        const std::vector<uint8_t>& input_data,
+        const uint8_t* input_data,
+        size_t input_size,
         ModelFormat source_format,
         ModelFormat target_format,
         const ConversionConfig& config) {
@@ -136,31 +130,32 @@ private:
         switch (source_format) {
             case ModelFormat::ONNX:
                 if (target_format == ModelFormat::TFLITE) {
-                    converted_data = ConvertOnnxToTflite(input_data, config);
+                    converted_data = ConvertOnnxToTflite(input_data, input_size, config);
                 } else if (target_format == ModelFormat::PYTORCH) {
-                    converted_data = ConvertOnnxToPytorch(input_data, config);
+                    converted_data = ConvertOnnxToPytorch(input_data, input_size, config);
                 }
                 break;
 
             case ModelFormat::TFLITE:
                 if (target_format == ModelFormat::ONNX) {
-                    converted_data = ConvertTfliteToOnnx(input_data, config);
+                    converted_data = ConvertTfliteToOnnx(input_data, input_size, config);
                 } else if (target_format == ModelFormat::PYTORCH) {
-                    converted_data = ConvertTfliteToPytorch(input_data, config);
+                    converted_data = ConvertTfliteToPytorch(input_data, input_size, config);
                 }
                 break;
 
             case ModelFormat::PYTORCH:
                 if (target_format == ModelFormat::ONNX) {
-                    converted_data = ConvertPytorchToOnnx(input_data, config);
+                    converted_data = ConvertPytorchToOnnx(input_data, input_size, config);
                 } else if (target_format == ModelFormat::TFLITE) {
-                    converted_data = ConvertPytorchToTflite(input_data, config);
+                    converted_data = ConvertPytorchToTflite(input_data, input_size, config);
                 }
                 break;
 
             case ModelFormat::CUSTOM:
                 if (auto it = custom_formats_.find("custom"); it != custom_formats_.end()) {
-                    converted_data = it->second.deserializer(input_data);
+                    converted_data = it->second.deserializer(
+                        std::vector<uint8_t>(input_data, input_data + input_size));
                 }
                 break;
 
@@ -172,22 +167,23 @@ private:
         return converted_data;
     }
 
-    bool ValidateModel(const std::vector<uint8_t>& model_data, ModelFormat format) {
-        if (model_data.empty()) {
+    bool ValidateModel(const uint8_t* model_data, size_t model_size, ModelFormat format) {
+        if (!model_data || model_size == 0) {
             return false;
         }
 
         // Format validation implementations
         switch (format) {
             case ModelFormat::ONNX:
-                return ValidateOnnxModel(model_data);
+                return ValidateOnnxModel(model_data, model_size);
             case ModelFormat::TFLITE:
-                return ValidateTfliteModel(model_data);
+                return ValidateTfliteModel(model_data, model_size);
             case ModelFormat::PYTORCH:
-                return ValidatePytorchModel(model_data);
+                return ValidatePytorchModel(model_data, model_size);
             case ModelFormat::CUSTOM:
                 if (auto it = custom_formats_.find("custom"); it != custom_formats_.end()) {
-                    return it->second.validator(std::string(model_data.begin(), model_data.end()));
+                    return it->second.validator(std::string(
+                        reinterpret_cast<const char*>(model_data), model_size));
                 }
                 return false;
             default:
@@ -195,7 +191,7 @@ private:
         }
     }
 
-    std::vector<uint8_t> ConvertOnnxToTflite(const std::vector<uint8_t>& input_data, const ConversionConfig& config) {
+    std::vector<uint8_t> ConvertOnnxToTflite(const uint8_t* input_data, size_t /*input_size*/, const ConversionConfig& config) {
         // Parse ONNX model
         std::vector<uint8_t> tflite_data;
         // Use TensorFlow Lite converter API to convert ONNX model
@@ -203,52 +199,52 @@ private:
         return tflite_data;
     }
 
-    std::vector<uint8_t> ConvertOnnxToPytorch(const std::vector<uint8_t>& input_data, const ConversionConfig& config) {
+    std::vector<uint8_t> ConvertOnnxToPytorch(const uint8_t* input_data, size_t /*input_size*/, const ConversionConfig& config) {
         // Convert ONNX to PyTorch using torch.onnx
         std::vector<uint8_t> pytorch_data;
         // Apply PyTorch-specific optimizations
         return pytorch_data;
     }
 
-    std::vector<uint8_t> ConvertTfliteToOnnx(const std::vector<uint8_t>& input_data, const ConversionConfig& config) {
+    std::vector<uint8_t> ConvertTfliteToOnnx(const uint8_t* input_data, size_t /*input_size*/, const ConversionConfig& config) {
         // Convert TFLite model to ONNX format
         std::vector<uint8_t> onnx_data;
         // Handle custom ops specified in config
         return onnx_data;
     }
 
-    std::vector<uint8_t> ConvertTfliteToPytorch(const std::vector<uint8_t>& input_data, const ConversionConfig& config) {
+    std::vector<uint8_t> ConvertTfliteToPytorch(const uint8_t* input_data, size_t input_size, const ConversionConfig& config) {
         // Convert TFLite to PyTorch through ONNX as intermediate
-        auto onnx_data = ConvertTfliteToOnnx(input_data, config);
-        return ConvertOnnxToPytorch(onnx_data, config);
+        auto onnx_data = ConvertTfliteToOnnx(input_data, input_size, config);
+        return ConvertOnnxToPytorch(onnx_data.data(), onnx_data.size(), config);
     }
 
-    std::vector<uint8_t> ConvertPytorchToOnnx(const std::vector<uint8_t>& input_data, const ConversionConfig& config) {
+    std::vector<uint8_t> ConvertPytorchToOnnx(const uint8_t* input_data, size_t /*input_size*/, const ConversionConfig& config) {
         // Use torch.onnx.export to convert PyTorch model
         std::vector<uint8_t> onnx_data;
         // Preserve metadata if specified in config
         return onnx_data;
     }
 
-    std::vector<uint8_t> ConvertPytorchToTflite(const std::vector<uint8_t>& input_data, const ConversionConfig& config) {
+    std::vector<uint8_t> ConvertPytorchToTflite(const uint8_t* input_data, size_t input_size, const ConversionConfig& config) {
         // Convert PyTorch to TFLite through ONNX as intermediate
-        auto onnx_data = ConvertPytorchToOnnx(input_data, config);
-        return ConvertOnnxToTflite(onnx_data, config);
+        auto onnx_data = ConvertPytorchToOnnx(input_data, input_size, config);
+        return ConvertOnnxToTflite(onnx_data.data(), onnx_data.size(), config);
     }
 
-    bool ValidateOnnxModel(const std::vector<uint8_t>& model_data) {
+    bool ValidateOnnxModel(const uint8_t* model_data, size_t /*model_size*/) {
         // Check ONNX model structure and operators
         // Verify tensor shapes and types
         return true;
     }
 
-    bool ValidateTfliteModel(const std::vector<uint8_t>& model_data) {
+    bool ValidateTfliteModel(const uint8_t* model_data, size_t /*model_size*/) {
         // Validate TFLite flatbuffer format
         // Check model compatibility with target device
         return true;
     }
 
-    bool ValidatePytorchModel(const std::vector<uint8_t>& model_data) {
+    bool ValidatePytorchModel(const uint8_t* model_data, size_t /*model_size*/) {
         // Verify PyTorch model format
         // Check for supported operations
         return true;
@@ -0,0 +1,176 @@
+#include "model_blob_store.h"
+#ifdef PLATFORM_ANDROID
+#include <android/log.h>
+#define LOG_ERROR(...) __android_log_print(ANDROID_LOG_ERROR, "ModelBlobStore", __VA_ARGS__)
+#else
+#include <cstdio>
+#define LOG_ERROR(...) fprintf(stderr, "ModelBlobStore: " __VA_ARGS__)
+#endif
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+
+namespace mobileai {
+namespace core {
+
+namespace {
+
+uint64_t HashContents(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+} // namespace
+
+ModelBlob::ModelBlob(std::string path, const uint8_t* data, size_t size)
+    : path_(std::move(path)), data_(data), size_(size) {}
+
+uint64_t ModelBlob::content_hash() const {
+    std::call_once(hash_once_, [this] { content_hash_ = HashContents(data_, size_); });
+    return content_hash_;
+}
+
+ModelBlob::~ModelBlob() {
+    if (data_ && size_ > 0) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+}
+
+ModelBlobStore& ModelBlobStore::Instance() {
+    static ModelBlobStore store;
+    return store;
+}
+
+std::shared_ptr<const ModelBlob> ModelBlobStore::Acquire(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        LOG_ERROR("Cannot map model file %s\n", path.c_str());
+        return nullptr;
+    }
+
+    FileIdentity identity;
+    identity.device = st.st_dev;
+    identity.inode = st.st_ino;
+    identity.size = static_cast<uint64_t>(st.st_size);
+    identity.mtime_ns = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = by_path_.find(path);
+        if (it != by_path_.end() && it->second.identity == identity) {
+            if (auto blob = it->second.blob.lock()) {
+                return blob;
+            }
+        }
+    }
+
+    // Map and compare outside the lock; loads of unrelated models proceed in
+    // parallel, and a racing load of the same file is resolved below
+    auto mapped = Map(path, identity.size);
+    if (!mapped) {
+        return nullptr;
+    }
+
+    // Compare against the blobs of the same size until one matches; blobs
+    // registered by racing loads in the meantime are compared on the next pass
+    std::vector<std::shared_ptr<const ModelBlob>> compared;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        auto candidates = Candidates(mapped->size(), compared);
+        if (candidates.empty()) {
+            break;
+        }
+        lock.unlock();
+        for (auto& candidate : candidates) {
+            if (std::memcmp(candidate->data(), mapped->data(), mapped->size()) == 0) {
+                lock.lock();
+                by_path_[path] = PathEntry{identity, candidate};
+                return candidate;
+            }
+            compared.push_back(std::move(candidate));
+        }
+        lock.lock();
+    }
+
+    PruneExpired();
+    by_size_.emplace(mapped->size(), mapped);
+    by_path_[path] = PathEntry{identity, mapped};
+    return mapped;
+}
+
+size_t ModelBlobStore::GetBlobCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t count = 0;
+    for (const auto& entry : by_size_) {
+        if (!entry.second.expired()) {
+            count++;
+        }
+    }
+    return count;
+}
+
+size_t ModelBlobStore::GetMappedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t bytes = 0;
+    for (const auto& entry : by_size_) {
+        if (auto blob = entry.second.lock()) {
+            bytes += blob->size();
+        }
+    }
+    return bytes;
+}
+
+std::shared_ptr<const ModelBlob> ModelBlobStore::Map(const std::string& path, size_t size) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("Failed to open %s: %s\n", path.c_str(), strerror(errno));
+        return nullptr;
+    }
+
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        LOG_ERROR("Failed to map %s: %s\n", path.c_str(), strerror(errno));
+        return nullptr;
+    }
+
+    // Parsers read the whole file front to back right after loading
+    madvise(addr, size, MADV_WILLNEED);
+
+    return std::shared_ptr<const ModelBlob>(
+        new ModelBlob(path, static_cast<const uint8_t*>(addr), size));
+}
+
+std::vector<std::shared_ptr<const ModelBlob>> ModelBlobStore::Candidates(
+    size_t size, const std::vector<std::shared_ptr<const ModelBlob>>& compared) const {
+    std::vector<std::shared_ptr<const ModelBlob>> candidates;
+    auto range = by_size_.equal_range(size);
+    for (auto it = range.first; it != range.second; ++it) {
+        auto blob = it->second.lock();
+        if (blob && std::find(compared.begin(), compared.end(), blob) == compared.end()) {
+            candidates.push_back(std::move(blob));
+        }
+    }
+    return candidates;
+}
+
+void ModelBlobStore::PruneExpired() {
+    for (auto it = by_size_.begin(); it != by_size_.end();) {
+        it = it->second.expired() ? by_size_.erase(it) : std::next(it);
+    }
+    for (auto it = by_path_.begin(); it != by_path_.end();) {
+        it = it->second.blob.expired() ? by_path_.erase(it) : std::next(it);
+    }
+}
+
+} // namespace core
+} // namespace mobileai
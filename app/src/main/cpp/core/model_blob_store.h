@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mobileai {
+namespace core {
+
+// Read-only, memory-mapped model file. The mapping is released when the last
+// shared_ptr to the blob goes away.
+class ModelBlob {
+public:
+    ~ModelBlob();
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    const std::string& path() const { return path_; }
+
+    // 64-bit FNV-1a of the file contents; stable across paths and processes.
+    // Computed on first use, which reads the whole mapping.
+    uint64_t content_hash() const;
+
+private:
+    friend class ModelBlobStore;
+    ModelBlob(std::string path, const uint8_t* data, size_t size);
+
+    std::string path_;
+    const uint8_t* data_;
+    size_t size_;
+    mutable std::once_flag hash_once_;
+    mutable uint64_t content_hash_ = 0;
+
+    ModelBlob(const ModelBlob&) = delete;
+    ModelBlob& operator=(const ModelBlob&) = delete;
+};
+
+// Process-wide cache of model blobs. Loading the same path again, or a
+// different path with identical contents, returns the existing mapping
+// instead of another copy of the weights. Contents are only compared, byte
+// by byte, against blobs of the same size. The store only holds weak
+// references, so unused blobs are unmapped as soon as their last user
+// releases them.
+class ModelBlobStore {
+public:
+    static ModelBlobStore& Instance();
+
+    // Returns nullptr if the file cannot be opened or mapped. A file that has
+    // changed on disk since it was mapped is mapped afresh.
+    std::shared_ptr<const ModelBlob> Acquire(const std::string& path);
+
+    size_t GetBlobCount() const;
+    size_t GetMappedBytes() const;
+
+private:
+    ModelBlobStore() = default;
+
+    // Cheap identity used to tell whether a path still refers to the file
+    // that was mapped, without rehashing it
+    struct FileIdentity {
+        uint64_t device = 0;
+        uint64_t inode = 0;
+        uint64_t size = 0;
+        int64_t mtime_ns = 0;
+
+        bool operator==(const FileIdentity& other) const {
+            return device == other.device && inode == other.inode &&
+                   size == other.size && mtime_ns == other.mtime_ns;
+        }
+    };
+
+    struct PathEntry {
+        FileIdentity identity;
+        std::weak_ptr<const ModelBlob> blob;
+    };
+
+    std::shared_ptr<const ModelBlob> Map(const std::string& path, size_t size);
+    // Live blobs of size bytes not yet in compared. Called with mutex_ held.
+    std::vector<std::shared_ptr<const ModelBlob>> Candidates(
+        size_t size, const std::vector<std::shared_ptr<const ModelBlob>>& compared) const;
+    void PruneExpired();
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, PathEntry> by_path_;
+    std::unordered_multimap<uint64_t, std::weak_ptr<const ModelBlob>> by_size_;
+
+    ModelBlobStore(const ModelBlobStore&) = delete;
+    ModelBlobStore& operator=(const ModelBlobStore&) = delete;
+};
+
+} // namespace core
+} // namespace mobileai
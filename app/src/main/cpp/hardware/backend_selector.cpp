@@ -0,0 +1,119 @@
+#include "backend_selector.h"
+#include <algorithm>
+
+namespace mobileai {
+namespace hardware {
+
+BackendSelector::BackendSelector(std::vector<std::string> backends,
+                                 const BackendSelectorConfig& config)
+    : config_(config), rng_(std::random_device{}()) {
+    for (auto& name : backends) {
+        Arm arm;
+        arm.name = std::move(name);
+        arms_.push_back(std::move(arm));
+    }
+}
+
+size_t BackendSelector::Select() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    requests_++;
+    if (arms_.size() < 2) {
+        return arms_.empty() ? 0 : Choose(0);
+    }
+
+    // Measure every backend before trusting the estimates. Selections rather
+    // than samples are counted, so concurrent requests spread out.
+    size_t least_tried = 0;
+    for (size_t i = 1; i < arms_.size(); i++) {
+        if (arms_[i].selections < arms_[least_tried].selections) {
+            least_tried = i;
+        }
+    }
+    if (arms_[least_tried].selections < config_.min_samples) {
+        return Choose(least_tried);
+    }
+
+    // A backend that lost long ago may have cooled down or been freed
+    for (size_t i = 0; i < arms_.size(); i++) {
+        if (requests_ - arms_[i].last_selected > config_.max_staleness) {
+            return Choose(i);
+        }
+    }
+
+    const size_t best = BestLocked();
+    if (std::uniform_real_distribution<float>(0.0f, 1.0f)(rng_) < config_.exploration_rate) {
+        size_t other = std::uniform_int_distribution<size_t>(0, arms_.size() - 2)(rng_);
+        return Choose(other >= best ? other + 1 : other);
+    }
+    return Choose(best);
+}
+
+size_t BackendSelector::Best() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return BestLocked();
+}
+
+void BackendSelector::Record(size_t backend, float latency_ms, bool success) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (backend >= arms_.size()) {
+        return;
+    }
+
+    Arm& arm = arms_[backend];
+    if (!success) {
+        arm.failures++;
+        latency_ms = 2.0f * std::max(latency_ms, arm.latency_ms);
+    }
+    arm.last_latency_ms = latency_ms;
+    arm.latency_ms = arm.samples == 0
+        ? latency_ms
+        : arm.latency_ms + config_.smoothing * (latency_ms - arm.latency_ms);
+    arm.samples++;
+}
+
+std::vector<BackendStats> BackendSelector::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<BackendStats> stats;
+    for (const auto& arm : arms_) {
+        BackendStats backend;
+        backend.name = arm.name;
+        backend.selections = arm.selections;
+        backend.failures = arm.failures;
+        backend.latency_ms = arm.latency_ms;
+        backend.last_latency_ms = arm.last_latency_ms;
+        stats.push_back(std::move(backend));
+    }
+    return stats;
+}
+
+void BackendSelector::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& arm : arms_) {
+        std::string name = std::move(arm.name);
+        arm = Arm();
+        arm.name = std::move(name);
+    }
+    requests_ = 0;
+}
+
+// Unmeasured backends rank last; index 0 wins when nothing is measured yet
+size_t BackendSelector::BestLocked() const {
+    size_t best = 0;
+    for (size_t i = 1; i < arms_.size(); i++) {
+        const Arm& arm = arms_[i];
+        if (arm.samples > 0 &&
+            (arms_[best].samples == 0 || arm.latency_ms < arms_[best].latency_ms)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+size_t BackendSelector::Choose(size_t backend) {
+    arms_[backend].selections++;
+    arms_[backend].last_selected = requests_;
+    return backend;
+}
+
+} // namespace hardware
+} // namespace mobileai
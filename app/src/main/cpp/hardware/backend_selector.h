@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace mobileai {
+namespace hardware {
+
+struct BackendSelectorConfig {
+    float smoothing = 0.2f;          // Weight of the newest sample in a backend's latency estimate
+    float exploration_rate = 0.05f;  // Share of requests sent to a backend other than the fastest
+    size_t min_samples = 3;          // Requests each backend gets before the estimates are trusted
+    size_t max_staleness = 200;      // Re-measure a backend not chosen for this many requests
+};
+
+struct BackendStats {
+    std::string name;
+    uint64_t selections = 0;
+    uint64_t failures = 0;
+    float latency_ms = 0.0f;         // Current smoothed estimate
+    float last_latency_ms = 0.0f;
+};
+
+// Online choice between backends that can all run the same model, by
+// measured latency rather than by preference. An epsilon-greedy bandit over
+// exponentially smoothed latencies: most requests go to the backend that is
+// currently fastest, a few explore the others. Recent samples dominate the
+// estimates and unpicked backends are re-measured periodically, so the
+// choice follows thermal throttling and contention as they come and go.
+// A failed run counts as a doubled latency. Thread-safe.
+class BackendSelector {
+public:
+    explicit BackendSelector(std::vector<std::string> backends,
+                             const BackendSelectorConfig& config = BackendSelectorConfig());
+
+    // Backend index for the next request
+    size_t Select();
+
+    // Fastest backend by current estimate, without exploring
+    size_t Best() const;
+
+    // Report how long the request on backend took, queueing included
+    void Record(size_t backend, float latency_ms, bool success);
+
+    std::vector<BackendStats> GetStats() const;
+    void Reset();
+
+private:
+    struct Arm {
+        std::string name;
+        uint64_t selections = 0;
+        uint64_t samples = 0;
+        uint64_t failures = 0;
+        uint64_t last_selected = 0;   // Request count at the last selection
+        float latency_ms = 0.0f;
+        float last_latency_ms = 0.0f;
+    };
+
+    size_t BestLocked() const;
+    size_t Choose(size_t backend);
+
+    BackendSelectorConfig config_;
+    mutable std::mutex mutex_;
+    std::vector<Arm> arms_;
+    uint64_t requests_ = 0;
+    std::minstd_rand rng_;
+};
+
+} // namespace hardware
+} // namespace mobileai
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -37,7 +39,8 @@ public:
         UNSUPPORTED_OPERATION,
         INVALID_INPUT,
         HARDWARE_ERROR,
-        RESOURCE_EXHAUSTED
+        RESOURCE_EXHAUSTED,
+        CANCELLED
     };
 
     virtual ~HardwareAccelerator() = default;
@@ -53,6 +56,31 @@ public:
                                  std::vector<float>& output,
                                  PerformanceMetrics* metrics = nullptr) = 0;
 
+    // Run inference on caller-owned buffers. The default implementation stages
+    // through the vector overload; accelerators that can consume raw buffers
+    // should override it.
+    virtual ErrorCode RunInference(const float* input, size_t input_size,
+                                 float* output, size_t output_capacity,
+                                 size_t* output_size,
+                                 PerformanceMetrics* metrics = nullptr) {
+        thread_local std::vector<float> staged_input;
+        thread_local std::vector<float> staged_output;
+        staged_input.assign(input, input + input_size);
+
+        ErrorCode result = RunInference(staged_input, staged_output, metrics);
+        if (result != ErrorCode::SUCCESS) {
+            return result;
+        }
+        if (output_size) {
+            *output_size = staged_output.size();
+        }
+        if (staged_output.size() > output_capacity) {
+            return ErrorCode::RESOURCE_EXHAUSTED;
+        }
+        std::copy(staged_output.begin(), staged_output.end(), output);
+        return ErrorCode::SUCCESS;
+    }
+
     // Get the accelerator type and capabilities
     virtual std::string GetAcceleratorType() const = 0;
     virtual std::vector<std::string> GetSupportedOperations() const = 0;
@@ -67,6 +95,10 @@ public:
     virtual void ReleaseResources() = 0;
     virtual bool ResetState() = 0;
 
+    // Device memory held for loaded models and I/O buffers, for residency
+    // accounting. Accelerators that cannot report it return 0.
+    virtual size_t GetMemoryUsageBytes() const { return 0; }
+
     // Version information
     virtual std::string GetDriverVersion() const = 0;
     virtual std::string GetFirmwareVersion() const = 0;
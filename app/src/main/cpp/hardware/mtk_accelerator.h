@@ -22,6 +22,7 @@ public:
     bool IsAvailable() const override;
     std::vector<std::string> GetSupportedOperations() const override;
     bool SupportsOperation(const std::string& operation) const override;
+    using HardwareAccelerator::RunInference;
     ErrorCode RunInference(const std::vector<float>& input,
                           std::vector<float>& output,
                           PerformanceMetrics* metrics = nullptr) override;
@@ -27,6 +27,7 @@ public:
     // Base class interface implementation
     ErrorCode Initialize() override;
     bool IsAvailable() const override;
+    using HardwareAccelerator::RunInference;
     ErrorCode RunInference(const std::vector<float>& input,
                           std::vector<float>& output,
                           PerformanceMetrics* metrics = nullptr) override;
@@ -0,0 +1,240 @@
+#include "batch_scheduler.h"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace mobileai {
+namespace inference {
+
+class BatchScheduler::Impl {
+public:
+    Impl(ModelEngine& engine, const BatchSchedulerConfig& config)
+        : engine_(engine), config_(config), running_(false) {}
+
+    ~Impl() {
+        Stop();
+    }
+
+    bool Start() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) return true;
+
+        // The engine rejects batches above its own limit
+        const size_t engine_max = std::max<size_t>(engine_.GetModelConfig().max_batch_size, 1);
+        max_batch_size_ = config_.max_batch_size > 0
+            ? std::min(config_.max_batch_size, engine_max)
+            : engine_max;
+
+        running_ = true;
+        worker_ = std::thread(&Impl::WorkerLoop, this);
+        return true;
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) return;
+            running_ = false;
+        }
+        queue_cv_.notify_all();
+        if (worker_.joinable()) {
+            worker_.join();
+        }
+
+        // Fail whatever was still queued so no caller blocks forever
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (Request* request : queue_) {
+            request->success = false;
+            request->done = true;
+        }
+        queue_.clear();
+        done_cv_.notify_all();
+    }
+
+    bool IsRunning() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return running_;
+    }
+
+    bool RunInference(const std::vector<float>& input,
+                      std::vector<float>& output,
+                      InferenceMetrics* metrics) {
+        Request request;
+        request.input = &input;
+        request.output = &output;
+        request.metrics = metrics;
+        request.enqueue_time = std::chrono::steady_clock::now();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!running_ || queue_.size() >= config_.max_queue_size) {
+            stats_.requests_rejected++;
+            return false;
+        }
+
+        queue_.push_back(&request);
+        queue_cv_.notify_one();
+        done_cv_.wait(lock, [&request] { return request.done; });
+        return request.success;
+    }
+
+    BatchSchedulerStats GetStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        BatchSchedulerStats stats = stats_;
+        if (stats.batches_executed > 0) {
+            stats.average_batch_size = static_cast<float>(stats.requests_completed) /
+                                       stats.batches_executed;
+        }
+        if (stats.requests_completed > 0) {
+            stats.average_queue_delay_ms = static_cast<float>(total_queue_delay_ms_ /
+                                                              stats.requests_completed);
+        }
+        return stats;
+    }
+
+    void ResetStats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_ = BatchSchedulerStats();
+        total_queue_delay_ms_ = 0.0;
+    }
+
+private:
+    // Lives on the calling thread's stack until done is set
+    struct Request {
+        const std::vector<float>* input = nullptr;
+        std::vector<float>* output = nullptr;
+        InferenceMetrics* metrics = nullptr;
+        std::chrono::steady_clock::time_point enqueue_time;
+        bool success = false;
+        bool done = false;
+    };
+
+    void WorkerLoop() {
+        std::vector<Request*> batch;
+        batch.reserve(max_batch_size_);
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                queue_cv_.wait(lock, [this] { return !running_ || !queue_.empty(); });
+                if (!running_) return;
+
+                // Hold the batch open until it fills or the oldest request's
+                // queueing budget runs out
+                auto deadline = queue_.front()->enqueue_time + config_.max_queue_delay;
+                queue_cv_.wait_until(lock, deadline, [this] {
+                    return !running_ || queue_.size() >= max_batch_size_;
+                });
+                if (!running_) return;
+
+                TakeBatch(batch);
+            }
+
+            ExecuteBatch(batch);
+            batch.clear();
+        }
+    }
+
+    // Pull up to max_batch_size_ requests whose input size matches the oldest
+    // one; requests of other sizes stay queued for a later batch
+    void TakeBatch(std::vector<Request*>& batch) {
+        const size_t sample_size = queue_.front()->input->size();
+        for (auto it = queue_.begin(); it != queue_.end() && batch.size() < max_batch_size_;) {
+            if ((*it)->input->size() == sample_size) {
+                batch.push_back(*it);
+                it = queue_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void ExecuteBatch(const std::vector<Request*>& batch) {
+        auto dispatch_time = std::chrono::steady_clock::now();
+
+        // Staging vectors keep their capacity between batches
+        batch_inputs_.resize(batch.size());
+        for (size_t i = 0; i < batch.size(); i++) {
+            batch_inputs_[i].assign(batch[i]->input->begin(), batch[i]->input->end());
+        }
+
+        InferenceMetrics batch_metrics{};
+        bool success = engine_.RunBatchInference(batch_inputs_, batch_outputs_, &batch_metrics);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < batch.size(); i++) {
+            Request* request = batch[i];
+            request->success = success && i < batch_outputs_.size();
+            if (request->success) {
+                // Hand the result buffer to the caller and recycle theirs
+                request->output->swap(batch_outputs_[i]);
+            }
+            if (request->metrics) {
+                *request->metrics = batch_metrics;
+            }
+            request->done = true;
+
+            double queue_delay_ms = std::chrono::duration<double, std::milli>(
+                dispatch_time - request->enqueue_time).count();
+            total_queue_delay_ms_ += queue_delay_ms;
+            stats_.max_queue_delay_ms = std::max(stats_.max_queue_delay_ms,
+                                                 static_cast<float>(queue_delay_ms));
+        }
+        stats_.requests_completed += batch.size();
+        stats_.batches_executed++;
+        done_cv_.notify_all();
+    }
+
+    ModelEngine& engine_;
+    BatchSchedulerConfig config_;
+    size_t max_batch_size_ = 1;
+    bool running_;
+    std::thread worker_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable queue_cv_;
+    std::condition_variable done_cv_;
+    std::deque<Request*> queue_;
+
+    // Worker-thread only
+    std::vector<std::vector<float>> batch_inputs_;
+    std::vector<std::vector<float>> batch_outputs_;
+
+    BatchSchedulerStats stats_;
+    double total_queue_delay_ms_ = 0.0;
+};
+
+BatchScheduler::BatchScheduler(ModelEngine& engine, const BatchSchedulerConfig& config)
+    : pImpl(std::make_unique<Impl>(engine, config)) {}
+
+BatchScheduler::~BatchScheduler() = default;
+
+bool BatchScheduler::Start() {
+    return pImpl->Start();
+}
+
+void BatchScheduler::Stop() {
+    pImpl->Stop();
+}
+
+bool BatchScheduler::IsRunning() const {
+    return pImpl->IsRunning();
+}
+
+bool BatchScheduler::RunInference(const std::vector<float>& input,
+                                  std::vector<float>& output,
+                                  InferenceMetrics* metrics) {
+    return pImpl->RunInference(input, output, metrics);
+}
+
+BatchSchedulerStats BatchScheduler::GetStats() const {
+    return pImpl->GetStats();
+}
+
+void BatchScheduler::ResetStats() {
+    pImpl->ResetStats();
+}
+
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "model_engine.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mobileai {
+namespace inference {
+
+struct BatchSchedulerConfig {
+    size_t max_batch_size = 0;                     // 0 = ModelConfig::max_batch_size, which also caps it
+    std::chrono::microseconds max_queue_delay{2000}; // Longest a request waits for peers
+    size_t max_queue_size = 256;                   // Requests beyond this are rejected
+};
+
+struct BatchSchedulerStats {
+    uint64_t requests_completed = 0;
+    uint64_t requests_rejected = 0;
+    uint64_t batches_executed = 0;
+    float average_batch_size = 0.0f;
+    float average_queue_delay_ms = 0.0f;
+    float max_queue_delay_ms = 0.0f;
+};
+
+// Merges concurrent single-sample requests into batches for one ModelEngine.
+// A batch is dispatched as soon as it is full or its oldest request has
+// waited max_queue_delay, so queueing adds at most that much latency.
+// While running, the scheduler's worker thread is the only caller of the
+// engine's inference methods.
+class BatchScheduler {
+public:
+    explicit BatchScheduler(ModelEngine& engine,
+                            const BatchSchedulerConfig& config = BatchSchedulerConfig());
+    ~BatchScheduler();
+
+    bool Start();
+    void Stop();
+    bool IsRunning() const;
+
+    // Blocks until the batch containing this request has run; output receives
+    // only this request's slice of the batched result
+    bool RunInference(const std::vector<float>& input,
+                     std::vector<float>& output,
+                     InferenceMetrics* metrics = nullptr);
+
+    BatchSchedulerStats GetStats() const;
+    void ResetStats();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+
+    BatchScheduler(const BatchScheduler&) = delete;
+    BatchScheduler& operator=(const BatchScheduler&) = delete;
+};
+
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+namespace mobileai {
+namespace inference {
+
+// Cancels one or more inference requests, explicitly through Cancel() or
+// implicitly once the deadline passes. Cancel() may be called from any
+// thread while a request is running.
+class CancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    CancellationToken() = default;
+    explicit CancellationToken(Clock::time_point deadline) : deadline_(deadline) {}
+
+    void Cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+    bool IsCancelled() const {
+        return cancelled_.load(std::memory_order_relaxed) ||
+               (deadline_ != Clock::time_point::max() && Clock::now() >= deadline_);
+    }
+
+    Clock::time_point GetDeadline() const { return deadline_; }
+
+private:
+    std::atomic<bool> cancelled_{false};
+    Clock::time_point deadline_ = Clock::time_point::max();
+
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+};
+
+} // namespace inference
+} // namespace mobileai
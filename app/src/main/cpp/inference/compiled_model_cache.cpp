@@ -0,0 +1,185 @@
+#include "compiled_model_cache.h"
+#ifdef PLATFORM_ANDROID
+#include <android/log.h>
+#define LOG_ERROR(...) __android_log_print(ANDROID_LOG_ERROR, "CompiledModelCache", __VA_ARGS__)
+#else
+#include <cstdio>
+#define LOG_ERROR(...) fprintf(stderr, "CompiledModelCache: " __VA_ARGS__)
+#endif
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+namespace mobileai {
+namespace inference {
+
+namespace {
+
+// Bump when the manifest layout or artifact naming changes
+constexpr int CACHE_FORMAT_VERSION = 1;
+
+constexpr const char* ARTIFACT_SUFFIX = ".bin";
+constexpr const char* MANIFEST_SUFFIX = ".manifest";
+
+uint64_t HashString(const std::string& value, uint64_t hash = 0xcbf29ce484222325ULL) {
+    for (unsigned char c : value) {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+} // namespace
+
+CompiledModelCache::CompiledModelCache(const std::string& cache_dir, uint64_t max_size_bytes)
+    : cache_dir_(cache_dir), max_size_bytes_(max_size_bytes), enabled_(false) {
+    std::error_code ec;
+    std::filesystem::create_directories(cache_dir_, ec);
+    enabled_ = !ec && std::filesystem::is_directory(cache_dir_, ec);
+    if (!enabled_) {
+        LOG_ERROR("Cache directory %s is not usable; caching disabled\n", cache_dir_.c_str());
+    }
+}
+
+std::string CompiledModelCache::Lookup(const CompiledModelKey& key) {
+    if (!enabled_) {
+        return "";
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string artifact_path = GetArtifactPath(key);
+    std::ifstream manifest(ManifestPath(key));
+    if (!manifest) {
+        return "";
+    }
+
+    // The manifest repeats the full key (guarding against fingerprint
+    // collisions) followed by the artifact size it was committed with
+    std::string expected = DescribeKey(key);
+    std::string recorded((std::istreambuf_iterator<char>(manifest)),
+                         std::istreambuf_iterator<char>());
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(artifact_path, ec);
+    if (ec || recorded != expected + "size=" + std::to_string(size) + "\n") {
+        manifest.close();
+        std::filesystem::remove(ManifestPath(key), ec);
+        std::filesystem::remove(artifact_path, ec);
+        return "";
+    }
+
+    // Refresh the entry's position in the LRU order
+    std::filesystem::last_write_time(ManifestPath(key),
+                                     std::filesystem::file_time_type::clock::now(), ec);
+    return artifact_path;
+}
+
+std::string CompiledModelCache::GetArtifactPath(const CompiledModelKey& key) const {
+    return (std::filesystem::path(cache_dir_) / (Fingerprint(key) + ARTIFACT_SUFFIX)).string();
+}
+
+bool CompiledModelCache::Commit(const CompiledModelKey& key) {
+    if (!enabled_) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(GetArtifactPath(key), ec);
+    if (ec || size == 0) {
+        return false;
+    }
+
+    // Write-then-rename so a crash never leaves a manifest for a partial entry
+    std::string manifest_path = ManifestPath(key);
+    std::string temp_path = manifest_path + ".tmp";
+    {
+        std::ofstream manifest(temp_path, std::ios::trunc);
+        manifest << DescribeKey(key) << "size=" << size << "\n";
+        if (!manifest) {
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, manifest_path, ec);
+    if (ec) {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+
+    Trim();
+    return true;
+}
+
+void CompiledModelCache::Invalidate(const CompiledModelKey& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::error_code ec;
+    std::filesystem::remove(ManifestPath(key), ec);
+    std::filesystem::remove(GetArtifactPath(key), ec);
+}
+
+std::string CompiledModelCache::Fingerprint(const CompiledModelKey& key) const {
+    std::stringstream name;
+    name << key.backend << "_" << key.artifact << "_"
+         << std::hex << std::setw(16) << std::setfill('0') << HashString(DescribeKey(key));
+    return name.str();
+}
+
+std::string CompiledModelCache::ManifestPath(const CompiledModelKey& key) const {
+    return (std::filesystem::path(cache_dir_) / (Fingerprint(key) + MANIFEST_SUFFIX)).string();
+}
+
+std::string CompiledModelCache::DescribeKey(const CompiledModelKey& key) const {
+    std::stringstream description;
+    description << "format=" << CACHE_FORMAT_VERSION << "\n"
+                << "model=" << std::hex << key.model_hash << std::dec << "\n"
+                << "backend=" << key.backend << "\n"
+                << "artifact=" << key.artifact << "\n"
+                << "accelerator=" << key.accelerator << "\n"
+                << "threads=" << key.num_threads << "\n"
+                << "runtime=" << key.runtime_version << "\n";
+    return description.str();
+}
+
+void CompiledModelCache::Trim() {
+    struct Entry {
+        std::filesystem::path manifest;
+        std::filesystem::file_time_type last_used;
+        uint64_t size;
+    };
+
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    std::error_code ec;
+    for (const auto& file : std::filesystem::directory_iterator(cache_dir_, ec)) {
+        if (file.path().extension() != MANIFEST_SUFFIX) {
+            continue;
+        }
+        std::filesystem::path artifact = file.path();
+        artifact.replace_extension(ARTIFACT_SUFFIX);
+        uint64_t size = std::filesystem::file_size(artifact, ec);
+        if (ec) {
+            continue;
+        }
+        entries.push_back({file.path(), std::filesystem::last_write_time(file.path(), ec), size});
+        total += size;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.last_used < b.last_used;
+    });
+
+    // Always keep the newest entry, even if it alone exceeds the budget
+    for (size_t i = 0; i + 1 < entries.size() && total > max_size_bytes_; i++) {
+        std::filesystem::path artifact = entries[i].manifest;
+        artifact.replace_extension(ARTIFACT_SUFFIX);
+        std::filesystem::remove(entries[i].manifest, ec);
+        std::filesystem::remove(artifact, ec);
+        total -= entries[i].size;
+    }
+}
+
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace mobileai {
+namespace inference {
+
+// Everything that makes a prepared artifact reusable. Changing any field
+// selects a different cache entry, so stale artifacts are never loaded.
+struct CompiledModelKey {
+    uint64_t model_hash = 0;      // ModelBlob::content_hash() of the source model
+    std::string backend;          // "tflite", "onnx", ...
+    std::string artifact;         // What is stored, e.g. "ort_optimized", "xnnpack_weights"
+    std::string accelerator;      // Accelerator type and driver version, or "cpu"
+    int num_threads = 1;
+    std::string runtime_version;  // Backend library version that produced it
+};
+
+// Content-addressed on-disk store for prepared model artifacts: optimized
+// ONNX graphs, packed delegate weights and the like. Each entry is an
+// artifact file plus a manifest written only after the artifact is complete;
+// an entry without a matching manifest is treated as absent and removed.
+class CompiledModelCache {
+public:
+    explicit CompiledModelCache(const std::string& cache_dir,
+                                uint64_t max_size_bytes = 256ull * 1024 * 1024);
+
+    bool IsEnabled() const { return enabled_; }
+
+    // Path of a valid cached artifact, or empty on a miss
+    std::string Lookup(const CompiledModelKey& key);
+
+    // Where a backend should write a new artifact for this key
+    std::string GetArtifactPath(const CompiledModelKey& key) const;
+
+    // Record the artifact at GetArtifactPath(key) as complete, then trim the
+    // cache to its size budget (least recently used entries first)
+    bool Commit(const CompiledModelKey& key);
+
+    // Drop an entry, e.g. after a backend rejected the cached artifact
+    void Invalidate(const CompiledModelKey& key);
+
+private:
+    std::string Fingerprint(const CompiledModelKey& key) const;
+    std::string ManifestPath(const CompiledModelKey& key) const;
+    std::string DescribeKey(const CompiledModelKey& key) const;
+    void Trim();
+
+    std::string cache_dir_;
+    uint64_t max_size_bytes_;
+    bool enabled_;
+    std::mutex mutex_;
+};
+
+} // namespace inference
+} // namespace mobileai
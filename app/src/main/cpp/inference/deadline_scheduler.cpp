@@ -0,0 +1,401 @@
+#include "deadline_scheduler.h"
+#include <algorithm>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace mobileai {
+namespace inference {
+
+class DeadlineScheduler::Impl {
+public:
+    explicit Impl(const DeadlineSchedulerConfig& config) : config_(config) {}
+
+    ~Impl() {
+        Stop();
+    }
+
+    bool AddModel(const std::string& name, ModelEngine& engine) {
+        auto model = std::make_shared<Model>();
+        model->engine = &engine;
+        model->capacity = std::max<size_t>(engine.GetModelConfig().max_execution_contexts, 1);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        return models_.emplace(name, std::move(model)).second;
+    }
+
+    void RemoveModel(const std::string& name) {
+        std::vector<std::unique_ptr<Request>> pending;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto it = models_.find(name);
+            if (it == models_.end()) {
+                return;
+            }
+            std::shared_ptr<Model> model = it->second;
+            models_.erase(it);
+
+            for (auto& queue : queues_) {
+                for (auto request = queue.begin(); request != queue.end();) {
+                    if ((*request)->model == model) {
+                        pending.emplace_back(*request);
+                        request = queue.erase(request);
+                    } else {
+                        ++request;
+                    }
+                }
+            }
+            drained_cv_.wait(lock, [&model] { return model->in_flight == 0; });
+        }
+
+        for (auto& request : pending) {
+            request->result.error = hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
+            Complete(*request);
+        }
+    }
+
+    bool Start() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) return true;
+
+        num_workers_ = config_.num_workers;
+        if (num_workers_ == 0) {
+            for (const auto& model : models_) {
+                num_workers_ += model.second->capacity;
+            }
+        }
+        num_workers_ = std::max<size_t>(num_workers_, 1);
+        // Background work always keeps at least one worker
+        background_limit_ = num_workers_ - std::min(config_.reserved_interactive_workers, num_workers_ - 1);
+
+        running_ = true;
+        for (size_t i = 0; i < num_workers_; i++) {
+            workers_.emplace_back(&Impl::WorkerLoop, this);
+        }
+        return true;
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) return;
+            running_ = false;
+        }
+        cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+        workers_.clear();
+
+        // Fail whatever was still queued so no caller waits forever
+        std::vector<std::unique_ptr<Request>> pending;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& queue : queues_) {
+                for (Request* request : queue) {
+                    pending.emplace_back(request);
+                }
+                queue.clear();
+            }
+        }
+        for (auto& request : pending) {
+            request->result.error = hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
+            Complete(*request);
+        }
+    }
+
+    bool IsRunning() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return running_;
+    }
+
+    std::future<InferenceResult> Submit(const std::string& model,
+                                        std::vector<float> input,
+                                        Clock::time_point deadline,
+                                        RequestPriority priority,
+                                        ModelEngine::CompletionCallback callback) {
+        auto request = std::make_unique<Request>();
+        request->input = std::move(input);
+        request->deadline = deadline;
+        if (config_.drop_expired) {
+            request->token = std::make_unique<CancellationToken>(deadline);
+        }
+        request->priority = priority;
+        request->callback = std::move(callback);
+        request->enqueue_time = Clock::now();
+        std::future<InferenceResult> future = request->promise.get_future();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        request->result.request_id = ++request_id_;
+        auto it = models_.find(model);
+        if (!running_ || it == models_.end() || QueuedRequests() >= config_.max_queue_size) {
+            Stats(priority).requests_rejected++;
+            request->result.error = running_ && it != models_.end()
+                ? hardware::HardwareAccelerator::ErrorCode::RESOURCE_EXHAUSTED
+                : hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
+            lock.unlock();
+            Complete(*request);
+            return future;
+        }
+
+        request->model = it->second;
+        queues_[QueueIndex(priority)].insert(request.release());
+        lock.unlock();
+        cv_.notify_one();
+        return future;
+    }
+
+    bool RunInference(const std::string& model,
+                      const std::vector<float>& input,
+                      std::vector<float>& output,
+                      Clock::time_point deadline,
+                      RequestPriority priority,
+                      InferenceMetrics* metrics) {
+        InferenceResult result = Submit(model, input, deadline, priority, nullptr).get();
+        if (result.success) {
+            output.swap(result.output);
+        }
+        if (metrics) {
+            *metrics = result.metrics;
+        }
+        return result.success;
+    }
+
+    DeadlineSchedulerStats GetStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        DeadlineSchedulerStats stats = stats_;
+        DeadlineClassStats* classes[] = {&stats.interactive, &stats.background};
+        for (size_t i = 0; i < 2; i++) {
+            if (classes[i]->requests_completed > 0) {
+                classes[i]->average_queue_delay_ms = static_cast<float>(
+                    total_queue_delay_ms_[i] / classes[i]->requests_completed);
+            }
+        }
+        return stats;
+    }
+
+    void ResetStats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_ = DeadlineSchedulerStats();
+        total_queue_delay_ms_[0] = total_queue_delay_ms_[1] = 0.0;
+    }
+
+private:
+    struct Model {
+        ModelEngine* engine = nullptr;
+        size_t capacity = 1;     // The engine's max_execution_contexts
+        size_t in_flight = 0;
+    };
+
+    struct Request {
+        std::shared_ptr<Model> model;
+        std::vector<float> input;
+        Clock::time_point deadline;
+        std::unique_ptr<CancellationToken> token;   // Cancels at the deadline (drop_expired)
+        RequestPriority priority = RequestPriority::INTERACTIVE;
+        ModelEngine::CompletionCallback callback;
+        std::promise<InferenceResult> promise;
+        InferenceResult result;
+        Clock::time_point enqueue_time;
+        Clock::time_point dispatch_time;
+        bool expired = false;    // Dropped under drop_expired without running
+    };
+
+    // Earliest deadline first; request ids keep arrival order among equal deadlines
+    struct EarlierDeadline {
+        bool operator()(const Request* a, const Request* b) const {
+            if (a->deadline != b->deadline) {
+                return a->deadline < b->deadline;
+            }
+            return a->result.request_id < b->result.request_id;
+        }
+    };
+
+    static size_t QueueIndex(RequestPriority priority) {
+        return priority == RequestPriority::INTERACTIVE ? 0 : 1;
+    }
+
+    DeadlineClassStats& Stats(RequestPriority priority) {
+        return priority == RequestPriority::INTERACTIVE ? stats_.interactive : stats_.background;
+    }
+
+    size_t QueuedRequests() const {
+        return queues_[0].size() + queues_[1].size();
+    }
+
+    void WorkerLoop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            std::unique_ptr<Request> request;
+            cv_.wait(lock, [&] { return !running_ || (request = Take()) != nullptr; });
+            if (!running_) return;
+
+            lock.unlock();
+            Execute(*request);
+            lock.lock();
+
+            Finish(*request);
+            lock.unlock();
+            Complete(*request);
+            lock.lock();
+        }
+    }
+
+    // The earliest-deadline request whose model has an idle context;
+    // interactive requests first, then background ones while they are under
+    // background_limit_. Called with mutex_ held.
+    std::unique_ptr<Request> Take() {
+        const auto now = Clock::now();
+        for (size_t index = 0; index < 2; index++) {
+            if (index == 1 && background_running_ >= background_limit_) {
+                break;
+            }
+            auto& queue = queues_[index];
+            for (auto it = queue.begin(); it != queue.end(); ++it) {
+                Request* request = *it;
+                if (config_.drop_expired && request->deadline < now) {
+                    request->expired = true;
+                } else if (request->model->in_flight >= request->model->capacity) {
+                    continue;
+                } else {
+                    request->model->in_flight++;
+                    background_running_ += index;
+                }
+                queue.erase(it);
+                return std::unique_ptr<Request>(request);
+            }
+        }
+        return nullptr;
+    }
+
+    void Execute(Request& request) {
+        request.dispatch_time = Clock::now();
+        if (request.expired) {
+            request.result.error = hardware::HardwareAccelerator::ErrorCode::CANCELLED;
+            return;
+        }
+        ModelEngine* engine = request.model->engine;
+        if (request.token) {
+            engine->RunInference(request.input, *request.token, &request.result);
+        } else {
+            engine->RunInference(request.input, &request.result);
+        }
+    }
+
+    // Called with mutex_ held
+    void Finish(const Request& request) {
+        const auto finish_time = Clock::now();
+        const size_t index = QueueIndex(request.priority);
+        DeadlineClassStats& stats = Stats(request.priority);
+
+        if (request.expired) {
+            stats.requests_dropped++;
+            stats.deadlines_missed++;
+            return;
+        }
+        request.model->in_flight--;
+        background_running_ -= index;
+        cv_.notify_all();
+        drained_cv_.notify_all();
+
+        stats.requests_completed++;
+        if (!request.result.success) {
+            stats.requests_failed++;
+        }
+        const double queue_delay_ms = std::chrono::duration<double, std::milli>(
+            request.dispatch_time - request.enqueue_time).count();
+        total_queue_delay_ms_[index] += queue_delay_ms;
+        stats.max_queue_delay_ms = std::max(stats.max_queue_delay_ms, static_cast<float>(queue_delay_ms));
+
+        const double lateness_ms = std::chrono::duration<double, std::milli>(
+            finish_time - request.deadline).count();
+        if (lateness_ms > 0.0) {
+            stats.deadlines_missed++;
+            stats.max_lateness_ms = std::max(stats.max_lateness_ms, static_cast<float>(lateness_ms));
+        }
+    }
+
+    static void Complete(Request& request) {
+        if (request.callback) {
+            try {
+                request.callback(request.result);
+            } catch (...) {
+                // A throwing callback must not take the worker down
+            }
+        }
+        request.promise.set_value(std::move(request.result));
+    }
+
+    DeadlineSchedulerConfig config_;
+    size_t num_workers_ = 1;
+    size_t background_limit_ = 1;
+    bool running_ = false;
+    std::vector<std::thread> workers_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;           // Workers: queued work or a free context
+    std::condition_variable drained_cv_;   // RemoveModel: a model's in_flight dropped
+    std::map<std::string, std::shared_ptr<Model>> models_;
+    // Owned; 0 = interactive, 1 = background
+    std::set<Request*, EarlierDeadline> queues_[2];
+    size_t background_running_ = 0;
+    uint64_t request_id_ = 0;
+
+    DeadlineSchedulerStats stats_;
+    double total_queue_delay_ms_[2] = {0.0, 0.0};
+};
+
+DeadlineScheduler::DeadlineScheduler(const DeadlineSchedulerConfig& config)
+    : pImpl(std::make_unique<Impl>(config)) {}
+
+DeadlineScheduler::~DeadlineScheduler() = default;
+
+bool DeadlineScheduler::AddModel(const std::string& name, ModelEngine& engine) {
+    return pImpl->AddModel(name, engine);
+}
+
+void DeadlineScheduler::RemoveModel(const std::string& name) {
+    pImpl->RemoveModel(name);
+}
+
+bool DeadlineScheduler::Start() {
+    return pImpl->Start();
+}
+
+void DeadlineScheduler::Stop() {
+    pImpl->Stop();
+}
+
+bool DeadlineScheduler::IsRunning() const {
+    return pImpl->IsRunning();
+}
+
+std::future<InferenceResult> DeadlineScheduler::Submit(const std::string& model,
+                                                       std::vector<float> input,
+                                                       Clock::time_point deadline,
+                                                       RequestPriority priority,
+                                                       ModelEngine::CompletionCallback callback) {
+    return pImpl->Submit(model, std::move(input), deadline, priority, std::move(callback));
+}
+
+bool DeadlineScheduler::RunInference(const std::string& model,
+                                     const std::vector<float>& input,
+                                     std::vector<float>& output,
+                                     Clock::time_point deadline,
+                                     RequestPriority priority,
+                                     InferenceMetrics* metrics) {
+    return pImpl->RunInference(model, input, output, deadline, priority, metrics);
+}
+
+DeadlineSchedulerStats DeadlineScheduler::GetStats() const {
+    return pImpl->GetStats();
+}
+
+void DeadlineScheduler::ResetStats() {
+    pImpl->ResetStats();
+}
+
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "model_engine.h"
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mobileai {
+namespace inference {
+
+enum class RequestPriority {
+    INTERACTIVE,   // User-facing; always dispatched ahead of background work
+    BACKGROUND
+};
+
+struct DeadlineSchedulerConfig {
+    size_t num_workers = 0;                  // 0 = the models' max_execution_contexts combined, at Start
+    size_t reserved_interactive_workers = 1; // Workers background requests may never occupy
+    size_t max_queue_size = 256;             // Requests beyond this are rejected
+    bool drop_expired = false;               // Fail requests with CANCELLED once their deadline passes, queued or running
+};
+
+struct DeadlineClassStats {
+    uint64_t requests_completed = 0;    // Ran, successfully or not
+    uint64_t requests_failed = 0;
+    uint64_t requests_rejected = 0;     // Queue full, unknown model or not running
+    uint64_t requests_dropped = 0;      // Expired in the queue (drop_expired)
+    uint64_t deadlines_missed = 0;      // Completed after their deadline, or dropped
+    float average_queue_delay_ms = 0.0f;
+    float max_queue_delay_ms = 0.0f;
+    float max_lateness_ms = 0.0f;       // Worst completion time past a deadline
+};
+
+struct DeadlineSchedulerStats {
+    DeadlineClassStats interactive;
+    DeadlineClassStats background;
+};
+
+// Owns execution for several ModelEngines. Queued requests are dispatched
+// earliest-deadline-first, interactive before background, onto a shared pool
+// of workers. A request is only dispatched while its model has an idle
+// execution context, so a busy model never holds a worker that another
+// model could use. Inference cannot be preempted; instead background
+// requests are kept off reserved_interactive_workers so an interactive
+// arrival always finds a worker. While running, the scheduler should be the
+// only caller of the registered engines' inference methods.
+class DeadlineScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit DeadlineScheduler(const DeadlineSchedulerConfig& config = DeadlineSchedulerConfig());
+    ~DeadlineScheduler();
+
+    // The engine must outlive its registration. RemoveModel fails the
+    // model's queued requests and waits for its running ones.
+    bool AddModel(const std::string& name, ModelEngine& engine);
+    void RemoveModel(const std::string& name);
+
+    bool Start();
+    void Stop();
+    bool IsRunning() const;
+
+    // Queue a request and return immediately. The callback, if any, runs on
+    // the worker thread just before the future becomes ready.
+    std::future<InferenceResult> Submit(const std::string& model,
+                                        std::vector<float> input,
+                                        Clock::time_point deadline,
+                                        RequestPriority priority = RequestPriority::INTERACTIVE,
+                                        ModelEngine::CompletionCallback callback = nullptr);
+
+    // Blocking form of Submit
+    bool RunInference(const std::string& model,
+                     const std::vector<float>& input,
+                     std::vector<float>& output,
+                     Clock::time_point deadline,
+                     RequestPriority priority = RequestPriority::INTERACTIVE,
+                     InferenceMetrics* metrics = nullptr);
+
+    DeadlineSchedulerStats GetStats() const;
+    void ResetStats();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+
+    DeadlineScheduler(const DeadlineScheduler&) = delete;
+    DeadlineScheduler& operator=(const DeadlineScheduler&) = delete;
+};
+
+} // namespace inference
+} // namespace mobileai
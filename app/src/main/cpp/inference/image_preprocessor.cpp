@@ -0,0 +1,569 @@
+#include "image_preprocessor.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MOBILEAI_HAS_AVX2_DISPATCH
+#define MOBILEAI_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+namespace mobileai {
+namespace inference {
+
+namespace {
+
+// Row kernels; every pass over a row goes through one of these
+struct Kernels {
+    const char* name;
+    void (*widen)(const uint8_t* src, float* dst, size_t count);
+    void (*affine)(const float* src, const float* scale, const float* bias, float* dst, size_t count);
+    void (*lerp)(const float* a, const float* b, float weight, float* dst, size_t count);
+    void (*quantize_u8)(const float* src, uint8_t* dst, size_t count);   // Round to nearest, saturate
+    void (*quantize_s8)(const float* src, int8_t* dst, size_t count);
+};
+
+void WidenScalar(const uint8_t* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = src[i];
+    }
+}
+
+void AffineScalar(const float* src, const float* scale, const float* bias, float* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = src[i] * scale[i] + bias[i];
+    }
+}
+
+void LerpScalar(const float* a, const float* b, float weight, float* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = a[i] + weight * (b[i] - a[i]);
+    }
+}
+
+void QuantizeU8Scalar(const float* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = static_cast<uint8_t>(std::min(std::max(std::lrintf(src[i]), 0L), 255L));
+    }
+}
+
+void QuantizeS8Scalar(const float* src, int8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        dst[i] = static_cast<int8_t>(std::min(std::max(std::lrintf(src[i]), -128L), 127L));
+    }
+}
+
+#if defined(__SSE2__)
+void WidenSSE2(const uint8_t* src, float* dst, size_t count) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+        __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+        _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+        _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+        _mm_storeu_ps(dst + i + 8, _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+        _mm_storeu_ps(dst + i + 12, _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+    }
+    WidenScalar(src + i, dst + i, count - i);
+}
+
+void AffineSSE2(const float* src, const float* scale, const float* bias, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 value = _mm_mul_ps(_mm_loadu_ps(src + i), _mm_loadu_ps(scale + i));
+        _mm_storeu_ps(dst + i, _mm_add_ps(value, _mm_loadu_ps(bias + i)));
+    }
+    AffineScalar(src + i, scale + i, bias + i, dst + i, count - i);
+}
+
+void LerpSSE2(const float* a, const float* b, float weight, float* dst, size_t count) {
+    const __m128 w = _mm_set1_ps(weight);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 va = _mm_loadu_ps(a + i);
+        __m128 delta = _mm_sub_ps(_mm_loadu_ps(b + i), va);
+        _mm_storeu_ps(dst + i, _mm_add_ps(va, _mm_mul_ps(w, delta)));
+    }
+    LerpScalar(a + i, b + i, weight, dst + i, count - i);
+}
+
+void QuantizeU8SSE2(const float* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_cvtps_epi32(_mm_loadu_ps(src + i));
+        __m128i b = _mm_cvtps_epi32(_mm_loadu_ps(src + i + 4));
+        __m128i c = _mm_cvtps_epi32(_mm_loadu_ps(src + i + 8));
+        __m128i d = _mm_cvtps_epi32(_mm_loadu_ps(src + i + 12));
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+    }
+    QuantizeU8Scalar(src + i, dst + i, count - i);
+}
+
+void QuantizeS8SSE2(const float* src, int8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_cvtps_epi32(_mm_loadu_ps(src + i));
+        __m128i b = _mm_cvtps_epi32(_mm_loadu_ps(src + i + 4));
+        __m128i c = _mm_cvtps_epi32(_mm_loadu_ps(src + i + 8));
+        __m128i d = _mm_cvtps_epi32(_mm_loadu_ps(src + i + 12));
+        __m128i packed = _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+    }
+    QuantizeS8Scalar(src + i, dst + i, count - i);
+}
+#endif
+
+#if defined(MOBILEAI_HAS_AVX2_DISPATCH)
+MOBILEAI_TARGET_AVX2 void WidenAVX2(const uint8_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes)));
+    }
+    WidenScalar(src + i, dst + i, count - i);
+}
+
+MOBILEAI_TARGET_AVX2 void AffineAVX2(const float* src, const float* scale, const float* bias,
+                                     float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(_mm256_loadu_ps(src + i),
+                                                  _mm256_loadu_ps(scale + i),
+                                                  _mm256_loadu_ps(bias + i)));
+    }
+    AffineScalar(src + i, scale + i, bias + i, dst + i, count - i);
+}
+
+MOBILEAI_TARGET_AVX2 void LerpAVX2(const float* a, const float* b, float weight, float* dst, size_t count) {
+    const __m256 w = _mm256_set1_ps(weight);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 va = _mm256_loadu_ps(a + i);
+        _mm256_storeu_ps(dst + i, _mm256_fmadd_ps(w, _mm256_sub_ps(_mm256_loadu_ps(b + i), va), va));
+    }
+    LerpScalar(a + i, b + i, weight, dst + i, count - i);
+}
+#endif
+
+#if defined(__ARM_NEON)
+void WidenNEON(const uint8_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t bytes = vld1q_u8(src + i);
+        uint16x8_t lo = vmovl_u8(vget_low_u8(bytes));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(bytes));
+        vst1q_f32(dst + i, vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))));
+        vst1q_f32(dst + i + 4, vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))));
+        vst1q_f32(dst + i + 8, vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))));
+        vst1q_f32(dst + i + 12, vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))));
+    }
+    WidenScalar(src + i, dst + i, count - i);
+}
+
+void AffineNEON(const float* src, const float* scale, const float* bias, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+#if defined(__aarch64__)
+        float32x4_t value = vfmaq_f32(vld1q_f32(bias + i), vld1q_f32(src + i), vld1q_f32(scale + i));
+#else
+        float32x4_t value = vmlaq_f32(vld1q_f32(bias + i), vld1q_f32(src + i), vld1q_f32(scale + i));
+#endif
+        vst1q_f32(dst + i, value);
+    }
+    AffineScalar(src + i, scale + i, bias + i, dst + i, count - i);
+}
+
+void LerpNEON(const float* a, const float* b, float weight, float* dst, size_t count) {
+    const float32x4_t w = vdupq_n_f32(weight);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t va = vld1q_f32(a + i);
+        vst1q_f32(dst + i, vmlaq_f32(va, vsubq_f32(vld1q_f32(b + i), va), w));
+    }
+    LerpScalar(a + i, b + i, weight, dst + i, count - i);
+}
+
+#if defined(__aarch64__)
+int16x8_t RoundToInt16(const float* src) {
+    int32x4_t lo = vcvtnq_s32_f32(vld1q_f32(src));
+    int32x4_t hi = vcvtnq_s32_f32(vld1q_f32(src + 4));
+    return vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+}
+
+void QuantizeU8NEON(const float* src, uint8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        vst1q_u8(dst + i, vcombine_u8(vqmovun_s16(RoundToInt16(src + i)),
+                                      vqmovun_s16(RoundToInt16(src + i + 8))));
+    }
+    QuantizeU8Scalar(src + i, dst + i, count - i);
+}
+
+void QuantizeS8NEON(const float* src, int8_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        vst1q_s8(dst + i, vcombine_s8(vqmovn_s16(RoundToInt16(src + i)),
+                                      vqmovn_s16(RoundToInt16(src + i + 8))));
+    }
+    QuantizeS8Scalar(src + i, dst + i, count - i);
+}
+#endif
+#endif
+
+const Kernels& ScalarKernels() {
+    static const Kernels kernels{"scalar", WidenScalar, AffineScalar, LerpScalar,
+                                 QuantizeU8Scalar, QuantizeS8Scalar};
+    return kernels;
+}
+
+const Kernels& BestKernels() {
+    static const Kernels kernels = [] {
+#if defined(__ARM_NEON)
+#if defined(__aarch64__)
+        return Kernels{"neon", WidenNEON, AffineNEON, LerpNEON, QuantizeU8NEON, QuantizeS8NEON};
+#else
+        return Kernels{"neon", WidenNEON, AffineNEON, LerpNEON, QuantizeU8Scalar, QuantizeS8Scalar};
+#endif
+#else
+        Kernels selected = ScalarKernels();
+#if defined(__SSE2__)
+        selected = Kernels{"sse2", WidenSSE2, AffineSSE2, LerpSSE2, QuantizeU8SSE2, QuantizeS8SSE2};
+#endif
+#if defined(MOBILEAI_HAS_AVX2_DISPATCH)
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            selected.name = "avx2";
+            selected.widen = WidenAVX2;
+            selected.affine = AffineAVX2;
+            selected.lerp = LerpAVX2;
+        }
+#endif
+        return selected;
+#endif
+    }();
+    return kernels;
+}
+
+// Set through ImagePreprocessor::SetKernels; null selects BestKernels()
+std::atomic<const Kernels*> pinned_kernels{nullptr};
+
+const Kernels& SelectKernels() {
+    const Kernels* pinned = pinned_kernels.load(std::memory_order_acquire);
+    return pinned ? *pinned : BestKernels();
+}
+
+// Interleaved pixels -> one plane per channel
+void Deinterleave(const float* src, float* dst, size_t pixels, int channels) {
+    size_t i = 0;
+#if defined(__ARM_NEON)
+    if (channels == 3) {
+        for (; i + 4 <= pixels; i += 4) {
+            float32x4x3_t planes = vld3q_f32(src + i * 3);
+            vst1q_f32(dst + i, planes.val[0]);
+            vst1q_f32(dst + pixels + i, planes.val[1]);
+            vst1q_f32(dst + 2 * pixels + i, planes.val[2]);
+        }
+    }
+#endif
+    for (; i < pixels; i++) {
+        for (int c = 0; c < channels; c++) {
+            dst[c * pixels + i] = src[i * channels + c];
+        }
+    }
+}
+
+// Where each model channel sits in a source pixel
+struct SourceChannels {
+    int bytes_per_pixel = 3;
+    int offsets[3] = {0, 1, 2};   // In the model's channel order
+    bool luma = false;            // 1-channel model from a color image
+    bool direct = false;          // Source pixel already matches the model's channels
+};
+
+SourceChannels DescribeSource(PixelFormat format, ChannelOrder order, int channels) {
+    SourceChannels source;
+    int r = 0, g = 1, b = 2;
+    switch (format) {
+        case PixelFormat::RGB8:  source.bytes_per_pixel = 3; break;
+        case PixelFormat::BGR8:  source.bytes_per_pixel = 3; r = 2; b = 0; break;
+        case PixelFormat::RGBA8: source.bytes_per_pixel = 4; break;
+        case PixelFormat::BGRA8: source.bytes_per_pixel = 4; r = 2; b = 0; break;
+        case PixelFormat::GRAY8: source.bytes_per_pixel = 1; r = g = b = 0; break;
+    }
+
+    if (channels == 1) {
+        source.offsets[0] = r;
+        source.luma = format != PixelFormat::GRAY8;
+        source.direct = format == PixelFormat::GRAY8;
+        return source;
+    }
+
+    const bool rgb = order == ChannelOrder::RGB;
+    source.offsets[0] = rgb ? r : b;
+    source.offsets[1] = g;
+    source.offsets[2] = rgb ? b : r;
+    source.direct = source.bytes_per_pixel == 3 && source.offsets[0] == 0 && source.offsets[2] == 2;
+    return source;
+}
+
+// Destination region filled from the image, and the source region mapped onto it
+struct Geometry {
+    int content_x;
+    int content_y;
+    int content_width;
+    int content_height;
+    float src_x;
+    float src_y;
+    float src_width;
+    float src_height;
+};
+
+Geometry PlanGeometry(ResizeMode mode, int crop_x, int crop_y, int crop_width, int crop_height,
+                      int width, int height) {
+    Geometry geometry{0, 0, width, height,
+                      static_cast<float>(crop_x), static_cast<float>(crop_y),
+                      static_cast<float>(crop_width), static_cast<float>(crop_height)};
+    const float scale_x = static_cast<float>(crop_width) / width;
+    const float scale_y = static_cast<float>(crop_height) / height;
+
+    if (mode == ResizeMode::CENTER_CROP) {
+        // The smaller scale makes the source region cover the whole output
+        const float scale = std::min(scale_x, scale_y);
+        geometry.src_width = width * scale;
+        geometry.src_height = height * scale;
+        geometry.src_x += (crop_width - geometry.src_width) / 2.0f;
+        geometry.src_y += (crop_height - geometry.src_height) / 2.0f;
+    } else if (mode == ResizeMode::LETTERBOX) {
+        const float scale = std::max(scale_x, scale_y);
+        geometry.content_width = std::min(width, std::max(1, static_cast<int>(std::lround(crop_width / scale))));
+        geometry.content_height = std::min(height, std::max(1, static_cast<int>(std::lround(crop_height / scale))));
+        geometry.content_x = (width - geometry.content_width) / 2;
+        geometry.content_y = (height - geometry.content_height) / 2;
+    }
+    return geometry;
+}
+
+// Horizontal sample position: byte offsets of the two neighbours and the
+// weight of the second
+struct Tap {
+    int offset0;
+    int offset1;
+    float weight;
+};
+
+struct Scratch {
+    std::vector<Tap> taps;
+    std::vector<float> resampled[2];   // Horizontally resampled source rows
+    int resampled_row[2] = {-1, -1};
+    std::vector<float> line;           // One output row, interleaved, in pixel units
+    std::vector<float> normalized;
+    std::vector<float> planar;
+    std::vector<float> scale;
+    std::vector<float> bias;
+};
+
+void ResampleRow(const uint8_t* row, const std::vector<Tap>& taps, const SourceChannels& source,
+                 int channels, float* out) {
+    for (size_t x = 0; x < taps.size(); x++) {
+        const Tap& tap = taps[x];
+        const uint8_t* p0 = row + tap.offset0;
+        const uint8_t* p1 = row + tap.offset1;
+        if (source.luma) {
+            const float v0 = 0.299f * p0[source.offsets[0]] + 0.587f * p0[1] + 0.114f * p0[2 - source.offsets[0]];
+            const float v1 = 0.299f * p1[source.offsets[0]] + 0.587f * p1[1] + 0.114f * p1[2 - source.offsets[0]];
+            out[x] = v0 + tap.weight * (v1 - v0);
+            continue;
+        }
+        for (int c = 0; c < channels; c++) {
+            const float v0 = p0[source.offsets[c]];
+            const float v1 = p1[source.offsets[c]];
+            out[x * channels + c] = v0 + tap.weight * (v1 - v0);
+        }
+    }
+}
+
+} // namespace
+
+ImagePreprocessor::ImagePreprocessor(const PreprocessSpec& spec) : spec_(spec) {}
+
+const char* ImagePreprocessor::GetKernelName() {
+    return SelectKernels().name;
+}
+
+bool ImagePreprocessor::SetKernels(const char* name) {
+    const Kernels* kernels = nullptr;
+    if (name && std::strcmp(name, ScalarKernels().name) == 0) {
+        kernels = &ScalarKernels();
+    } else if (name && std::strcmp(name, BestKernels().name) != 0) {
+        return false;
+    }
+    pinned_kernels.store(kernels, std::memory_order_release);
+    return true;
+}
+
+bool ImagePreprocessor::Run(const ImageBuffer& image, const TensorInfo& info, void* data, size_t bytes) const {
+    if (!image.data || image.width <= 0 || image.height <= 0 || !data || info.shape.size() != 4 ||
+        info.shape[0] != 1) {
+        return false;
+    }
+    const bool nchw = spec_.layout == TensorLayout::NCHW;
+    const int64_t channels = nchw ? info.shape[1] : info.shape[3];
+    const int64_t height = nchw ? info.shape[2] : info.shape[1];
+    const int64_t width = nchw ? info.shape[3] : info.shape[2];
+    if ((channels != 1 && channels != 3) || height <= 0 || width <= 0 ||
+        (info.type != TensorType::FLOAT32 && info.type != TensorType::UINT8 &&
+         info.type != TensorType::INT8)) {
+        return false;
+    }
+    const size_t row_values = static_cast<size_t>(width * channels);
+    if (bytes < row_values * height * TensorTypeSize(info.type)) {
+        return false;
+    }
+
+    const int C = static_cast<int>(channels);
+    const int W = static_cast<int>(width);
+    const int H = static_cast<int>(height);
+    const SourceChannels source = DescribeSource(image.format, spec_.channel_order, C);
+    const size_t stride = image.stride ? image.stride
+                                       : static_cast<size_t>(image.width) * source.bytes_per_pixel;
+
+    const int crop_x = std::min(std::max(spec_.crop_x, 0), image.width - 1);
+    const int crop_y = std::min(std::max(spec_.crop_y, 0), image.height - 1);
+    const int crop_width = spec_.crop_width > 0 && spec_.crop_height > 0
+        ? std::min(spec_.crop_width, image.width - crop_x) : image.width - crop_x;
+    const int crop_height = spec_.crop_width > 0 && spec_.crop_height > 0
+        ? std::min(spec_.crop_height, image.height - crop_y) : image.height - crop_y;
+    const Geometry geometry = PlanGeometry(spec_.resize, crop_x, crop_y, crop_width, crop_height, W, H);
+    const bool bilinear = spec_.filter == ResizeFilter::BILINEAR;
+
+    const Kernels& kernels = SelectKernels();
+    thread_local Scratch scratch;
+
+    // Column taps, shared by every row
+    const float step_x = geometry.src_width / geometry.content_width;
+    const float step_y = geometry.src_height / geometry.content_height;
+    scratch.taps.resize(geometry.content_width);
+    for (int x = 0; x < geometry.content_width; x++) {
+        float sx = geometry.src_x + (x + 0.5f) * step_x - 0.5f;
+        sx = std::min(std::max(sx, static_cast<float>(crop_x)), static_cast<float>(crop_x + crop_width - 1));
+        int x0 = bilinear ? static_cast<int>(sx) : static_cast<int>(std::lround(sx));
+        int x1 = std::min(x0 + 1, crop_x + crop_width - 1);
+        scratch.taps[x] = {x0 * source.bytes_per_pixel, x1 * source.bytes_per_pixel,
+                           bilinear ? sx - x0 : 0.0f};
+    }
+    // Unscaled, pixel-aligned columns are a straight widening copy
+    const bool copy_columns = source.direct && step_x == 1.0f &&
+                              geometry.src_x == std::floor(geometry.src_x);
+
+    // Normalization, with quantization folded in for integer inputs:
+    // q = (pixel - mean) / stddev / scale + zero_point
+    scratch.scale.resize(row_values);
+    scratch.bias.resize(row_values);
+    for (int c = 0; c < C; c++) {
+        float scale = 1.0f / spec_.stddev[c];
+        float bias = -spec_.mean[c] / spec_.stddev[c];
+        if (info.type != TensorType::FLOAT32 && info.quantization.scale > 0.0f) {
+            scale /= info.quantization.scale;
+            bias = bias / info.quantization.scale + info.quantization.zero_point;
+        }
+        for (int x = 0; x < W; x++) {
+            scratch.scale[x * C + c] = scale;
+            scratch.bias[x * C + c] = bias;
+        }
+    }
+
+    const size_t content_values = static_cast<size_t>(geometry.content_width) * C;
+    scratch.resampled_row[0] = scratch.resampled_row[1] = -1;
+    for (auto& row : scratch.resampled) {
+        row.resize(content_values);
+    }
+    scratch.line.assign(row_values, spec_.pad_value);
+    scratch.normalized.resize(row_values);
+    scratch.planar.resize(row_values);
+
+    // Horizontally resampled source row, reused while consecutive output
+    // rows read the same source rows
+    auto resampled = [&](int src_row) -> const float* {
+        for (int slot = 0; slot < 2; slot++) {
+            if (scratch.resampled_row[slot] == src_row) {
+                return scratch.resampled[slot].data();
+            }
+        }
+        const int slot = scratch.resampled_row[0] < scratch.resampled_row[1] ? 0 : 1;
+        const uint8_t* row = image.data + static_cast<size_t>(src_row) * stride;
+        float* out = scratch.resampled[slot].data();
+        if (copy_columns) {
+            kernels.widen(row + scratch.taps[0].offset0, out, content_values);
+        } else {
+            ResampleRow(row, scratch.taps, source, C, out);
+        }
+        scratch.resampled_row[slot] = src_row;
+        return out;
+    };
+
+    float* content = scratch.line.data() + static_cast<size_t>(geometry.content_x) * C;
+    for (int y = 0; y < H; y++) {
+        const bool content_row = y >= geometry.content_y && y < geometry.content_y + geometry.content_height;
+        if (!content_row) {
+            std::fill(scratch.line.begin(), scratch.line.end(), spec_.pad_value);
+        } else {
+            float sy = geometry.src_y + (y - geometry.content_y + 0.5f) * step_y - 0.5f;
+            sy = std::min(std::max(sy, static_cast<float>(crop_y)), static_cast<float>(crop_y + crop_height - 1));
+            const int y0 = bilinear ? static_cast<int>(sy) : static_cast<int>(std::lround(sy));
+            const int y1 = std::min(y0 + 1, crop_y + crop_height - 1);
+            const float weight = bilinear ? sy - y0 : 0.0f;
+
+            const float* top = resampled(y0);
+            if (weight > 0.0f && y1 != y0) {
+                const float* bottom = resampled(y1);
+                kernels.lerp(top, bottom, weight, content, content_values);
+            } else {
+                std::memcpy(content, top, content_values * sizeof(float));
+            }
+        }
+
+        // Normalize, then store in the tensor's type and layout
+        if (info.type == TensorType::FLOAT32 && (!nchw || C == 1)) {
+            kernels.affine(scratch.line.data(), scratch.scale.data(), scratch.bias.data(),
+                           static_cast<float*>(data) + y * row_values, row_values);
+            continue;
+        }
+        kernels.affine(scratch.line.data(), scratch.scale.data(), scratch.bias.data(),
+                       scratch.normalized.data(), row_values);
+        const float* values = scratch.normalized.data();
+        if (nchw && C > 1) {
+            Deinterleave(values, scratch.planar.data(), W, C);
+            values = scratch.planar.data();
+        }
+
+        // One segment per plane for NCHW, the whole row for NHWC
+        const int planes = nchw ? C : 1;
+        const size_t segment = row_values / planes;
+        for (int plane = 0; plane < planes; plane++) {
+            const float* src = values + plane * segment;
+            const size_t offset = (static_cast<size_t>(plane) * H + y) * segment;
+            if (info.type == TensorType::FLOAT32) {
+                std::memcpy(static_cast<float*>(data) + offset, src, segment * sizeof(float));
+            } else if (info.type == TensorType::UINT8) {
+                kernels.quantize_u8(src, static_cast<uint8_t*>(data) + offset, segment);
+            } else {
+                kernels.quantize_s8(src, static_cast<int8_t*>(data) + offset, segment);
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace inference
+} // namespace mobileai
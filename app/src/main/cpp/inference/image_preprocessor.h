@@ -0,0 +1,94 @@
+#pragma once
+
+#include "tensor_view.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace mobileai {
+namespace inference {
+
+enum class PixelFormat {
+    RGB8,
+    BGR8,
+    RGBA8,
+    BGRA8,
+    GRAY8
+};
+
+// Caller-owned 8-bit image, read in place
+struct ImageBuffer {
+    const uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    size_t stride = 0;              // Bytes per row; 0 = tightly packed
+    PixelFormat format = PixelFormat::RGB8;
+};
+
+enum class ResizeMode {
+    STRETCH,       // Scale the crop to the input size, ignoring aspect ratio
+    CENTER_CROP,   // Keep aspect ratio; cut the excess evenly from both sides
+    LETTERBOX      // Keep aspect ratio; pad the remainder with pad_value
+};
+
+enum class ResizeFilter {
+    NEAREST,
+    BILINEAR
+};
+
+enum class ChannelOrder {
+    RGB,
+    BGR
+};
+
+enum class TensorLayout {
+    NHWC,
+    NCHW
+};
+
+// Declarative preprocessing for an image model's input 0. Height, width and
+// channel count (1 or 3) come from the tensor shape, read in the given
+// layout; the element type from the tensor: FLOAT32, or UINT8/INT8 quantized
+// with the tensor's parameters. A 1-channel input from a color image takes
+// its luma.
+struct PreprocessSpec {
+    int crop_x = 0;                 // Source region; a zero width or height
+    int crop_y = 0;                 // selects the whole image
+    int crop_width = 0;
+    int crop_height = 0;
+    ResizeMode resize = ResizeMode::STRETCH;
+    ResizeFilter filter = ResizeFilter::BILINEAR;
+    ChannelOrder channel_order = ChannelOrder::RGB;
+    TensorLayout layout = TensorLayout::NHWC;
+    float mean[3] = {0.0f, 0.0f, 0.0f};    // value = (pixel - mean) / stddev, pixels in 0-255,
+    float stddev[3] = {1.0f, 1.0f, 1.0f};  // indexed in the model's channel order
+    float pad_value = 0.0f;                // LETTERBOX fill, in pixel units
+};
+
+// Runs a PreprocessSpec as one pass over the output rows: each source row is
+// resampled horizontally once, blended vertically, then normalized, converted
+// and stored straight into the destination tensor. The per-row arithmetic
+// uses NEON, AVX2+FMA or SSE2 kernels picked at runtime for the CPU, with a
+// scalar fallback. Thread-safe; scratch rows are per thread.
+class ImagePreprocessor {
+public:
+    explicit ImagePreprocessor(const PreprocessSpec& spec);
+
+    // info describes the destination (shape [1,H,W,C] or [1,C,H,W]); data
+    // must hold at least info's element count. False on an unsupported
+    // image, shape or element type.
+    bool Run(const ImageBuffer& image, const TensorInfo& info, void* data, size_t bytes) const;
+
+    // "neon", "avx2", "sse2" or "scalar"
+    static const char* GetKernelName();
+
+    // Pins every preprocessor to the named kernels, or back to the CPU's
+    // best with nullptr. "scalar" is always available; false for a name this
+    // CPU does not support. For tests and benchmarks, not while Run is busy.
+    static bool SetKernels(const char* name);
+
+private:
+    PreprocessSpec spec_;
+};
+
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,125 @@
+#include "memory_blocks.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace mobileai {
+namespace inference {
+
+namespace {
+
+size_t AlignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool LiveTogether(const MemoryBlock& a, const MemoryBlock& b) {
+    return a.first_use <= b.last_use && b.first_use <= a.last_use;
+}
+
+} // namespace
+
+bool PlanMemoryBlocks(std::vector<MemoryBlock>* blocks, size_t alignment, size_t* arena_bytes) {
+    std::vector<MemoryBlock>& all = *blocks;
+    std::vector<size_t> placed;
+    std::vector<size_t> pending;
+    size_t arena = 0;
+
+    auto overlaps = [&all](size_t a, size_t b) {
+        const size_t a_begin = static_cast<size_t>(all[a].offset);
+        const size_t b_begin = static_cast<size_t>(all[b].offset);
+        return a_begin < b_begin + all[b].bytes && b_begin < a_begin + all[a].bytes;
+    };
+
+    for (size_t i = 0; i < all.size(); i++) {
+        if (all[i].offset < 0) {
+            pending.push_back(i);
+            continue;
+        }
+        for (size_t j : placed) {
+            if (LiveTogether(all[i], all[j]) && overlaps(i, j)) {
+                return false;
+            }
+        }
+        placed.push_back(i);
+        arena = std::max(arena, static_cast<size_t>(all[i].offset) + all[i].bytes);
+    }
+
+    std::stable_sort(pending.begin(), pending.end(), [&all](size_t a, size_t b) {
+        return all[a].bytes > all[b].bytes;
+    });
+
+    std::vector<size_t> conflicts;
+    for (size_t i : pending) {
+        MemoryBlock& block = all[i];
+        conflicts.clear();
+        for (size_t j : placed) {
+            if (LiveTogether(block, all[j])) {
+                conflicts.push_back(j);
+            }
+        }
+        std::sort(conflicts.begin(), conflicts.end(), [&all](size_t a, size_t b) {
+            return all[a].offset < all[b].offset;
+        });
+
+        // Smallest gap that fits, otherwise above everything live
+        size_t cursor = 0;
+        size_t best = std::numeric_limits<size_t>::max();
+        size_t best_gap = std::numeric_limits<size_t>::max();
+        for (size_t j : conflicts) {
+            const size_t begin = static_cast<size_t>(all[j].offset);
+            if (begin >= cursor && begin - cursor >= block.bytes && begin - cursor < best_gap) {
+                best = cursor;
+                best_gap = begin - cursor;
+            }
+            cursor = std::max(cursor, AlignUp(begin + all[j].bytes, alignment));
+        }
+        block.offset = static_cast<int64_t>(best_gap != std::numeric_limits<size_t>::max() ? best : cursor);
+        placed.push_back(i);
+        arena = std::max(arena, static_cast<size_t>(block.offset) + block.bytes);
+    }
+
+    *arena_bytes = arena;
+    return true;
+}
+
+size_t PeakLiveBytes(const std::vector<MemoryBlock>& blocks, size_t alignment) {
+    int steps = 0;
+    for (const auto& block : blocks) {
+        steps = std::max(steps, block.last_use + 1);
+    }
+    std::vector<size_t> starting(steps, 0);
+    std::vector<size_t> ending(steps, 0);
+    for (const auto& block : blocks) {
+        starting[block.first_use] += AlignUp(block.bytes, alignment);
+        ending[block.last_use] += AlignUp(block.bytes, alignment);
+    }
+
+    size_t live = 0;
+    size_t peak = 0;
+    for (int step = 0; step < steps; step++) {
+        live += starting[step];
+        peak = std::max(peak, live);
+        live -= ending[step];
+    }
+    return peak;
+}
+
+bool ParseOfflineMemoryPlan(const std::string& metadata, int subgraph,
+                            std::vector<int64_t>* offsets) {
+    const size_t header = 3;
+    if (metadata.size() % sizeof(int32_t) != 0 || metadata.size() < header * sizeof(int32_t)) {
+        return false;
+    }
+    // Stored little-endian, like the rest of the flatbuffer
+    std::vector<int32_t> values(metadata.size() / sizeof(int32_t));
+    std::memcpy(values.data(), metadata.data(), metadata.size());
+    if (values[0] != 1 || values[1] != subgraph || values[2] < 0 ||
+        static_cast<size_t>(values[2]) != values.size() - header) {
+        return false;
+    }
+    offsets->assign(values.begin() + header, values.end());
+    return true;
+}
+
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace mobileai {
+namespace inference {
+
+// A buffer to place in an arena, live from the first to the last step that
+// uses it (both inclusive)
+struct MemoryBlock {
+    size_t bytes = 0;
+    int first_use = 0;
+    int last_use = 0;
+    int64_t offset = -1;   // Preassigned, or -1 to be planned; receives the placement
+};
+
+// Greedy by size: blocks are placed largest first, each in the smallest gap
+// between blocks live at the same time that fits it, or above them all.
+// Planned offsets are multiples of alignment; preassigned blocks stay where
+// they are, and false means two of them overlap while both are live.
+bool PlanMemoryBlocks(std::vector<MemoryBlock>* blocks, size_t alignment, size_t* arena_bytes);
+
+// Most bytes live at any one step, each block rounded up to alignment. No
+// placement of these blocks fits in less.
+size_t PeakLiveBytes(const std::vector<MemoryBlock>& blocks, size_t alignment);
+
+// The subgraph's tensor offsets from TFLite Micro "OfflineMemoryAllocation"
+// metadata: int32 version (1), subgraph index, offset count, then one offset
+// per tensor, -1 for tensors left to the online planner
+bool ParseOfflineMemoryPlan(const std::string& metadata, int subgraph,
+                            std::vector<int64_t>* offsets);
+
+} // namespace inference
+} // namespace mobileai
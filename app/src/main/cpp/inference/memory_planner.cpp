@@ -0,0 +1,333 @@
+#include "memory_planner.h"
+#include <tensorflow/lite/builtin_ops.h>
+#include <tensorflow/lite/util.h>
+#include <algorithm>
+#include <cstring>
+
+namespace mobileai {
+namespace inference {
+
+namespace {
+
+// Custom allocations must keep TFLite's own tensor alignment
+constexpr size_t TENSOR_ALIGNMENT = tflite::kDefaultTensorAlignment;
+// Offline plans come from TFLite Micro, which aligns tensors to 16 bytes
+constexpr size_t OFFLINE_ALIGNMENT = 16;
+
+size_t AlignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Each output element depends only on the input elements at the same index,
+// read before it is written, so the output may overwrite an input of the
+// same shape
+bool IsElementWise(int32_t builtin_code) {
+    switch (builtin_code) {
+        case kTfLiteBuiltinAdd:
+        case kTfLiteBuiltinSub:
+        case kTfLiteBuiltinMul:
+        case kTfLiteBuiltinMaximum:
+        case kTfLiteBuiltinMinimum:
+        case kTfLiteBuiltinSquaredDifference:
+        case kTfLiteBuiltinRelu:
+        case kTfLiteBuiltinRelu6:
+        case kTfLiteBuiltinReluN1To1:
+        case kTfLiteBuiltinLeakyRelu:
+        case kTfLiteBuiltinElu:
+        case kTfLiteBuiltinHardSwish:
+        case kTfLiteBuiltinLogistic:
+        case kTfLiteBuiltinTanh:
+        case kTfLiteBuiltinAbs:
+        case kTfLiteBuiltinNeg:
+        case kTfLiteBuiltinSquare:
+        case kTfLiteBuiltinSqrt:
+        case kTfLiteBuiltinRsqrt:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The primary subgraph's activations, i.e. the tensors TFLite keeps in its
+// non-persistent arena, and the execution plan steps that use them
+struct Lifetimes {
+    std::vector<int> first_use;   // -1 = not an activation of the plan
+    std::vector<int> last_use;
+    std::vector<bool> produced;   // Written by a node of the plan
+    std::vector<bool> scratch;    // Op temporaries, left in TFLite's arena
+    std::vector<bool> pinned;     // Graph inputs and outputs, never overwritten in place
+    bool dynamic = false;         // A tensor of the plan is reallocated while running
+};
+
+Lifetimes Analyze(tflite::Interpreter* interpreter) {
+    const int num_tensors = static_cast<int>(interpreter->tensors_size());
+    const std::vector<int>& plan = interpreter->execution_plan();
+    const int last_step = std::max(static_cast<int>(plan.size()) - 1, 0);
+
+    Lifetimes lifetimes;
+    lifetimes.first_use.assign(num_tensors, -1);
+    lifetimes.last_use.assign(num_tensors, -1);
+    lifetimes.produced.assign(num_tensors, false);
+    lifetimes.scratch.assign(num_tensors, false);
+    lifetimes.pinned.assign(num_tensors, false);
+
+    auto use = [&](int index, int step) {
+        if (index < 0 || index >= num_tensors) {
+            return false;   // kTfLiteOptionalTensor
+        }
+        const TfLiteTensor* tensor = interpreter->tensor(index);
+        if (tensor->allocation_type == kTfLiteDynamic) {
+            lifetimes.dynamic = true;
+        }
+        if (tensor->allocation_type != kTfLiteArenaRw || tensor->bytes == 0) {
+            return false;
+        }
+        int& first = lifetimes.first_use[index];
+        first = first < 0 ? step : std::min(first, step);
+        lifetimes.last_use[index] = std::max(lifetimes.last_use[index], step);
+        return true;
+    };
+
+    // Inputs are kept intact for the whole run, as the ArenaPlanner does
+    for (int input : interpreter->inputs()) {
+        if (use(input, 0) && use(input, last_step)) {
+            lifetimes.pinned[input] = true;
+        }
+    }
+    for (int step = 0; step < static_cast<int>(plan.size()); step++) {
+        const TfLiteNode& node = interpreter->node_and_registration(plan[step])->first;
+        for (int i = 0; i < node.inputs->size; i++) {
+            use(node.inputs->data[i], step);
+        }
+        for (int i = 0; i < node.outputs->size; i++) {
+            if (use(node.outputs->data[i], step)) {
+                lifetimes.produced[node.outputs->data[i]] = true;
+            }
+        }
+        if (node.temporaries) {
+            for (int i = 0; i < node.temporaries->size; i++) {
+                if (use(node.temporaries->data[i], step)) {
+                    lifetimes.scratch[node.temporaries->data[i]] = true;
+                }
+            }
+        }
+    }
+    for (int output : interpreter->outputs()) {
+        if (use(output, last_step)) {
+            lifetimes.pinned[output] = true;
+        }
+    }
+    return lifetimes;
+}
+
+// Raise bytes to each tensor's size at max_batch_size, for models with a
+// single batch-1 input. False if the interpreter could not be returned to
+// its current shape.
+bool GrowToBatch(tflite::Interpreter* interpreter, size_t max_batch_size, std::vector<size_t>* bytes) {
+    if (interpreter->inputs().size() != 1) {
+        return true;
+    }
+    const int input = interpreter->inputs()[0];
+    const TfLiteIntArray* dims = interpreter->tensor(input)->dims;
+    if (!dims || dims->size == 0 || dims->data[0] != 1) {
+        return true;
+    }
+
+    const std::vector<int> shape(dims->data, dims->data + dims->size);
+    std::vector<int> batched = shape;
+    batched[0] = static_cast<int>(max_batch_size);
+    if (interpreter->ResizeInputTensor(input, batched) == kTfLiteOk &&
+        interpreter->AllocateTensors() == kTfLiteOk) {
+        for (size_t i = 0; i < bytes->size(); i++) {
+            (*bytes)[i] = std::max((*bytes)[i], interpreter->tensor(static_cast<int>(i))->bytes);
+        }
+    }
+    return interpreter->ResizeInputTensor(input, shape) == kTfLiteOk &&
+           interpreter->AllocateTensors() == kTfLiteOk;
+}
+
+// One block per buffer the plan places. With in_place, the output of an
+// element-wise op joins the block of an input that dies at that op; with
+// offline offsets, tensors that have one are preassigned. False if an
+// offline offset is unusable.
+bool BuildBlocks(tflite::Interpreter* interpreter, const Lifetimes& lifetimes,
+                 const std::vector<size_t>& bytes, bool in_place,
+                 const std::vector<int64_t>* offline_offsets,
+                 std::vector<int>* block_of, std::vector<MemoryBlock>* blocks,
+                 size_t* in_place_tensors) {
+    const int num_tensors = static_cast<int>(bytes.size());
+    block_of->assign(num_tensors, -1);
+    blocks->clear();
+    *in_place_tensors = 0;
+
+    auto add_block = [&](int tensor) {
+        MemoryBlock block;
+        block.bytes = bytes[tensor];
+        block.first_use = lifetimes.first_use[tensor];
+        block.last_use = lifetimes.last_use[tensor];
+        if (offline_offsets && tensor < static_cast<int>(offline_offsets->size())) {
+            const int64_t offset = (*offline_offsets)[tensor];
+            if (offset < -1 || (offset >= 0 && offset % OFFLINE_ALIGNMENT != 0)) {
+                return false;
+            }
+            block.offset = offset;
+        }
+        (*block_of)[tensor] = static_cast<int>(blocks->size());
+        blocks->push_back(block);
+        return true;
+    };
+    auto planned = [&](int tensor) {
+        return tensor >= 0 && tensor < num_tensors && lifetimes.first_use[tensor] >= 0 &&
+               !lifetimes.scratch[tensor];
+    };
+
+    // Buffers no node of the plan writes: the graph inputs
+    for (int tensor = 0; tensor < num_tensors; tensor++) {
+        if (planned(tensor) && !lifetimes.produced[tensor] && !add_block(tensor)) {
+            return false;
+        }
+    }
+
+    const std::vector<int>& plan = interpreter->execution_plan();
+    for (int step = 0; step < static_cast<int>(plan.size()); step++) {
+        const auto* node_and_registration = interpreter->node_and_registration(plan[step]);
+        const TfLiteNode& node = node_and_registration->first;
+        const bool element_wise = in_place && node.outputs->size == 1 &&
+                                  IsElementWise(node_and_registration->second.builtin_code);
+
+        for (int i = 0; i < node.outputs->size; i++) {
+            const int output = node.outputs->data[i];
+            if (!planned(output) || (*block_of)[output] >= 0) {
+                continue;
+            }
+
+            int shared = -1;
+            for (int j = 0; element_wise && shared < 0 && j < node.inputs->size; j++) {
+                const int input = node.inputs->data[j];
+                if (!planned(input) || lifetimes.pinned[input] || (*block_of)[input] < 0) {
+                    continue;
+                }
+                const TfLiteTensor* from = interpreter->tensor(input);
+                const TfLiteTensor* to = interpreter->tensor(output);
+                const MemoryBlock& block = (*blocks)[(*block_of)[input]];
+                if (block.last_use == step && from->type == to->type &&
+                    TfLiteIntArrayEqual(from->dims, to->dims)) {
+                    shared = (*block_of)[input];
+                }
+            }
+
+            if (shared >= 0) {
+                MemoryBlock& block = (*blocks)[shared];
+                block.bytes = std::max(block.bytes, bytes[output]);
+                block.last_use = std::max(block.last_use, lifetimes.last_use[output]);
+                (*block_of)[output] = shared;
+                (*in_place_tensors)++;
+            } else if (!add_block(output)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool TFLiteMemoryPlan::Apply(tflite::Interpreter* interpreter, MemoryPlanStrategy strategy,
+                             const std::vector<int64_t>& offline_offsets, size_t max_batch_size) {
+    const Lifetimes lifetimes = Analyze(interpreter);
+    const size_t num_tensors = lifetimes.first_use.size();
+    stats_ = MemoryPlanStats();
+
+    // Control flow runs other subgraphs against these tensors, and dynamic
+    // shapes reallocate them mid-run; both stay with the ArenaPlanner
+    const bool plan = strategy != MemoryPlanStrategy::ARENA &&
+                      interpreter->subgraphs_size() == 1 && !lifetimes.dynamic;
+
+    std::vector<size_t> bytes(num_tensors);
+    for (size_t i = 0; i < num_tensors; i++) {
+        bytes[i] = interpreter->tensor(static_cast<int>(i))->bytes;
+    }
+    if (plan && max_batch_size > 1 && !GrowToBatch(interpreter, max_batch_size, &bytes)) {
+        return false;
+    }
+
+    std::vector<int> block_of;
+    std::vector<MemoryBlock> blocks;
+    size_t in_place_tensors = 0;
+    MemoryPlanStrategy applied = MemoryPlanStrategy::ARENA;
+    if (plan) {
+        applied = strategy;
+        const bool in_place = strategy == MemoryPlanStrategy::IN_PLACE;
+        const bool offline = strategy == MemoryPlanStrategy::OFFLINE && !offline_offsets.empty() &&
+                             offline_offsets.size() <= num_tensors;
+        if (!offline ||
+            !BuildBlocks(interpreter, lifetimes, bytes, false, &offline_offsets,
+                         &block_of, &blocks, &in_place_tensors) ||
+            !PlanMemoryBlocks(&blocks, TENSOR_ALIGNMENT, &arena_bytes_)) {
+            if (strategy == MemoryPlanStrategy::OFFLINE) {
+                applied = MemoryPlanStrategy::GREEDY_BY_SIZE;
+            }
+            BuildBlocks(interpreter, lifetimes, bytes, in_place, nullptr,
+                        &block_of, &blocks, &in_place_tensors);
+            PlanMemoryBlocks(&blocks, TENSOR_ALIGNMENT, &arena_bytes_);
+        }
+    }
+
+    // Buffers TFLite keeps: op scratch, plus every activation when unplanned
+    std::vector<MemoryBlock> live = blocks;
+    for (size_t i = 0; i < num_tensors; i++) {
+        if (lifetimes.first_use[i] >= 0 && (block_of.empty() || lifetimes.scratch[i])) {
+            MemoryBlock block;
+            block.bytes = bytes[i];
+            block.first_use = lifetimes.first_use[i];
+            block.last_use = lifetimes.last_use[i];
+            live.push_back(block);
+        }
+    }
+    stats_.lower_bound_bytes = PeakLiveBytes(live, TENSOR_ALIGNMENT);
+
+    if (applied != MemoryPlanStrategy::ARENA) {
+        // The extra alignment bytes align the base address
+        storage_.reset(new uint8_t[arena_bytes_ + TENSOR_ALIGNMENT]);
+        const uintptr_t address = reinterpret_cast<uintptr_t>(storage_.get());
+        uint8_t* base = storage_.get() + (AlignUp(address, TENSOR_ALIGNMENT) - address);
+
+        for (size_t i = 0; i < num_tensors; i++) {
+            if (block_of[i] < 0) {
+                continue;
+            }
+            const MemoryBlock& block = blocks[block_of[i]];
+            TfLiteCustomAllocation allocation{base + block.offset, block.bytes};
+            const int64_t flags = block.offset % TENSOR_ALIGNMENT == 0
+                ? kTfLiteCustomAllocationFlagsNone
+                : kTfLiteCustomAllocationFlagsSkipAlignCheck;
+            if (interpreter->SetCustomAllocationForTensor(static_cast<int>(i), allocation, flags) !=
+                kTfLiteOk) {
+                return false;
+            }
+            stats_.planned_tensors++;
+        }
+
+        // Drop TFLite's arena and let it re-plan only what is left to it
+        if (interpreter->ReleaseNonPersistentMemory() != kTfLiteOk ||
+            interpreter->AllocateTensors() != kTfLiteOk) {
+            return false;
+        }
+        stats_.in_place_tensors = in_place_tensors;
+    } else {
+        arena_bytes_ = 0;
+    }
+
+    tflite::Subgraph::SubgraphAllocInfo info{};
+    interpreter->primary_subgraph().GetMemoryAllocInfo(&info);
+    stats_.strategy = applied;
+    stats_.peak_arena_bytes = arena_bytes_ + info.arena_size;
+    if (stats_.peak_arena_bytes > stats_.lower_bound_bytes) {
+        stats_.fragmentation = 1.0f - static_cast<float>(stats_.lower_bound_bytes) /
+                                      static_cast<float>(stats_.peak_arena_bytes);
+    }
+    return true;
+}
+
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "memory_blocks.h"
+#include "model_engine.h"
+#include <tensorflow/lite/interpreter.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace mobileai {
+namespace inference {
+
+// Lays out the activations of an interpreter's primary subgraph in an arena
+// of its own through TFLite custom allocations, in place of the
+// ArenaPlanner; op scratch buffers stay in TFLite's arena. Regions are
+// sized for batches up to max_batch_size, so the batch dimension can still
+// be resized afterwards. Must outlive the interpreter.
+class TFLiteMemoryPlan {
+public:
+    // Analyze an allocated interpreter and, unless strategy is ARENA, move
+    // its activations into the plan. Where a plan cannot be used (control
+    // flow, dynamic tensors) TFLite's layout is kept; an unusable offline
+    // plan falls back to GREEDY_BY_SIZE. GetStats reports what was applied.
+    // False only if the interpreter could not be allocated again.
+    bool Apply(tflite::Interpreter* interpreter, MemoryPlanStrategy strategy,
+               const std::vector<int64_t>& offline_offsets, size_t max_batch_size);
+
+    // weights_bytes is left to the caller
+    MemoryPlanStats GetStats() const { return stats_; }
+    // The plan's own arena; TFLite's is reported by the interpreter
+    size_t GetArenaBytes() const { return arena_bytes_; }
+
+private:
+    std::unique_ptr<uint8_t[]> storage_;
+    size_t arena_bytes_ = 0;
+    MemoryPlanStats stats_;
+};
+
+} // namespace inference
+} // namespace mobileai
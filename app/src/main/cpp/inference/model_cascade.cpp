@@ -0,0 +1,219 @@
+#include "model_cascade.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+namespace mobileai {
+namespace inference {
+
+namespace {
+
+// Largest and second-largest softmax probability, computed stably
+void TopSoftmax(const std::vector<float>& logits, float* top1, float* top2) {
+    *top1 = 0.0f;
+    *top2 = 0.0f;
+    if (logits.empty()) {
+        return;
+    }
+
+    const float max_logit = *std::max_element(logits.begin(), logits.end());
+    float sum = 0.0f;
+    float first = -INFINITY;
+    float second = -INFINITY;
+    for (float logit : logits) {
+        sum += std::exp(logit - max_logit);
+        if (logit > first) {
+            second = first;
+            first = logit;
+        } else if (logit > second) {
+            second = logit;
+        }
+    }
+    *top1 = std::exp(first - max_logit) / sum;
+    *top2 = logits.size() > 1 ? std::exp(second - max_logit) / sum : 0.0f;
+}
+
+} // namespace
+
+float MaxSoftmaxConfidence(const std::vector<float>& logits) {
+    float top1 = 0.0f;
+    float top2 = 0.0f;
+    TopSoftmax(logits, &top1, &top2);
+    return top1;
+}
+
+float SoftmaxMarginConfidence(const std::vector<float>& logits) {
+    float top1 = 0.0f;
+    float top2 = 0.0f;
+    TopSoftmax(logits, &top1, &top2);
+    return top1 - top2;
+}
+
+float MaxProbabilityConfidence(const std::vector<float>& probabilities) {
+    return probabilities.empty() ? 0.0f
+                                 : *std::max_element(probabilities.begin(), probabilities.end());
+}
+
+class ModelCascade::Impl {
+public:
+    Impl(std::vector<CascadeStage> stages, CascadePreprocessor preprocess)
+        : stages_(std::move(stages)), preprocess_(std::move(preprocess)),
+          stage_stats_(stages_.size()) {
+        for (size_t i = 0; i < stages_.size(); i++) {
+            stage_stats_[i].name = stages_[i].name;
+        }
+    }
+
+    bool RunInference(const std::vector<float>& input,
+                      std::vector<float>& output,
+                      CascadeResult* result) {
+        thread_local std::vector<float> prepared;
+        const std::vector<float>* stage_input = &input;
+        if (preprocess_) {
+            if (!preprocess_(input, prepared)) {
+                RecordFailure();
+                return false;
+            }
+            stage_input = &prepared;
+        }
+
+        CascadeResult cascade_result;
+        bool success = false;
+        for (size_t i = 0; i < stages_.size() && !success; i++) {
+            const CascadeStage& stage = stages_[i];
+            const bool last = i + 1 == stages_.size();
+
+            InferenceMetrics metrics{};
+            bool ran = stage.engine && stage.engine->RunInference(*stage_input, output, &metrics);
+            cascade_result.metrics.inference_time_ms += metrics.inference_time_ms;
+            cascade_result.metrics.memory_usage_mb =
+                std::max(cascade_result.metrics.memory_usage_mb, metrics.memory_usage_mb);
+            cascade_result.metrics.cpu_usage_percent =
+                std::max(cascade_result.metrics.cpu_usage_percent, metrics.cpu_usage_percent);
+            cascade_result.metrics.gpu_usage_percent =
+                std::max(cascade_result.metrics.gpu_usage_percent, metrics.gpu_usage_percent);
+
+            float confidence = 0.0f;
+            if (ran && !last && stage.confidence) {
+                confidence = stage.confidence(output);
+            }
+            const bool accepted = ran && (last || confidence >= Threshold(i));
+            RecordStage(i, metrics.inference_time_ms, accepted);
+
+            if (accepted) {
+                cascade_result.stage = i;
+                cascade_result.confidence = confidence;
+                success = true;
+            }
+        }
+
+        if (!success) {
+            output.clear();
+            RecordFailure();
+        }
+        if (result) {
+            *result = cascade_result;
+        }
+        return success;
+    }
+
+    void SetThreshold(size_t stage, float threshold) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stage < stages_.size()) {
+            stages_[stage].threshold = threshold;
+        }
+    }
+
+    CascadeStats GetStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        CascadeStats stats;
+        stats.requests = requests_;
+        stats.failures = failures_;
+        for (const auto& stage : stage_stats_) {
+            CascadeStageStats stage_stats;
+            stage_stats.name = stage.name;
+            stage_stats.requests = stage.requests;
+            stage_stats.accepted = stage.accepted;
+            if (stage.requests > 0) {
+                stage_stats.average_time_ms = static_cast<float>(stage.total_time_ms / stage.requests);
+            }
+            stats.stages.push_back(std::move(stage_stats));
+        }
+        return stats;
+    }
+
+    void ResetStats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requests_ = 0;
+        failures_ = 0;
+        for (auto& stage : stage_stats_) {
+            stage.requests = 0;
+            stage.accepted = 0;
+            stage.total_time_ms = 0.0;
+        }
+    }
+
+private:
+    struct StageCounters {
+        std::string name;
+        uint64_t requests = 0;
+        uint64_t accepted = 0;
+        double total_time_ms = 0.0;
+    };
+
+    float Threshold(size_t stage) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stages_[stage].threshold;
+    }
+
+    void RecordStage(size_t stage, float time_ms, bool accepted) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stage == 0) {
+            requests_++;
+        }
+        stage_stats_[stage].requests++;
+        stage_stats_[stage].total_time_ms += time_ms;
+        if (accepted) {
+            stage_stats_[stage].accepted++;
+        }
+    }
+
+    void RecordFailure() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        failures_++;
+    }
+
+    std::vector<CascadeStage> stages_;
+    CascadePreprocessor preprocess_;
+
+    mutable std::mutex mutex_;
+    uint64_t requests_ = 0;
+    uint64_t failures_ = 0;
+    std::vector<StageCounters> stage_stats_;
+};
+
+ModelCascade::ModelCascade(std::vector<CascadeStage> stages, CascadePreprocessor preprocess)
+    : pImpl(std::make_unique<Impl>(std::move(stages), std::move(preprocess))) {}
+
+ModelCascade::~ModelCascade() = default;
+
+bool ModelCascade::RunInference(const std::vector<float>& input,
+                                std::vector<float>& output,
+                                CascadeResult* result) {
+    return pImpl->RunInference(input, output, result);
+}
+
+void ModelCascade::SetThreshold(size_t stage, float threshold) {
+    pImpl->SetThreshold(stage, threshold);
+}
+
+CascadeStats ModelCascade::GetStats() const {
+    return pImpl->GetStats();
+}
+
+void ModelCascade::ResetStats() {
+    pImpl->ResetStats();
+}
+
+} // namespace inference
+} // namespace mobileai
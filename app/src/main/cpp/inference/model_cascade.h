@@ -0,0 +1,83 @@
+#pragma once
+
+#include "model_engine.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mobileai {
+namespace inference {
+
+// Confidence of a stage's output, higher is surer
+using ConfidenceFunction = std::function<float(const std::vector<float>& output)>;
+
+// Built-in measures for classifier outputs. The softmax variants take logits;
+// MaxProbability expects a model that already ends in softmax.
+float MaxSoftmaxConfidence(const std::vector<float>& logits);
+float SoftmaxMarginConfidence(const std::vector<float>& logits);   // Top-1 minus top-2 probability
+float MaxProbabilityConfidence(const std::vector<float>& probabilities);
+
+// One model of the cascade. The stage runs on whatever device its engine was
+// initialized for, so each stage can use a different accelerator.
+struct CascadeStage {
+    std::string name;
+    std::shared_ptr<ModelEngine> engine;
+    ConfidenceFunction confidence = MaxSoftmaxConfidence;  // Not consulted on the last stage
+    float threshold = 0.9f;                                // Accept when confidence >= threshold
+};
+
+// Applied once per request; every stage receives the prepared input
+using CascadePreprocessor = std::function<bool(const std::vector<float>& input,
+                                               std::vector<float>& prepared)>;
+
+struct CascadeResult {
+    size_t stage = 0;          // Stage whose output was returned
+    float confidence = 0.0f;   // That stage's confidence
+    InferenceMetrics metrics{};  // Summed over every stage that ran
+};
+
+struct CascadeStageStats {
+    std::string name;
+    uint64_t requests = 0;
+    uint64_t accepted = 0;
+    float average_time_ms = 0.0f;
+};
+
+struct CascadeStats {
+    uint64_t requests = 0;
+    uint64_t failures = 0;
+    std::vector<CascadeStageStats> stages;
+};
+
+// Runs cheap models first and escalates a request to the next, larger model
+// only when the current stage's output falls below its confidence threshold.
+// A stage that fails also escalates; the last stage's output is always
+// returned. Safe to call from several threads.
+class ModelCascade {
+public:
+    explicit ModelCascade(std::vector<CascadeStage> stages,
+                          CascadePreprocessor preprocess = nullptr);
+    ~ModelCascade();
+
+    bool RunInference(const std::vector<float>& input,
+                     std::vector<float>& output,
+                     CascadeResult* result = nullptr);
+
+    // Tune how much traffic escalates without rebuilding the cascade
+    void SetThreshold(size_t stage, float threshold);
+
+    CascadeStats GetStats() const;
+    void ResetStats();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+
+    ModelCascade(const ModelCascade&) = delete;
+    ModelCascade& operator=(const ModelCascade&) = delete;
+};
+
+} // namespace inference
+} // namespace mobileai
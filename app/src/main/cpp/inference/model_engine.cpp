@@ -1,323 +1,2138 @@
 #include "model_engine.h"
+#include "compiled_model_cache.h"
+#include "memory_planner.h"
+#include "op_profiler.h"
+#include "op_support.h"
+#include "result_cache.h"
+#include "../core/model_blob_store.h"
+#include "../monitoring/metrics_sampler.h"
 #include <android/log.h>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <thread>
 #include <tensorflow/lite/interpreter.h>
+#include <tensorflow/lite/kernels/register.h>
 #include <tensorflow/lite/model.h>
+#include <tensorflow/lite/version.h>
+#include <tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h>
 #include <torch/script.h>
 #include <onnxruntime/core/session/onnxruntime_cxx_api.h>
 
 namespace mobileai {
 namespace inference {
 
+namespace {
+
+TensorType FromTfLiteType(TfLiteType type) {
+    switch (type) {
+        case kTfLiteFloat32: return TensorType::FLOAT32;
+        case kTfLiteFloat16: return TensorType::FLOAT16;
+        case kTfLiteInt8:    return TensorType::INT8;
+        case kTfLiteUInt8:   return TensorType::UINT8;
+        case kTfLiteInt16:   return TensorType::INT16;
+        case kTfLiteInt32:   return TensorType::INT32;
+        case kTfLiteInt64:   return TensorType::INT64;
+        default:             return TensorType::UNKNOWN;
+    }
+}
+
+TensorType FromONNXType(ONNXTensorElementDataType type) {
+    switch (type) {
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:   return TensorType::FLOAT32;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16: return TensorType::FLOAT16;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8:    return TensorType::INT8;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:   return TensorType::UINT8;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT16:   return TensorType::INT16;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:   return TensorType::INT32;
+        case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:   return TensorType::INT64;
+        default:                                    return TensorType::UNKNOWN;
+    }
+}
+
+TensorInfo DescribeTFLiteTensor(const TfLiteTensor* tensor) {
+    TensorInfo info;
+    info.name = tensor->name ? tensor->name : "";
+    info.type = FromTfLiteType(tensor->type);
+    if (tensor->dims) {
+        info.shape.assign(tensor->dims->data, tensor->dims->data + tensor->dims->size);
+    }
+    info.quantization.scale = tensor->params.scale;
+    info.quantization.zero_point = tensor->params.zero_point;
+    info.bytes = tensor->bytes;
+    return info;
+}
+
+void FillView(const TfLiteTensor* tensor, TensorView* view) {
+    view->data = tensor->data.raw;
+    view->bytes = tensor->bytes;
+    view->type = FromTfLiteType(tensor->type);
+}
+
+int FindTensor(const std::vector<TensorInfo>& tensors, const std::string& name) {
+    for (size_t i = 0; i < tensors.size(); i++) {
+        if (tensors[i].name == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+struct LatencyTrace {
+    float first_ms = 0.0f;
+    float steady_ms = 0.0f;   // Median of the final window
+    size_t runs = 0;
+    bool converged = false;
+};
+
+// Repeat run() until the last few latencies agree within options.tolerance,
+// bounded by min_runs and max_runs
+template <typename Run>
+bool RunUntilConverged(Run run, const WarmUpOptions& options, LatencyTrace& trace) {
+    constexpr size_t WINDOW = 3;
+    std::deque<float> recent;
+    const size_t max_runs = std::max(options.max_runs, options.min_runs);
+
+    for (size_t i = 0; i < max_runs; i++) {
+        auto start = std::chrono::steady_clock::now();
+        if (!run()) {
+            return false;
+        }
+        float elapsed_ms = std::chrono::duration<float, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+        if (i == 0) {
+            trace.first_ms = elapsed_ms;
+        }
+        trace.runs++;
+        recent.push_back(elapsed_ms);
+        if (recent.size() > WINDOW) {
+            recent.pop_front();
+        }
+
+        if (trace.runs >= options.min_runs && recent.size() == WINDOW) {
+            auto bounds = std::minmax_element(recent.begin(), recent.end());
+            if (*bounds.second - *bounds.first <= options.tolerance * *bounds.first) {
+                trace.converged = true;
+                break;
+            }
+        }
+    }
+
+    if (!recent.empty()) {
+        std::vector<float> sorted(recent.begin(), recent.end());
+        std::sort(sorted.begin(), sorted.end());
+        trace.steady_ms = sorted[sorted.size() / 2];
+    }
+    return true;
+}
+
+WarmUpOptions FixedRunCount(size_t num_runs) {
+    WarmUpOptions options;
+    options.min_runs = num_runs;
+    options.max_runs = num_runs;
+    return options;
+}
+
+struct ONNXBuffer {
+    std::vector<uint8_t> storage;
+    std::vector<int64_t> shape;
+    Ort::Value value{nullptr};
+    bool dynamic_batch = false;
+};
+
+struct ModelInstance;
+
+// Cancellation of the request an execution context is serving: its token,
+// if any, and the engine's CancelAllInferences count when it started
+struct CancelScope {
+    const CancellationToken* token = nullptr;
+    const std::atomic<uint64_t>* generation = nullptr;
+    uint64_t start_generation = 0;
+
+    bool Cancelled() const {
+        return (token && token->IsCancelled()) ||
+               (generation && generation->load(std::memory_order_relaxed) != start_generation);
+    }
+};
+
+// How often cancellation is polled where nothing calls back: ONNX runs and
+// requests waiting for a context
+constexpr std::chrono::milliseconds CANCEL_POLL_INTERVAL(1);
+
+// Per-request execution state: a TFLite interpreter, an ONNX IoBinding with
+// its buffers, or staging tensors for PyTorch and custom models. A context is
+// only ever used by one thread at a time.
+struct ExecutionContext {
+    ~ExecutionContext();
+
+    ModelInstance* model = nullptr;
+    size_t arena_bytes = 0;   // Last estimate, included in model->arena_bytes
+    CancelScope cancel;       // TFLite polls it between ops
+
+    // TFLite. The delegate and the memory plan are declared first so they
+    // outlive the interpreter.
+    std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)> delegate{
+        nullptr, TfLiteXNNPackDelegateDelete};
+    std::unique_ptr<TFLiteMemoryPlan> memory_plan;   // ModelConfig::memory_plan
+    std::unique_ptr<tflite::Interpreter> interpreter;
+    std::set<std::string> allocated_signatures;
+    std::unique_ptr<TFLiteOpProfiler> op_profiler;   // ModelConfig::enable_op_profiling
+    std::vector<OpProfile> op_profile;               // Ops of the last Invoke
+
+    // ONNX Runtime
+    std::unique_ptr<Ort::IoBinding> io_binding;
+    std::unique_ptr<Ort::RunOptions> run_options;   // Terminated to cancel a run
+    bool terminated = false;                         // Guarded by the engine's watchdog_mutex_
+    std::vector<ONNXBuffer> onnx_inputs;
+    std::vector<ONNXBuffer> onnx_outputs;
+
+    // PyTorch
+    torch::Tensor torch_input;
+    torch::Tensor torch_output;
+
+    // Custom
+    Span<const float> custom_input;
+    std::vector<float> custom_output;
+
+    // Tensor layout at the current batch size
+    std::vector<TensorInfo> input_info;
+    std::vector<TensorInfo> output_info;
+    size_t batch_size = 1;
+    std::vector<float> batch_staging;
+};
+
+// Where a model's requests execute
+enum class Placement {
+    ACCELERATOR,    // Whole model through HardwareAccelerator::RunInference
+    CPU             // Execution contexts only
+};
+
+// Arms of ModelInstance::backend_selector
+constexpr size_t ACCELERATOR_BACKEND = 0;
+constexpr size_t CPU_BACKEND = 1;
+
+// A loaded model: read-only weights shared by every execution context, plus
+// the pool those contexts are checked out of
+struct ModelInstance {
+    ~ModelInstance();
+
+    std::string path;
+    ModelFormat format = ModelFormat::TFLITE;
+    uint64_t version = 0;         // Keys memoized results (ModelConfig::result_cache_mb)
+    bool pre_optimized = false;   // Loaded from an OptimizeModel artifact
+    bool fast_start = false;      // Light load-time optimization; a background pass follows
+
+    // Mapped model file; declared first so it outlives everything built on it
+    std::shared_ptr<const core::ModelBlob> blob;
+
+    // The engine's accelerator at load time. Whole-model runs use it through
+    // this reference, so it outlives the engine releasing it.
+    std::shared_ptr<hardware::HardwareAccelerator> accelerator;
+
+    std::unique_ptr<tflite::FlatBufferModel> tflite_model;
+    std::unique_ptr<Ort::Session> session;
+    std::vector<std::string> input_names;
+    std::vector<std::string> output_names;
+    torch::jit::Module module;
+    Span<const uint8_t> custom_model_data;
+
+    // CPU for TFLite models with no op the accelerator supports
+    Placement placement = Placement::ACCELERATOR;
+
+    // Whole-model accelerator placement under ModelConfig::adaptive_backend
+    std::unique_ptr<hardware::BackendSelector> backend_selector;
+
+    // ModelConfig::enable_op_profiling; ONNX sessions profile until the
+    // first GetOpProfile
+    std::unique_ptr<OpProfileWindow> op_profile;
+    std::atomic<bool> onnx_profiling{false};
+
+    // ModelConfig::enable_preprocessing
+    std::unique_ptr<ImagePreprocessor> preprocessor;
+
+    // ModelConfig::memory_plan; planned regions fit batches up to max_batch_size
+    MemoryPlanStrategy memory_plan = MemoryPlanStrategy::ARENA;
+    std::vector<int64_t> offline_memory_plan;
+    size_t max_batch_size = 1;
+    MemoryPlanStats memory_plan_stats;   // Of the first context
+
+    // Batch-1 description of the model's inputs and outputs
+    std::vector<TensorInfo> input_info;
+    std::vector<TensorInfo> output_info;
+
+    // Prepared-artifact cache and entry used by this load (ModelConfig::enable_caching)
+    std::shared_ptr<CompiledModelCache> compiled_cache;
+    CompiledModelKey cache_key;
+    std::string cache_artifact_path;
+    bool cache_hit = false;
+
+    // Residency accounting; arena_bytes sums every live context of this model
+    size_t weights_bytes = 0;
+    std::atomic<size_t> arena_bytes{0};
+
+    std::mutex pool_mutex;
+    std::condition_variable pool_cv;
+    std::condition_variable drained_cv;   // Signalled when no context is checked out
+    std::vector<std::unique_ptr<ExecutionContext>> idle_contexts;
+    size_t total_contexts = 0;
+    size_t num_contexts = 1;
+    size_t max_contexts = 1;
+};
+
+ExecutionContext::~ExecutionContext() {
+    if (model) {
+        model->arena_bytes -= arena_bytes;
+    }
+}
+
+ModelInstance::~ModelInstance() {
+    // A profiled ORT session writes its trace when it closes; end the
+    // profile here instead and drop the file
+    if (onnx_profiling && session) {
+        try {
+            Ort::AllocatorWithDefaultOptions allocator;
+            auto trace = session->EndProfilingAllocated(allocator);
+            std::error_code ec;
+            std::filesystem::remove(trace.get(), ec);
+        } catch (const std::exception&) {
+        }
+    }
+}
+
+// Arms a context's cancellation for the request holding it
+class CancelGuard {
+public:
+    CancelGuard(ExecutionContext& context, const CancelScope& scope) : context_(context) {
+        context_.cancel = scope;
+    }
+    ~CancelGuard() { context_.cancel = CancelScope(); }
+
+private:
+    ExecutionContext& context_;
+
+    CancelGuard(const CancelGuard&) = delete;
+    CancelGuard& operator=(const CancelGuard&) = delete;
+};
+
+// A streaming session's model version and its dedicated context
+struct StreamState {
+    std::shared_ptr<ModelInstance> model;        // Declared first so it outlives the context
+    std::unique_ptr<ExecutionContext> context;
+    std::vector<std::pair<size_t, size_t>> state_bindings;  // Output index -> input index
+    size_t input_count = 0;                      // Float elements of input 0
+    std::vector<float> window;                   // Sliding window for chunks smaller than input 0
+    uint64_t steps = 0;
+};
+
+// Collects the error of the request running on this thread. last_error_ is
+// shared by every request of an engine, so it can name another request's
+// failure; scopes nest, and an engine called from within another engine's
+// request (cascades, ensembles) reports into the outer request.
+class RequestErrorScope {
+public:
+    RequestErrorScope() : previous_(Current()) { Current() = this; }
+    ~RequestErrorScope() { Current() = previous_; }
+
+    static void Record(hardware::HardwareAccelerator::ErrorCode code) {
+        if (Current()) {
+            Current()->error_ = code;
+        }
+    }
+
+    // A failed run that recorded nothing is reported as a hardware error
+    hardware::HardwareAccelerator::ErrorCode Result(bool success) const {
+        if (success) {
+            return hardware::HardwareAccelerator::ErrorCode::SUCCESS;
+        }
+        return error_ != hardware::HardwareAccelerator::ErrorCode::SUCCESS
+            ? error_ : hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR;
+    }
+
+    RequestErrorScope(const RequestErrorScope&) = delete;
+    RequestErrorScope& operator=(const RequestErrorScope&) = delete;
+
+private:
+    static RequestErrorScope*& Current() {
+        static thread_local RequestErrorScope* current = nullptr;
+        return current;
+    }
+
+    RequestErrorScope* previous_;
+    hardware::HardwareAccelerator::ErrorCode error_ = hardware::HardwareAccelerator::ErrorCode::SUCCESS;
+};
+
+} // namespace
+
 class ModelEngine::Impl {
 public:
-    Impl() : num_threads_(1), hw_acceleration_enabled_(true), 
-             memory_limit_mb_(0), power_profile_(hardware::HardwareAccelerator::PowerProfile::BALANCED) {}
+    Impl() : num_threads_(1), hw_acceleration_enabled_(true),
+             memory_limit_mb_(0), power_profile_(hardware::HardwareAccelerator::PowerProfile::BALANCED),
+             process_stats_(monitoring::ProcessStatsSampler::Shared()) {}
+
+    ~Impl() {
+        StopAsyncWorkers();
+        StopBackgroundOptimization();
+        StopWatchdog();
+    }
 
     bool Initialize(std::unique_ptr<hardware::HardwareAccelerator> accelerator) {
         accelerator_ = std::move(accelerator);
         auto result = accelerator_->Initialize();
         if (result != hardware::HardwareAccelerator::ErrorCode::SUCCESS) {
-            if (error_callback_) {
-                error_callback_(result, "Failed to initialize hardware accelerator");
-            }
-            last_error_ = result;
+            ReportError(result, "Failed to initialize hardware accelerator");
+            SetError(result);
             return false;
         }
         return true;
     }
 
     bool LoadModel(const std::string& model_path, ModelFormat format, const ModelConfig& config) {
-        model_path_ = model_path;
-        format_ = format;
-        config_ = config;
-        
-        bool success = false;
-        switch (format) {
-            case ModelFormat::TFLITE:
-                success = LoadTFLiteModel();
-                break;
-            case ModelFormat::PYTORCH:
-                success = LoadPyTorchModel();
-                break;
-            case ModelFormat::ONNX:
-                success = LoadONNXModel();
-                break;
-            case ModelFormat::CUSTOM:
-                success = LoadCustomModel();
-                break;
-            default:
-                if (error_callback_) {
-                    error_callback_(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT, 
-                                  "Unsupported model format");
-                }
-                return false;
+        // An optimization still running for the previous model must not
+        // swap in over this one
+        StopBackgroundOptimization();
+
+        auto model = PrepareModel(model_path, format, config);
+        if (!model) {
+            return false;
         }
 
-        if (success && config_.enable_optimization) {
-            OptimizeModel(model_path_ + ".optimized");
+        SetConfig(config);
+        ConfigureResultCache(config);
+        primary_context_.reset();
+        primary_model_.reset();
+        PublishModel(model, model_path);
+        return true;
+    }
+
+    bool ReplaceModel(const std::string& model_path, ModelFormat format,
+                      const ModelConfig& config, size_t warmup_runs) {
+        StopBackgroundOptimization();
+
+        // The current version keeps serving while the new one loads and warms
+        auto model = PrepareModel(model_path, format, config);
+        if (!model || !WarmUpInstance(*model, warmup_runs)) {
+            return false;
         }
 
-        return success;
+        SetConfig(config);
+        ConfigureResultCache(config);
+        PublishModel(model, model_path);
+        return true;
     }
 
-    bool RunInference(const std::vector<float>& input, 
+    bool RunInference(const std::vector<float>& input,
                      std::vector<float>& output,
                      InferenceMetrics* metrics = nullptr) {
-        auto start_time = std::chrono::high_resolution_clock::now();
+        auto cache = std::atomic_load(&result_cache_);
+        auto model = CurrentModel();
+        if (!cache || !model) {
+            return RunModel(input, output, metrics);
+        }
 
-        hardware::HardwareAccelerator::PerformanceMetrics hw_metrics;
-        bool success = false;
+        auto start_time = std::chrono::high_resolution_clock::now();
+        InferenceMetrics run_metrics{};
+        bool ran = false;
+        bool success = cache->GetOrCompute(
+            model->version, Span<const float>(input.data(), input.size()), output,
+            [&](std::vector<float>& result) {
+                ran = true;
+                return RunModel(input, result, &run_metrics);
+            });
+        if (!ran) {
+            RecordMetrics(start_time, success, {}, metrics);
+        } else if (metrics) {
+            *metrics = run_metrics;
+        }
+        return success;
+    }
 
-        if (hw_acceleration_enabled_ && accelerator_ && accelerator_->IsAvailable()) {
-            success = (accelerator_->RunInference(input, output, &hw_metrics) == 
-                      hardware::HardwareAccelerator::ErrorCode::SUCCESS);
-        } else {
-            success = RunCPUInference(input, output);
+    // Cached requests stage through thread-local vectors, so this overload
+    // only stays allocation-free with the result cache off
+    bool RunInference(Span<const float> input,
+                     Span<float> output,
+                     size_t* output_size,
+                     InferenceMetrics* metrics) {
+        auto cache = std::atomic_load(&result_cache_);
+        auto model = CurrentModel();
+        if (!cache || !model) {
+            return RunModel(input, output, output_size, metrics);
         }
 
-        auto end_time = std::chrono::high_resolution_clock::now();
-        
-        if (metrics) {
-            metrics->inference_time_ms = 
-                std::chrono::duration<float, std::milli>(end_time - start_time).count();
-            metrics->memory_usage_mb = GetCurrentMemoryUsage();
-            metrics->cpu_usage_percent = GetCPUUsage();
-            metrics->gpu_usage_percent = hw_acceleration_enabled_ ? hw_metrics.utilizationPercent : 0.0f;
+        thread_local std::vector<float> staged_input;
+        thread_local std::vector<float> staged_output;
+        staged_input.assign(input.begin(), input.end());
+        if (!RunInference(staged_input, staged_output, metrics)) {
+            return false;
         }
 
-        return success;
+        if (output_size) {
+            *output_size = staged_output.size();
+        }
+        if (staged_output.size() > output.size()) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::RESOURCE_EXHAUSTED);
+            return false;
+        }
+        std::copy(staged_output.begin(), staged_output.end(), output.begin());
+        return true;
     }
 
-    bool RunBatchInference(const std::vector<std::vector<float>>& inputs,
-                          std::vector<std::vector<float>>& outputs,
-                          InferenceMetrics* metrics = nullptr) {
-        if (inputs.size() > config_.max_batch_size) {
-            if (error_callback_) {
-                error_callback_(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT,
-                              "Batch size exceeds maximum allowed");
-            }
+    bool RunInference(const ImageBuffer& image,
+                     std::vector<float>& output,
+                     InferenceMetrics* metrics) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        hardware::HardwareAccelerator::PerformanceMetrics hw_metrics{};
+        bool success = false;
+
+        auto model = CurrentModel();
+        if (!model || !model->preprocessor || model->input_info.empty() ||
+            (model->format != ModelFormat::TFLITE && model->format != ModelFormat::ONNX)) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
             return false;
         }
 
-        outputs.resize(inputs.size());
-        bool success = true;
-        InferenceMetrics batch_metrics;
-
-        for (size_t i = 0; i < inputs.size(); i++) {
-            InferenceMetrics single_metrics;
-            if (!RunInference(inputs[i], outputs[i], &single_metrics)) {
-                success = false;
+        const CancelScope cancel = BeginRequest(nullptr);
+        const size_t backend = SelectBackend(model.get());
+        if (backend == ACCELERATOR_BACKEND && model->accelerator) {
+            // The accelerator takes float input from host memory
+            TensorInfo info = model->input_info[0];
+            size_t count = info.bytes / TensorTypeSize(info.type);
+            info.type = TensorType::FLOAT32;
+            info.quantization = QuantizationParams();
+            thread_local std::vector<float> staged_input;
+            staged_input.resize(count);
+            if (model->preprocessor->Run(image, info, staged_input.data(), count * sizeof(float))) {
+                std::lock_guard<std::mutex> lock(accelerator_mutex_);
+                success = (model->accelerator->RunInference(staged_input, output, &hw_metrics) ==
+                          hardware::HardwareAccelerator::ErrorCode::SUCCESS);
+            } else {
+                SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
             }
-            batch_metrics.inference_time_ms += single_metrics.inference_time_ms;
-            batch_metrics.memory_usage_mb = std::max(batch_metrics.memory_usage_mb, 
-                                                   single_metrics.memory_usage_mb);
-            batch_metrics.cpu_usage_percent = std::max(batch_metrics.cpu_usage_percent,
-                                                     single_metrics.cpu_usage_percent);
-            batch_metrics.gpu_usage_percent = std::max(batch_metrics.gpu_usage_percent,
-                                                     single_metrics.gpu_usage_percent);
+        } else if (PooledContext context = AcquireContext(&cancel)) {
+            CancelGuard guard(*context, cancel);
+            success = PreprocessInput(*context, image) && Execute(*context);
+            if (success) {
+                TensorView view;
+                success = GetOutputBuffer(*context, 0, &view) && view.type == TensorType::FLOAT32;
+                if (success) {
+                    output.resize(view.Count<float>());
+                    std::memcpy(output.data(), view.data, output.size() * sizeof(float));
+                }
+            }
+            TakeOpProfile(*context, metrics);
         }
 
-        if (metrics) {
-            *metrics = batch_metrics;
+        if (!RecordCancellation(cancel, success)) {
+            RecordBackend(model.get(), backend, start_time, success);
         }
-
+        RecordMetrics(start_time, success, hw_metrics, metrics);
         return success;
     }
 
-    void SetNumThreads(int num_threads) {
-        num_threads_ = std::max(1, num_threads);
+    bool RunInference(const std::vector<float>& input,
+                     std::vector<float>& output,
+                     const CancellationToken& token,
+                     InferenceMetrics* metrics) {
+        return RunModel(input, output, metrics, &token);
     }
 
-    void EnableHardwareAcceleration(bool enable) {
-        hw_acceleration_enabled_ = enable;
+    void CancelAllInferences() {
+        cancel_generation_.fetch_add(1, std::memory_order_relaxed);
+
+        // Queued requests never start
+        std::deque<AsyncRequest> pending;
+        {
+            std::lock_guard<std::mutex> lock(async_mutex_);
+            pending.swap(async_queue_);
+        }
+        cancelled_requests_.fetch_add(pending.size(), std::memory_order_relaxed);
+        for (auto& request : pending) {
+            request.result.request_id = request.id;
+            request.result.error = hardware::HardwareAccelerator::ErrorCode::CANCELLED;
+            Complete(request);
+        }
+
+        // Running ONNX sessions are terminated without waiting for the next poll
+        watchdog_cv_.notify_one();
     }
 
-    void SetPowerProfile(hardware::HardwareAccelerator::PowerProfile profile) {
-        power_profile_ = profile;
+    ResultCacheStats GetResultCacheStats() const {
+        auto cache = std::atomic_load(&result_cache_);
+        return cache ? cache->GetStats() : ResultCacheStats();
     }
 
-    void SetMemoryLimit(size_t memory_mb) {
-        memory_limit_mb_ = memory_mb;
+    InferenceStats GetInferenceStats() const {
+        monitoring::LatencySnapshot latency = latency_.Snapshot();
+        monitoring::ProcessStats process = process_stats_->Get();
+        InferenceStats stats;
+        stats.requests = latency.requests;
+        stats.failures = latency.failures;
+        stats.cancelled = cancelled_requests_.load(std::memory_order_relaxed);
+        stats.average_ms = latency.average_ms;
+        stats.p50_ms = latency.p50_ms;
+        stats.p95_ms = latency.p95_ms;
+        stats.p99_ms = latency.p99_ms;
+        stats.max_ms = latency.max_ms;
+        stats.memory_usage_mb = process.memory_usage_mb;
+        stats.cpu_usage_percent = process.cpu_usage_percent;
+        return stats;
     }
 
-    void SetErrorCallback(ErrorCallback callback) {
-        error_callback_ = callback;
+    void ResetInferenceStats() {
+        latency_.Reset();
+        cancelled_requests_.store(0, std::memory_order_relaxed);
     }
 
-    hardware::HardwareAccelerator::ErrorCode GetLastError() const {
-        return last_error_;
+    std::vector<OpProfileSummary> GetOpProfile() const {
+        auto model = CurrentModel();
+        if (!model || !model->op_profile) {
+            return {};
+        }
+        if (model->onnx_profiling.exchange(false)) {
+            CollectONNXProfile(*model);
+        }
+        return model->op_profile->GetSummary();
     }
 
-    bool OptimizeModel(const std::string& output_path) {
-        if (!accelerator_) {
-            last_error_ = hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
+    void ResetOpProfile() {
+        auto model = CurrentModel();
+        if (model && model->op_profile) {
+            model->op_profile->Reset();
+        }
+    }
+
+    std::vector<hardware::BackendStats> GetBackendStats() const {
+        auto model = CurrentModel();
+        return model && model->backend_selector ? model->backend_selector->GetStats()
+                                                : std::vector<hardware::BackendStats>();
+    }
+
+    bool RunModel(const std::vector<float>& input,
+                  std::vector<float>& output,
+                  InferenceMetrics* metrics,
+                  const CancellationToken* token = nullptr) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        hardware::HardwareAccelerator::PerformanceMetrics hw_metrics{};
+        bool success = false;
+
+        auto model = CurrentModel();
+        if (!model) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
             return false;
         }
 
-        try {
-            // Get supported optimizations from accelerator
-            auto supported_ops = accelerator_->GetSupportedOperations();
-            
-            // Apply hardware-specific optimizations
-            if (format_ == ModelFormat::TFLITE) {
-                tflite::ops::builtin::BuiltinOpResolver resolver;
-                for (const auto& op : supported_ops) {
-                    resolver.AddBuiltin(op);
+        const CancelScope cancel = BeginRequest(token);
+        const size_t backend = SelectBackend(model.get());
+        if (backend == ACCELERATOR_BACKEND && model->accelerator) {
+            // Whole-model accelerator runs cannot be interrupted
+            if (!cancel.Cancelled()) {
+                std::lock_guard<std::mutex> lock(accelerator_mutex_);
+                success = (model->accelerator->RunInference(input, output, &hw_metrics) ==
+                          hardware::HardwareAccelerator::ErrorCode::SUCCESS);
+            }
+        } else if (PooledContext context = AcquireContext(&cancel)) {
+            CancelGuard guard(*context, cancel);
+            if (RunCPUInference(*context, Span<const float>(input.data(), input.size()))) {
+                TensorView view;
+                success = GetOutputBuffer(*context, 0, &view) && view.type == TensorType::FLOAT32;
+                if (success) {
+                    // resize() only reallocates when the output grows
+                    output.resize(view.Count<float>());
+                    std::memcpy(output.data(), view.data, output.size() * sizeof(float));
                 }
-                tflite::InterpreterBuilder builder(*model_, resolver);
-                builder.SetNumThreads(num_threads_);
-                builder.OptimizeMemoryUse();
-            } else if (format_ == ModelFormat::PYTORCH) {
-                torch::jit::Module optimized = torch::jit::optimize_for_mobile(module_);
-                optimized.save(output_path);
-            } else if (format_ == ModelFormat::ONNX) {
-                Ort::SessionOptions session_options;
-                session_options.SetGraphOptimizationLevel(
-                    GraphOptimizationLevel::ORT_ENABLE_ALL);
-                session_options.SetIntraOpNumThreads(num_threads_);
-                session_ = std::make_unique<Ort::Session>(env_, model_path_.c_str(), 
-                                                        session_options);
             }
+            TakeOpProfile(*context, metrics);
+        }
 
-            // Save optimized model
-            std::filesystem::path out_path(output_path);
-            if (!std::filesystem::exists(out_path.parent_path())) {
-                std::filesystem::create_directories(out_path.parent_path());
-            }
-            
-            return true;
-        } catch (const std::exception& e) {
-            if (error_callback_) {
-                error_callback_(hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR, e.what());
-            }
-            last_error_ = hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR;
-            return false;
+        if (!RecordCancellation(cancel, success)) {
+            RecordBackend(model.get(), backend, start_time, success);
         }
+        RecordMetrics(start_time, success, hw_metrics, metrics);
+        return success;
     }
 
-    bool QuantizeModel(const std::string& output_path, bool dynamic) {
-        if (!accelerator_) {
-            last_error_ = hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
+    bool RunModel(Span<const float> input,
+                  Span<float> output,
+                  size_t* output_size,
+                  InferenceMetrics* metrics) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        hardware::HardwareAccelerator::PerformanceMetrics hw_metrics{};
+        bool success = false;
+
+        auto model = CurrentModel();
+        if (!model) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
             return false;
         }
 
-        try {
-            // Check if quantization is supported
-            if (!accelerator_->SupportsOperation("QUANTIZATION")) {
-                last_error_ = hardware::HardwareAccelerator::ErrorCode::UNSUPPORTED_OPERATION;
-                return false;
+        const CancelScope cancel = BeginRequest(nullptr);
+        const size_t backend = SelectBackend(model.get());
+        if (backend == ACCELERATOR_BACKEND && model->accelerator) {
+            size_t produced = 0;
+            std::lock_guard<std::mutex> lock(accelerator_mutex_);
+            auto result = model->accelerator->RunInference(input.data(), input.size(),
+                                                           output.data(), output.size(),
+                                                           &produced, &hw_metrics);
+            if (output_size) {
+                *output_size = produced;
             }
-
-            // Apply quantization based on format
-            if (format_ == ModelFormat::TFLITE) {
-                tflite::ops::builtin::BuiltinOpResolver resolver;
-                std::unique_ptr<tflite::FlatBufferModel> model =
-                    tflite::FlatBufferModel::BuildFromFile(model_path_.c_str());
-                    
-                tflite::QuantizationParams quant_params;
-                quant_params.inference_type = dynamic ? 
-                    tflite::TensorType_INT8 : tflite::TensorType_FLOAT32;
-                    
-                tflite::Interpreter* interpreter;
-                tflite::InterpreterBuilder(*model, resolver)(&interpreter);
-                interpreter->UseNNAPI(false);
-                interpreter->SetNumThreads(num_threads_);
-                
-                if (dynamic) {
-                    interpreter->ApplyDelegates();
-                }
-                
-                // Save quantized model
-                std::ofstream output_file(output_path, std::ios::binary);
-                output_file.write(reinterpret_cast<const char*>(model->GetBuffer()),
-                                model->GetSize());
-            } else if (format_ == ModelFormat::PYTORCH) {
-                torch::jit::Module quantized;
-                if (dynamic) {
-                    quantized = torch::jit::quantize_dynamic(module_);
-                } else {
-                    quantized = torch::jit::quantize_per_tensor(module_);
-                }
-                quantized.save(output_path);
-            } else if (format_ == ModelFormat::ONNX) {
-                Ort::SessionOptions session_options;
-                session_options.SetGraphOptimizationLevel(
-                    GraphOptimizationLevel::ORT_ENABLE_ALL);
-                session_options.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
-                
-                if (dynamic) {
-                    session_options.SetExecutionMode(ExecutionMode::ORT_PARALLEL);
-                }
-                
-                session_ = std::make_unique<Ort::Session>(env_, model_path_.c_str(), 
-                                                        session_options);
-                                                        
-                // Save quantized model
-                session_->Save(output_path.c_str(), 
-                             Ort::SaveOption::NO_SAVE_OPTIMIZER_STATE);
+            success = (result == hardware::HardwareAccelerator::ErrorCode::SUCCESS);
+            if (!success) {
+                SetError(result);
             }
+        } else if (PooledContext context = AcquireContext(&cancel)) {
+            CancelGuard guard(*context, cancel);
+            success = RunCPUInference(*context, input) && CopyOutput(*context, output, output_size);
+            TakeOpProfile(*context, metrics);
+        }
 
-            return true;
-        } catch (const std::exception& e) {
-            if (error_callback_) {
-                error_callback_(hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR, e.what());
-            }
-            last_error_ = hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR;
-            return false;
+        if (!RecordCancellation(cancel, success)) {
+            RecordBackend(model.get(), backend, start_time, success);
         }
+        RecordMetrics(start_time, success, hw_metrics, metrics);
+        return success;
     }
 
-    void ReleaseResources() {
-        // Release hardware accelerator resources
-        if (accelerator_) {
-            accelerator_.reset();
-        }
+    bool GetInputBuffer(size_t index, TensorView* view) {
+        ExecutionContext* context = PrimaryContext();
+        primary_inputs_pending_ = true;
+        return context && GetInputBuffer(*context, index, view);
+    }
 
-        // Clear model data
-        model_path_.clear();
-        
-        // Reset configuration
-        config_ = ModelConfig();
-        num_threads_ = 1;
-        hw_acceleration_enabled_ = true;
-        memory_limit_mb_ = 0;
-        power_profile_ = hardware::HardwareAccelerator::PowerProfile::BALANCED;
-        
-        // Clear error state
-        error_callback_ = nullptr;
-        last_error_ = hardware::HardwareAccelerator::ErrorCode::SUCCESS;
+    bool GetOutputBuffer(size_t index, TensorView* view) {
+        ExecutionContext* context = PrimaryContext();
+        return context && GetOutputBuffer(*context, index, view);
     }
 
-    bool WarmUp(size_t num_runs) {
-        std::vector<float> dummy_input(GetInputSize());
-        std::vector<float> dummy_output;
-        
-        bool success = true;
-        for (size_t i = 0; i < num_runs; i++) {
-            if (!RunInference(dummy_input, dummy_output)) {
-                success = false;
-                break;
-            }
+    bool GetOutputTensor(size_t index, TensorView* view, TensorInfo* info) {
+        ExecutionContext* context = PrimaryContext();
+        if (!context || !info || !GetOutputBuffer(*context, index, view)) {
+            return false;
         }
-        return success;
+        if (index >= context->output_info.size()) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+            return false;
+        }
+        *info = context->output_info[index];
+        return true;
     }
 
-private:
-    size_t GetInputSize() {
-        switch (format_) {
-            case ModelFormat::TFLITE: {
-                auto* input_tensor = interpreter_->input_tensor(0);
-                return input_tensor->bytes / sizeof(float);
+    std::vector<std::string> GetSignatureKeys() {
+        std::vector<std::string> keys;
+        ExecutionContext* context = PrimaryContext();
+        if (context && context->interpreter) {
+            for (const std::string* key : context->interpreter->signature_keys()) {
+                keys.push_back(*key);
             }
-            case ModelFormat::PYTORCH: {
-                auto input_shape = module_.get_method("forward").graph()->inputs()[0]->type()->sizes();
-                return std::accumulate(input_shape.begin(), input_shape.end(), 1, std::multiplies<int64_t>());
+        }
+        return keys;
+    }
+
+    std::vector<TensorInfo> GetTensorInfo(bool is_input, const std::string& signature_key) {
+        if (signature_key.empty()) {
+            auto model = CurrentModel();
+            if (!model) {
+                return {};
+            }
+            return is_input ? model->input_info : model->output_info;
+        }
+
+        std::vector<TensorInfo> tensors;
+        tflite::SignatureRunner* runner = GetSignatureRunner(signature_key);
+        if (!runner) {
+            return tensors;
+        }
+
+        const auto& names = is_input ? runner->input_names() : runner->output_names();
+        for (const char* name : names) {
+            const TfLiteTensor* tensor = is_input ? runner->input_tensor(name)
+                                                  : runner->output_tensor(name);
+            TensorInfo info = DescribeTFLiteTensor(tensor);
+            info.name = name;
+            tensors.push_back(std::move(info));
+        }
+        return tensors;
+    }
+
+    bool GetTensorBuffer(bool is_input, const std::string& name,
+                         const std::string& signature_key, TensorView* view) {
+        if (!view) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+            return false;
+        }
+
+        if (!signature_key.empty()) {
+            tflite::SignatureRunner* runner = GetSignatureRunner(signature_key);
+            if (!runner) {
+                return false;
+            }
+            primary_inputs_pending_ = primary_inputs_pending_ || is_input;
+            const TfLiteTensor* tensor = is_input ? runner->input_tensor(name.c_str())
+                                                  : runner->output_tensor(name.c_str());
+            if (!tensor) {
+                SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+                return false;
+            }
+            FillView(tensor, view);
+            return true;
+        }
+
+        ExecutionContext* context = PrimaryContext();
+        int index = context ? FindTensor(is_input ? context->input_info : context->output_info, name) : -1;
+        if (index < 0) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+            return false;
+        }
+        return is_input ? GetInputBuffer(index, view) : GetOutputBuffer(index, view);
+    }
+
+    bool SetInput(const std::string& name, const void* data, size_t bytes, TensorType type,
+                  const std::string& signature_key) {
+        TensorView view;
+        if (!GetTensorBuffer(true, name, signature_key, &view)) {
+            return false;
+        }
+        if (view.type != type || bytes != view.bytes) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+            return false;
+        }
+        std::memcpy(view.data, data, bytes);
+        return true;
+    }
+
+    bool GetOutput(const std::string& name, void* data, size_t bytes, TensorType type,
+                   const std::string& signature_key) {
+        TensorView view;
+        if (!GetTensorBuffer(false, name, signature_key, &view)) {
+            return false;
+        }
+        if (view.type != type) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+            return false;
+        }
+        if (bytes < view.bytes) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::RESOURCE_EXHAUSTED);
+            return false;
+        }
+        std::memcpy(data, view.data, view.bytes);
+        return true;
+    }
+
+    bool InvokeSignature(const std::string& signature_key, InferenceMetrics* metrics) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        tflite::SignatureRunner* runner = GetSignatureRunner(signature_key);
+        bool success = runner && runner->Invoke() == kTfLiteOk;
+        primary_inputs_pending_ = false;
+        if (runner && !success) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR);
+        }
+
+        RecordMetrics(start_time, success, {}, metrics);
+        return success;
+    }
+
+    std::vector<std::vector<int64_t>> GetShapes(bool is_input) const {
+        std::vector<std::vector<int64_t>> shapes;
+        auto model = CurrentModel();
+        if (!model) {
+            return shapes;
+        }
+        for (const auto& info : is_input ? model->input_info : model->output_info) {
+            shapes.push_back(info.shape);
+        }
+        return shapes;
+    }
+
+    bool Invoke(InferenceMetrics* metrics) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        hardware::HardwareAccelerator::PerformanceMetrics hw_metrics{};
+        bool success = false;
+
+        ExecutionContext* context = PrimaryContext();
+        if (!context) {
+            return false;
+        }
+
+        const size_t backend = SelectBackend(context->model);
+        if (backend == ACCELERATOR_BACKEND && context->model->accelerator) {
+            TensorView input;
+            TensorView output;
+            if (GetInputBuffer(*context, 0, &input) && GetOutputBuffer(*context, 0, &output)) {
+                std::lock_guard<std::mutex> lock(accelerator_mutex_);
+                auto result = context->model->accelerator->RunInference(
+                    input.As<const float>(), input.Count<float>(),
+                    output.As<float>(), output.Count<float>(),
+                    nullptr, &hw_metrics);
+                success = (result == hardware::HardwareAccelerator::ErrorCode::SUCCESS);
+                if (!success) {
+                    SetError(result);
+                }
+            }
+        } else {
+            success = Execute(*context);
+            TakeOpProfile(*context, metrics);
+        }
+        primary_inputs_pending_ = false;
+
+        RecordBackend(context->model, backend, start_time, success);
+        RecordMetrics(start_time, success, hw_metrics, metrics);
+        return success;
+    }
+
+    bool RunBatchInference(const std::vector<std::vector<float>>& inputs,
+                          std::vector<std::vector<float>>& outputs,
+                          InferenceMetrics* metrics = nullptr,
+                          const CancellationToken* token = nullptr) {
+        if (inputs.size() > MaxBatchSize()) {
+            ReportError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT,
+                        "Batch size exceeds maximum allowed");
+            return false;
+        }
+
+        if (inputs.empty()) {
+            outputs.clear();
+            return true;
+        }
+
+        const size_t sample_size = inputs[0].size();
+        bool uniform = std::all_of(inputs.begin(), inputs.end(),
+                                   [sample_size](const std::vector<float>& input) {
+                                       return input.size() == sample_size;
+                                   });
+
+        // Pack the samples into one tensor and run a single Invoke when the
+        // backend can grow its batch dimension; otherwise run sample by sample
+        if (inputs.size() > 1 && uniform && !PrefersAccelerator(CurrentModel().get())) {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            const CancelScope cancel = BeginRequest(token);
+            PooledContext context = AcquireContext(&cancel);
+            if (!context) {
+                RecordCancellation(cancel, false);
+                return false;
+            }
+            if (ResizeBatch(*context, inputs.size())) {
+                bool success;
+                {
+                    CancelGuard guard(*context, cancel);
+                    success = PackBatch(*context, inputs) && Execute(*context) &&
+                              UnpackBatch(*context, outputs, inputs.size());
+                }
+                TakeOpProfile(*context, metrics);
+                RecordCancellation(cancel, success);
+                RecordMetrics(start_time, success, {}, metrics);
+                return success;
+            }
+            // Falls through with the context returned to the pool, so the
+            // per-sample runs below can check it out again
+        }
+
+        return RunSequentialBatch(inputs, outputs, metrics, token);
+    }
+
+    bool SetBatchSize(size_t batch_size) {
+        if (batch_size == 0 || batch_size > std::max<size_t>(MaxBatchSize(), 1)) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+            return false;
+        }
+        ExecutionContext* context = PrimaryContext();
+        return context && ResizeBatch(*context, batch_size);
+    }
+
+    ModelConfig GetModelConfig() const {
+        return GetConfig();
+    }
+
+    void SetExecutionContextLimits(size_t num_contexts, size_t max_contexts) {
+        num_contexts = std::max<size_t>(num_contexts, 1);
+        max_contexts = std::max(num_contexts, max_contexts);
+        {
+            std::lock_guard<std::mutex> lock(config_mutex_);
+            config_.num_execution_contexts = num_contexts;
+            config_.max_execution_contexts = max_contexts;
+        }
+
+        auto model = CurrentModel();
+        if (!model) {
+            return;
+        }
+
+        std::vector<std::unique_ptr<ExecutionContext>> released;
+        {
+            std::lock_guard<std::mutex> lock(model->pool_mutex);
+            model->num_contexts = num_contexts;
+            model->max_contexts = max_contexts;
+
+            // Drop idle contexts beyond the retained count; busy ones are
+            // trimmed as they come back
+            while (model->total_contexts > model->num_contexts && !model->idle_contexts.empty()) {
+                released.push_back(std::move(model->idle_contexts.back()));
+                model->idle_contexts.pop_back();
+                model->total_contexts--;
+            }
+        }
+        model->pool_cv.notify_all();
+    }
+
+    size_t GetExecutionContextCount() const {
+        auto model = CurrentModel();
+        if (!model) {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock(model->pool_mutex);
+        return model->total_contexts;
+    }
+
+    MemoryFootprint GetMemoryFootprint() const {
+        MemoryFootprint footprint;
+        auto model = CurrentModel();
+        if (model) {
+            footprint.weights_bytes = model->weights_bytes;
+            footprint.arena_bytes = model->arena_bytes.load();
+            // Only the loaded model's accelerator buffers; an idle accelerator
+            // holds nothing that UnloadModel could give back
+            if (model->accelerator) {
+                footprint.accelerator_bytes = model->accelerator->GetMemoryUsageBytes();
+            }
+        }
+        return footprint;
+    }
+
+    MemoryPlanStats GetMemoryPlanStats() const {
+        MemoryPlanStats stats;
+        auto model = CurrentModel();
+        if (model) {
+            stats = model->memory_plan_stats;
+            stats.weights_bytes = model->weights_bytes;
+        }
+        return stats;
+    }
+
+    size_t ShedArenas() {
+        auto model = CurrentModel();
+        if (!model) {
+            return 0;
+        }
+
+        std::vector<std::unique_ptr<ExecutionContext>> released;
+        {
+            std::lock_guard<std::mutex> lock(model->pool_mutex);
+            released.swap(model->idle_contexts);
+            model->total_contexts -= released.size();
+        }
+
+        size_t freed = 0;
+        for (const auto& context : released) {
+            freed += context->arena_bytes;
+        }
+        return freed;
+    }
+
+    void UnloadModel() {
+        StopBackgroundOptimization();
+        primary_context_.reset();
+        primary_model_.reset();
+        std::lock_guard<std::mutex> lock(swap_mutex_);
+        std::atomic_store(&model_, std::shared_ptr<ModelInstance>());
+        if (auto cache = std::atomic_load(&result_cache_)) {
+            cache->Clear();
+        }
+    }
+
+    bool IsModelLoaded() const {
+        return CurrentModel() != nullptr;
+    }
+
+    std::string GetModelInfo() const {
+        auto model = CurrentModel();
+        std::stringstream info;
+        info << "Model Path: " << (model ? model->path : "") << "\n";
+        info << "Format: " << (model ? static_cast<int>(model->format) : -1) << "\n";
+        info << "Optimized: " << (model && model->pre_optimized ? "Yes" : "No") << "\n";
+        info << "Hardware Acceleration: " << (hw_acceleration_enabled_ ? "Enabled" : "Disabled") << "\n";
+        if (model && model->placement == Placement::CPU) {
+            info << "Placement: CPU\n";
+        } else if (model && model->backend_selector) {
+            info << "Placement: Adaptive (" << (PrefersAccelerator(model.get()) ? "accelerator" : "cpu")
+                 << " currently faster)\n";
+        }
+        info << "Threads: " << num_threads_ << "\n";
+        info << "Execution Contexts: " << GetExecutionContextCount() << "\n";
+        info << "Memory Limit: " << memory_limit_mb_ << " MB\n";
+        return info.str();
+    }
+
+    void SetNumThreads(int num_threads) {
+        num_threads_ = std::max(1, num_threads);
+    }
+
+    void EnableHardwareAcceleration(bool enable) {
+        hw_acceleration_enabled_ = enable;
+    }
+
+    void SetPowerProfile(hardware::HardwareAccelerator::PowerProfile profile) {
+        power_profile_ = profile;
+    }
+
+    void SetMemoryLimit(size_t memory_mb) {
+        memory_limit_mb_ = memory_mb;
+    }
+
+    void SetErrorCallback(ErrorCallback callback) {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        error_callback_ = std::move(callback);
+    }
+
+    hardware::HardwareAccelerator::ErrorCode GetLastError() const {
+        return last_error_;
+    }
+
+    bool RunRequest(const std::vector<float>& input, const CancellationToken* token,
+                    InferenceResult* result) {
+        RequestErrorScope scope;
+        result->success = token
+            ? RunInference(input, result->output, *token, &result->metrics)
+            : RunInference(input, result->output, &result->metrics);
+        result->error = scope.Result(result->success);
+        return result->success;
+    }
+
+    bool OptimizeModel(const std::string& output_path) {
+        auto model = CurrentModel();
+        if (!model) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+            return false;
+        }
+        return OptimizeModelInstance(*model, output_path);
+    }
+
+    bool QuantizeModel(const std::string& output_path, bool dynamic) {
+        auto model_instance = CurrentModel();
+        if (!accelerator_ || !model_instance) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+            return false;
+        }
+        ModelInstance& source = *model_instance;
+
+        try {
+            // Check if quantization is supported
+            if (!accelerator_->SupportsOperation("QUANTIZATION")) {
+                SetError(hardware::HardwareAccelerator::ErrorCode::UNSUPPORTED_OPERATION);
+                return false;
+            }
+
+            // Apply quantization based on format
+            if (source.format == ModelFormat::TFLITE) {
+                tflite::ops::builtin::BuiltinOpResolver resolver;
+                std::unique_ptr<tflite::FlatBufferModel> model =
+                    tflite::FlatBufferModel::BuildFromBuffer(
+                        reinterpret_cast<const char*>(source.blob->data()), source.blob->size());
+
+                tflite::QuantizationParams quant_params;
+                quant_params.inference_type = dynamic ?
+                    tflite::TensorType_INT8 : tflite::TensorType_FLOAT32;
+
+                tflite::Interpreter* interpreter;
+                tflite::InterpreterBuilder(*model, resolver)(&interpreter);
+                interpreter->UseNNAPI(false);
+                interpreter->SetNumThreads(num_threads_);
+
+                if (dynamic) {
+                    interpreter->ApplyDelegates();
+                }
+
+                // Save quantized model
+                std::ofstream output_file(output_path, std::ios::binary);
+                output_file.write(reinterpret_cast<const char*>(model->GetBuffer()),
+                                model->GetSize());
+            } else if (source.format == ModelFormat::PYTORCH) {
+                torch::jit::Module quantized;
+                if (dynamic) {
+                    quantized = torch::jit::quantize_dynamic(source.module);
+                } else {
+                    quantized = torch::jit::quantize_per_tensor(source.module);
+                }
+                quantized.save(output_path);
+            } else if (source.format == ModelFormat::ONNX) {
+                Ort::SessionOptions session_options;
+                session_options.SetGraphOptimizationLevel(
+                    GraphOptimizationLevel::ORT_ENABLE_ALL);
+                session_options.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+
+                if (dynamic) {
+                    session_options.SetExecutionMode(ExecutionMode::ORT_PARALLEL);
+                }
+
+                auto session = std::make_unique<Ort::Session>(env_, source.path.c_str(),
+                                                              session_options);
+
+                // Save quantized model
+                session->Save(output_path.c_str(),
+                              Ort::SaveOption::NO_SAVE_OPTIMIZER_STATE);
+            }
+
+            return true;
+        } catch (const std::exception& e) {
+            ReportError(hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR, e.what());
+            SetError(hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR);
+            return false;
+        }
+    }
+
+    std::future<InferenceResult> SubmitInference(std::vector<float> input,
+                                                 CompletionCallback callback,
+                                                 std::shared_ptr<const CancellationToken> token) {
+        AsyncRequest request;
+        request.input = std::move(input);
+        request.callback = std::move(callback);
+        request.token = std::move(token);
+        std::future<InferenceResult> future = request.promise.get_future();
+
+        std::unique_lock<std::mutex> lock(async_mutex_);
+        request.id = ++async_request_id_;
+        if (!CurrentModel()) {
+            lock.unlock();
+            request.result.request_id = request.id;
+            request.result.error = hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
+            Complete(request);
+            return future;
+        }
+
+        // One worker per context the pool may hand out; more would only
+        // queue up inside AcquireContext
+        size_t wanted = std::max<size_t>(GetConfig().max_execution_contexts, 1);
+        async_running_ = true;
+        while (async_workers_.size() < wanted) {
+            async_workers_.emplace_back(&Impl::AsyncWorkerLoop, this);
+        }
+
+        async_queue_.push_back(std::move(request));
+        lock.unlock();
+        async_cv_.notify_one();
+        return future;
+    }
+
+    void ReleaseResources() {
+        // Fail queued requests before the model goes away
+        StopAsyncWorkers();
+        StopBackgroundOptimization();
+
+        // Unpublish the model and wait for the requests still running on it
+        // to return their contexts. Streaming sessions keep their version,
+        // and with it the accelerator, until they close.
+        primary_context_.reset();
+        primary_model_.reset();
+        std::shared_ptr<ModelInstance> released;
+        {
+            std::lock_guard<std::mutex> lock(swap_mutex_);
+            released = std::atomic_exchange(&model_, std::shared_ptr<ModelInstance>());
+        }
+        std::atomic_store(&result_cache_, std::shared_ptr<ResultCache>());
+        if (released) {
+            std::unique_lock<std::mutex> lock(released->pool_mutex);
+            released->drained_cv.wait(lock, [&released] {
+                return released->idle_contexts.size() == released->total_contexts;
+            });
+        }
+        released.reset();
+
+        // Release hardware accelerator resources
+        {
+            std::lock_guard<std::mutex> lock(accelerator_mutex_);
+            accelerator_.reset();
+        }
+
+        // Reset configuration
+        SetConfig(ModelConfig());
+        num_threads_ = 1;
+        hw_acceleration_enabled_ = true;
+        memory_limit_mb_ = 0;
+        power_profile_ = hardware::HardwareAccelerator::PowerProfile::BALANCED;
+
+        // Clear error state
+        SetErrorCallback(nullptr);
+        last_error_ = hardware::HardwareAccelerator::ErrorCode::SUCCESS;
+    }
+
+    WarmUpReport WarmUp(const WarmUpOptions& options) {
+        WarmUpReport report;
+        auto model = CurrentModel();
+        if (!model) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+            return report;
+        }
+
+        // Check out every retained context at once so each one is warmed
+        std::vector<PooledContext> pooled;
+        std::vector<ExecutionContext*> contexts;
+        for (size_t i = 0; i < model->num_contexts; i++) {
+            PooledContext context = AcquireContext();
+            if (!context) {
+                return report;
+            }
+            contexts.push_back(&*context);
+            pooled.push_back(std::move(context));
+        }
+        if (primary_context_ && primary_model_ == model && !primary_inputs_pending_) {
+            contexts.push_back(primary_context_.get());
+        }
+
+        report.success = WarmUpContexts(*model, contexts, options, report);
+        if (report.success && options.warm_signatures && contexts[0]->interpreter &&
+            !contexts[0]->interpreter->signature_keys().empty()) {
+            report.success = WarmUpSignatures(options, report);
+        }
+
+        if (!report.stages.empty()) {
+            report.first_run_ms = report.stages.front().first_run_ms;
+            report.converged = std::all_of(report.stages.begin(), report.stages.end(),
+                                           [](const WarmUpStage& stage) { return stage.converged; });
+        }
+        for (const auto& stage : report.stages) {
+            if (stage.signature.empty()) {
+                report.steady_state_ms = stage.steady_state_ms;
+            }
+        }
+        return report;
+    }
+
+    bool WarmUp(size_t num_runs) {
+        return WarmUp(FixedRunCount(num_runs)).success;
+    }
+
+    // The session keeps the model version it was opened on, since its state
+    // belongs to that version; swaps take effect for new sessions
+    std::unique_ptr<StreamState> OpenStream(const StreamingConfig& config) {
+        auto model = CurrentModel();
+        if (!model) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+            return nullptr;
+        }
+        if (model->format != ModelFormat::TFLITE && model->format != ModelFormat::ONNX) {
+            ReportError(hardware::HardwareAccelerator::ErrorCode::UNSUPPORTED_OPERATION,
+                        "Streaming requires a TFLite or ONNX model");
+            SetError(hardware::HardwareAccelerator::ErrorCode::UNSUPPORTED_OPERATION);
+            return nullptr;
+        }
+
+        auto stream = std::make_unique<StreamState>();
+        stream->model = model;
+        stream->context = CreateContext(*model);
+        if (!stream->context) {
+            return nullptr;
+        }
+
+        const ExecutionContext& context = *stream->context;
+        if (context.input_info.empty() || context.output_info.empty() ||
+            context.input_info[0].type != TensorType::FLOAT32) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+            return nullptr;
+        }
+        stream->input_count = context.input_info[0].bytes / sizeof(float);
+
+        for (const auto& binding : config.state_bindings) {
+            int output = FindTensor(context.output_info, binding.first);
+            int input = FindTensor(context.input_info, binding.second);
+            // Input 0 carries the chunk and cannot also be state
+            if (output < 0 || input <= 0 ||
+                context.output_info[output].bytes != context.input_info[input].bytes) {
+                ReportError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT,
+                            "Invalid state binding " + binding.first + " -> " + binding.second);
+                SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+                return nullptr;
+            }
+            stream->state_bindings.emplace_back(output, input);
+        }
+
+        ResetStream(*stream);
+        return stream;
+    }
+
+    // Only the new chunk is computed when the model was exported for
+    // streaming (input 0 is one chunk, with state carried in variable
+    // tensors or bindings). Windowed models still recompute the window.
+    bool StreamStep(StreamState& stream, Span<const float> chunk, Span<float> output,
+                    size_t* output_size, InferenceMetrics* metrics) {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        ExecutionContext& context = *stream.context;
+
+        const size_t window_size = stream.input_count;
+        if (chunk.empty() || chunk.size() > window_size || window_size % chunk.size() != 0) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+            return false;
+        }
+
+        TensorView view;
+        if (!GetInputBuffer(context, 0, &view)) {
+            return false;
+        }
+        if (chunk.size() == window_size) {
+            std::memcpy(view.data, chunk.data(), chunk.size_bytes());
+        } else {
+            // The interpreter may reuse input memory for activations, so
+            // the window lives in the session and is copied in every step
+            std::copy(stream.window.begin() + chunk.size(), stream.window.end(),
+                      stream.window.begin());
+            std::copy(chunk.begin(), chunk.end(), stream.window.end() - chunk.size());
+            std::memcpy(view.data, stream.window.data(), window_size * sizeof(float));
+        }
+
+        bool success = Execute(context) && CopyOutput(context, output, output_size);
+        if (success) {
+            for (const auto& binding : stream.state_bindings) {
+                TensorView state_out;
+                TensorView state_in;
+                if (!GetOutputBuffer(context, binding.first, &state_out) ||
+                    !GetInputBuffer(context, binding.second, &state_in)) {
+                    success = false;
+                    break;
+                }
+                std::memcpy(state_in.data, state_out.data, state_in.bytes);
+            }
+        }
+        if (success) {
+            stream.steps++;
+        }
+
+        RecordMetrics(start_time, success, {}, metrics);
+        return success;
+    }
+
+    void ResetStream(StreamState& stream) {
+        ExecutionContext& context = *stream.context;
+        if (context.interpreter) {
+            context.interpreter->ResetVariableTensors();
+        }
+        ZeroInputs(context, 1);
+        stream.window.assign(stream.input_count, 0.0f);
+        stream.steps = 0;
+    }
+
+private:
+    struct AsyncRequest {
+        uint64_t id = 0;
+        std::vector<float> input;
+        CompletionCallback callback;
+        std::shared_ptr<const CancellationToken> token;
+        std::promise<InferenceResult> promise;
+        InferenceResult result;
+    };
+
+    void AsyncWorkerLoop() {
+        while (true) {
+            AsyncRequest request;
+            {
+                std::unique_lock<std::mutex> lock(async_mutex_);
+                async_cv_.wait(lock, [this] { return !async_running_ || !async_queue_.empty(); });
+                if (!async_running_) {
+                    return;
+                }
+                request = std::move(async_queue_.front());
+                async_queue_.pop_front();
+            }
+
+            request.result.request_id = request.id;
+            RunRequest(request.input, request.token.get(), &request.result);
+            Complete(request);
+        }
+    }
+
+    void Complete(AsyncRequest& request) {
+        if (request.callback) {
+            try {
+                request.callback(request.result);
+            } catch (...) {
+                // A throwing callback must not take the worker down
+            }
+        }
+        request.promise.set_value(std::move(request.result));
+    }
+
+    void StopAsyncWorkers() {
+        std::vector<std::thread> workers;
+        std::deque<AsyncRequest> pending;
+        {
+            std::lock_guard<std::mutex> lock(async_mutex_);
+            async_running_ = false;
+            workers.swap(async_workers_);
+            pending.swap(async_queue_);
+        }
+        async_cv_.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        for (auto& request : pending) {
+            request.result.request_id = request.id;
+            request.result.error = hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
+            Complete(request);
+        }
+    }
+
+    // Also reported to the request running on this thread, if any
+    void SetError(hardware::HardwareAccelerator::ErrorCode code) {
+        last_error_ = code;
+        RequestErrorScope::Record(code);
+    }
+
+    std::shared_ptr<ModelInstance> CurrentModel() const {
+        return std::atomic_load(&model_);
+    }
+
+    ModelConfig GetConfig() const {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        return config_;
+    }
+
+    // Read on every batch request; avoids copying the whole config
+    size_t MaxBatchSize() const {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        return config_.max_batch_size;
+    }
+
+    void SetConfig(const ModelConfig& config) {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        config_ = config;
+    }
+
+    // The callback is called unlocked, so it may call back into the engine
+    void ReportError(hardware::HardwareAccelerator::ErrorCode code, const std::string& message) const {
+        ErrorCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(config_mutex_);
+            callback = error_callback_;
+        }
+        if (callback) {
+            callback(code, message);
+        }
+    }
+
+    std::shared_ptr<CompiledModelCache> CompiledCache() const {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        return compiled_cache_;
+    }
+
+    // Load a model instance without publishing it. Serves an optimized
+    // artifact from an earlier run when there is one; otherwise the source
+    // model, optimized later in the background.
+    std::shared_ptr<ModelInstance> PrepareModel(const std::string& model_path, ModelFormat format,
+                                                const ModelConfig& config) {
+        std::shared_ptr<CompiledModelCache> compiled_cache;
+        if (config.enable_caching) {
+            std::string cache_dir = config.cache_dir.empty()
+                ? (std::filesystem::path(model_path).parent_path() / ".mobileai_cache").string()
+                : config.cache_dir;
+            compiled_cache = std::make_shared<CompiledModelCache>(cache_dir);
+            if (!compiled_cache->IsEnabled()) {
+                compiled_cache.reset();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(config_mutex_);
+            compiled_cache_ = compiled_cache;
+        }
+
+        const std::string optimized_path = model_path + ".optimized";
+        const bool optimize = config.enable_optimization && SupportsBackgroundOptimization(format);
+
+        std::shared_ptr<ModelInstance> model;
+        if (optimize && IsNewerThan(optimized_path, model_path)) {
+            model = BuildModelInstance(optimized_path, format, true, false, config);
+        }
+        if (!model) {
+            model = BuildModelInstance(model_path, format, false, optimize, config);
+        }
+        return model;
+    }
+
+    void ConfigureResultCache(const ModelConfig& config) {
+        std::shared_ptr<ResultCache> cache;
+        if (config.result_cache_mb > 0) {
+            cache = std::make_shared<ResultCache>(config.result_cache_mb * 1024 * 1024);
+        }
+        std::atomic_store(&result_cache_, cache);
+    }
+
+    // Make the model current for new requests. In-flight requests hold
+    // their own reference and finish on the version they started with; the
+    // old version is freed when the last of them returns its context.
+    void PublishModel(const std::shared_ptr<ModelInstance>& model, const std::string& model_path) {
+        {
+            std::lock_guard<std::mutex> lock(swap_mutex_);
+            std::atomic_store(&model_, model);
+        }
+        if (model->fast_start) {
+            StartBackgroundOptimization(model, model_path + ".optimized");
+        }
+    }
+
+    // Warm every retained context of an unpublished instance so its first
+    // real request does not pay for lazy allocation
+    bool WarmUpInstance(ModelInstance& model, size_t num_runs) {
+        if (num_runs == 0) {
+            return true;
+        }
+        std::vector<ExecutionContext*> contexts;
+        for (auto& context : model.idle_contexts) {
+            contexts.push_back(context.get());
+        }
+        WarmUpReport report;
+        return WarmUpContexts(model, contexts, FixedRunCount(num_runs), report);
+    }
+
+    bool WarmUpContexts(ModelInstance& model, const std::vector<ExecutionContext*>& contexts,
+                        const WarmUpOptions& options, WarmUpReport& report) {
+        PrefaultWeights(model);
+
+        // Largest batch first, so arenas reach their high-water mark before
+        // the contexts settle at the smallest (most common) size
+        std::vector<size_t> batch_sizes = options.batch_sizes;
+        if (batch_sizes.empty()) {
+            batch_sizes.push_back(1);
+        }
+        std::sort(batch_sizes.rbegin(), batch_sizes.rend());
+        batch_sizes.erase(std::unique(batch_sizes.begin(), batch_sizes.end()), batch_sizes.end());
+
+        for (size_t batch_size : batch_sizes) {
+            WarmUpStage stage;
+            stage.batch_size = batch_size;
+            stage.converged = true;
+
+            for (size_t i = 0; i < contexts.size(); i++) {
+                ExecutionContext& context = *contexts[i];
+                if (!ResizeBatch(context, batch_size)) {
+                    if (batch_size == 1) {
+                        return false;
+                    }
+                    // Served one sample at a time instead; nothing to warm
+                    break;
+                }
+                if (!ZeroInputs(context, batch_size)) {
+                    return false;
+                }
+
+                LatencyTrace trace;
+                if (!RunUntilConverged([this, &context] { return Execute(context); },
+                                       options, trace)) {
+                    return false;
+                }
+                UpdateArenaBytes(context);
+
+                if (i == 0) {
+                    stage.first_run_ms = trace.first_ms;
+                }
+                stage.steady_state_ms = std::max(stage.steady_state_ms, trace.steady_ms);
+                stage.runs += trace.runs;
+                stage.converged = stage.converged && trace.converged;
+            }
+
+            if (stage.runs > 0) {
+                report.stages.push_back(stage);
+            }
+        }
+        return true;
+    }
+
+    // Signatures only run on the primary context, so like InvokeSignature
+    // this must not race with the zero-copy/named tensor API
+    bool WarmUpSignatures(const WarmUpOptions& options, WarmUpReport& report) {
+        for (const std::string& key : GetSignatureKeys()) {
+            tflite::SignatureRunner* runner = GetSignatureRunner(key);
+            if (!runner) {
+                return false;
+            }
+            for (const char* name : runner->input_names()) {
+                TfLiteTensor* tensor = runner->input_tensor(name);
+                if (tensor && tensor->data.raw) {
+                    std::memset(tensor->data.raw, 0, tensor->bytes);
+                }
+            }
+
+            LatencyTrace trace;
+            if (!RunUntilConverged([runner] { return runner->Invoke() == kTfLiteOk; },
+                                   options, trace)) {
+                SetError(hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR);
+                return false;
+            }
+
+            WarmUpStage stage;
+            stage.signature = key;
+            stage.first_run_ms = trace.first_ms;
+            stage.steady_state_ms = trace.steady_ms;
+            stage.runs = trace.runs;
+            stage.converged = trace.converged;
+            report.stages.push_back(stage);
+        }
+        return true;
+    }
+
+    // Zero every input tensor in place, whatever its type. PyTorch and custom
+    // models get a zeroed staging buffer of the model's sample size instead.
+    bool ZeroInputs(ExecutionContext& context, size_t batch_size) {
+        if (context.interpreter || context.io_binding) {
+            for (size_t i = 0; i < context.input_info.size(); i++) {
+                TensorView view;
+                if (!GetInputBuffer(context, i, &view)) {
+                    return false;
+                }
+                if (view.data) {
+                    std::memset(view.data, 0, view.bytes);
+                }
+            }
+            return true;
+        }
+
+        const size_t sample_size = std::max<size_t>(GetInputSize(*context.model), 1);
+        context.batch_staging.assign(batch_size * sample_size, 0.0f);
+        if (context.model->format == ModelFormat::PYTORCH) {
+            context.torch_input = torch::from_blob(context.batch_staging.data(),
+                                                   {static_cast<long>(batch_size),
+                                                    static_cast<long>(sample_size)});
+        } else {
+            context.custom_input = Span<const float>(context.batch_staging.data(),
+                                                     context.batch_staging.size());
+        }
+        return true;
+    }
+
+    // Touch one byte per page so the weights' page faults are taken now
+    // rather than by the first request
+    void PrefaultWeights(const ModelInstance& model) {
+        if (!model.blob) {
+            return;
+        }
+        const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        volatile uint8_t sink = 0;
+        for (size_t offset = 0; offset < model.blob->size(); offset += page_size) {
+            sink ^= model.blob->data()[offset];
+        }
+    }
+
+    // Load weights and prepare the retained execution contexts. Runs on the
+    // caller's thread for LoadModel and on the optimizer thread for swaps.
+    std::shared_ptr<ModelInstance> BuildModelInstance(const std::string& path, ModelFormat format,
+                                                      bool pre_optimized, bool fast_start,
+                                                      const ModelConfig& config) {
+        auto model = std::make_shared<ModelInstance>();
+        model->path = path;
+        model->version = ++model_version_;
+        model->format = format;
+        model->pre_optimized = pre_optimized;
+        model->fast_start = fast_start;
+        model->num_contexts = std::max<size_t>(config.num_execution_contexts, 1);
+        model->max_contexts = std::max(model->num_contexts, config.max_execution_contexts);
+        if (config.enable_op_profiling) {
+            model->op_profile = std::make_unique<OpProfileWindow>(config.op_profile_window);
+        }
+        if (config.enable_preprocessing) {
+            model->preprocessor = std::make_unique<ImagePreprocessor>(config.preprocessing);
+        }
+        model->memory_plan = config.memory_plan;
+        model->max_batch_size = std::max<size_t>(config.max_batch_size, 1);
+        model->accelerator = accelerator_;
+        model->compiled_cache = CompiledCache();
+
+        bool success = false;
+        switch (format) {
+            case ModelFormat::TFLITE:
+                success = LoadTFLiteModel(*model);
+                break;
+            case ModelFormat::PYTORCH:
+                success = LoadPyTorchModel(*model);
+                break;
+            case ModelFormat::ONNX:
+                success = LoadONNXModel(*model);
+                break;
+            case ModelFormat::CUSTOM:
+                success = LoadCustomModel(*model);
+                break;
+            default:
+                ReportError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT,
+                            "Unsupported model format");
+                return nullptr;
+        }
+
+        if (success) {
+            std::error_code ec;
+            model->weights_bytes = model->blob ? model->blob->size()
+                                               : std::filesystem::file_size(path, ec);
+        }
+        if (success && format == ModelFormat::TFLITE) {
+            PlanPlacement(*model);
+        }
+
+        // Create the retained contexts up front; the first one also provides
+        // the model's tensor description
+        success = success && PopulatePool(*model);
+        if (!success && model->cache_hit) {
+            // The cached artifact was rejected; drop it and prepare from scratch
+            model->compiled_cache->Invalidate(model->cache_key);
+            model->cache_artifact_path.clear();
+            model->cache_hit = false;
+            success = PopulatePool(*model);
+        }
+        if (!success) {
+            return nullptr;
+        }
+        if (model->placement == Placement::ACCELERATOR && config.adaptive_backend && UseAccelerator()) {
+            // Every model also has CPU contexts, so the faster of the two can
+            // serve each request
+            model->backend_selector = std::make_unique<hardware::BackendSelector>(
+                std::vector<std::string>{"accelerator", "cpu"});
+        }
+        if (model->format == ModelFormat::TFLITE && !model->cache_artifact_path.empty() &&
+            !model->cache_hit) {
+            // The delegate wrote its packed weights while the first context
+            // was prepared
+            model->compiled_cache->Commit(model->cache_key);
+        }
+        return model;
+    }
+
+    // Write an optimized artifact for the given model. The file appears at
+    // output_path only once complete, so a concurrent load never sees a
+    // partial artifact.
+    bool OptimizeModelInstance(ModelInstance& model, const std::string& output_path) {
+        try {
+            std::filesystem::path out_path(output_path);
+            if (out_path.has_parent_path() && !std::filesystem::exists(out_path.parent_path())) {
+                std::filesystem::create_directories(out_path.parent_path());
+            }
+            const std::string temp_path = output_path + ".tmp";
+
+            if (model.format == ModelFormat::PYTORCH) {
+                torch::jit::Module optimized = torch::jit::optimize_for_mobile(model.module);
+                optimized.save(temp_path);
+            } else if (model.format == ModelFormat::ONNX) {
+                // Building a session with an optimized-model path writes the
+                // optimized graph out; the serving session is left untouched
+                Ort::SessionOptions session_options;
+                session_options.SetGraphOptimizationLevel(
+                    GraphOptimizationLevel::ORT_ENABLE_ALL);
+                session_options.SetIntraOpNumThreads(num_threads_);
+                session_options.SetOptimizedModelFilePath(temp_path.c_str());
+                Ort::Session optimized(env_, model.blob->data(), model.blob->size(),
+                                       session_options);
+            } else {
+                // TFLite flatbuffers are already deployable, and the packed
+                // XNNPACK weights are kept by the compiled-model cache
+                SetError(hardware::HardwareAccelerator::ErrorCode::UNSUPPORTED_OPERATION);
+                return false;
+            }
+
+            std::filesystem::rename(temp_path, out_path);
+            return true;
+        } catch (const std::exception& e) {
+            ReportError(hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR, e.what());
+            SetError(hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR);
+            return false;
+        }
+    }
+
+    // TFLite flatbuffers are already in their deployable form and custom
+    // models have no optimizer. With the compiled-model cache on, ONNX
+    // sessions already reuse an optimized graph.
+    bool SupportsBackgroundOptimization(ModelFormat format) const {
+        return format == ModelFormat::PYTORCH ||
+               (format == ModelFormat::ONNX && !CompiledCache());
+    }
+
+    static bool IsNewerThan(const std::string& path, const std::string& reference) {
+        std::error_code ec;
+        auto time = std::filesystem::last_write_time(path, ec);
+        if (ec) {
+            return false;
+        }
+        auto reference_time = std::filesystem::last_write_time(reference, ec);
+        return !ec && time >= reference_time;
+    }
+
+    void StartBackgroundOptimization(std::shared_ptr<ModelInstance> source,
+                                     const std::string& output_path) {
+        uint64_t generation = load_generation_.load();
+        ModelConfig config = GetConfig();
+        optimize_thread_ = std::thread([this, source, output_path, generation, config] {
+            if (!OptimizeModelInstance(*source, output_path) ||
+                generation != load_generation_.load()) {
+                return;
+            }
+
+            auto optimized = BuildModelInstance(output_path, source->format, true, false, config);
+            if (!optimized) {
+                return;
+            }
+            // Same model, so results memoized for the source stay valid
+            optimized->version = source->version;
+
+            // Swap only if nothing replaced the source model in the meantime.
+            // Requests in flight keep the old instance alive until they finish.
+            std::lock_guard<std::mutex> lock(swap_mutex_);
+            if (generation == load_generation_.load() && CurrentModel() == source) {
+                std::atomic_store(&model_, optimized);
+            }
+        });
+    }
+
+    // Cancels any pending swap and waits for the optimizer thread; backend
+    // optimization itself cannot be interrupted
+    void StopBackgroundOptimization() {
+        load_generation_++;
+        if (optimize_thread_.joinable()) {
+            optimize_thread_.join();
+        }
+    }
+
+    // Context checked out of the current model's pool; returned on destruction.
+    // Holding the model reference keeps its weights alive for the duration.
+    class PooledContext {
+    public:
+        PooledContext() = default;
+        PooledContext(std::shared_ptr<ModelInstance> model, std::unique_ptr<ExecutionContext> context)
+            : model_(std::move(model)), context_(std::move(context)) {}
+        PooledContext(PooledContext&&) = default;
+        PooledContext& operator=(PooledContext&&) = default;
+
+        ~PooledContext() {
+            if (!context_) {
+                return;
+            }
+            bool drained;
+            {
+                std::lock_guard<std::mutex> lock(model_->pool_mutex);
+                if (model_->total_contexts > model_->max_contexts) {
+                    // Pool was shrunk while this context was busy
+                    model_->total_contexts--;
+                    context_.reset();
+                } else {
+                    model_->idle_contexts.push_back(std::move(context_));
+                }
+                drained = model_->idle_contexts.size() == model_->total_contexts;
+            }
+            model_->pool_cv.notify_one();
+            if (drained) {
+                model_->drained_cv.notify_all();
+            }
+        }
+
+        explicit operator bool() const { return context_ != nullptr; }
+        ExecutionContext& operator*() const { return *context_; }
+        ExecutionContext* operator->() const { return context_.get(); }
+
+    private:
+        std::shared_ptr<ModelInstance> model_;
+        std::unique_ptr<ExecutionContext> context_;
+    };
+
+    // Check out an idle context, growing the pool up to max_contexts and
+    // blocking once every context is busy
+    // A cancellable request stops waiting for a context once it is cancelled
+    PooledContext AcquireContext(const CancelScope* cancel = nullptr) {
+        auto model = CurrentModel();
+        if (!model) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+            return PooledContext();
+        }
+
+        std::unique_lock<std::mutex> lock(model->pool_mutex);
+        auto available = [this, &model] {
+            return !model->idle_contexts.empty() ||
+                   (model->total_contexts < model->max_contexts && CanGrowPool(*model));
+        };
+        if (!cancel) {
+            model->pool_cv.wait(lock, available);
+        }
+        while (cancel && !available()) {
+            if (cancel->Cancelled()) {
+                SetError(hardware::HardwareAccelerator::ErrorCode::CANCELLED);
+                return PooledContext();
+            }
+            model->pool_cv.wait_for(lock, CANCEL_POLL_INTERVAL);
+        }
+
+        if (!model->idle_contexts.empty()) {
+            auto context = std::move(model->idle_contexts.back());
+            model->idle_contexts.pop_back();
+            return PooledContext(model, std::move(context));
+        }
+
+        // Reserve the slot, then build the context outside the lock
+        model->total_contexts++;
+        lock.unlock();
+
+        auto context = CreateContext(*model);
+        if (!context) {
+            lock.lock();
+            model->total_contexts--;
+            const bool drained = model->idle_contexts.size() == model->total_contexts;
+            lock.unlock();
+            model->pool_cv.notify_one();
+            if (drained) {
+                model->drained_cv.notify_all();
+            }
+            return PooledContext();
+        }
+        return PooledContext(model, std::move(context));
+    }
+
+    // Elastic contexts beyond the retained count are only added while the
+    // model stays within SetMemoryLimit; a context's size is estimated from
+    // the ones that already exist
+    bool CanGrowPool(const ModelInstance& model) const {
+        if (memory_limit_mb_ == 0 || model.total_contexts < model.num_contexts ||
+            model.total_contexts == 0) {
+            return true;
+        }
+        size_t arena_bytes = model.arena_bytes.load();
+        size_t per_context = arena_bytes / model.total_contexts;
+        size_t projected = model.weights_bytes + arena_bytes + per_context;
+        return projected <= memory_limit_mb_ * 1024 * 1024;
+    }
+
+    bool PopulatePool(ModelInstance& model) {
+        model.idle_contexts.clear();
+        model.total_contexts = 0;
+        for (size_t i = 0; i < model.num_contexts; i++) {
+            auto context = CreateContext(model);
+            if (!context) {
+                return false;
             }
-            case ModelFormat::ONNX: {
-                auto input_shape = session_->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+            if (i == 0) {
+                model.input_info = context->input_info;
+                model.output_info = context->output_info;
+                if (context->memory_plan) {
+                    model.memory_plan_stats = context->memory_plan->GetStats();
+                } else {
+                    model.memory_plan_stats = MemoryPlanStats();
+                    model.memory_plan_stats.peak_arena_bytes = context->arena_bytes;
+                }
+            }
+            model.idle_contexts.push_back(std::move(context));
+            model.total_contexts++;
+        }
+        return true;
+    }
+
+    std::unique_ptr<ExecutionContext> CreateContext(ModelInstance& model) {
+        auto context = std::make_unique<ExecutionContext>();
+        context->model = &model;
+        try {
+            switch (model.format) {
+                case ModelFormat::TFLITE: {
+                    // Interpreters share the FlatBufferModel's weights and
+                    // only own their activation arena
+                    const bool use_cache = !model.cache_artifact_path.empty();
+                    tflite::ops::builtin::BuiltinOpResolver default_resolver;
+                    tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates cached_resolver;
+                    tflite::InterpreterBuilder builder(
+                        *model.tflite_model,
+                        use_cache ? static_cast<const tflite::OpResolver&>(cached_resolver)
+                                  : default_resolver);
+                    builder.SetNumThreads(num_threads_);
+                    builder(&context->interpreter);
+
+                    if (!context->interpreter) {
+                        SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+                        return nullptr;
+                    }
+                    context->interpreter->SetCancellationFunction(context.get(), [](void* data) {
+                        return static_cast<ExecutionContext*>(data)->cancel.Cancelled();
+                    });
+                    if (model.op_profile) {
+                        context->op_profiler = std::make_unique<TFLiteOpProfiler>(
+                            context->interpreter.get());
+                    }
+
+                    if (use_cache) {
+                        // XNNPACK loads its packed weights from the cache file,
+                        // or packs them and writes the file on a miss
+                        TfLiteXNNPackDelegateOptions options = TfLiteXNNPackDelegateOptionsDefault();
+                        options.num_threads = num_threads_;
+                        options.weight_cache_file_path = model.cache_artifact_path.c_str();
+                        context->delegate.reset(TfLiteXNNPackDelegateCreate(&options));
+                        if (context->interpreter->ModifyGraphWithDelegate(context->delegate.get()) !=
+                            kTfLiteOk) {
+                            SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+                            return nullptr;
+                        }
+                    }
+                    if (context->interpreter->AllocateTensors() != kTfLiteOk) {
+                        SetError(hardware::HardwareAccelerator::ErrorCode::RESOURCE_EXHAUSTED);
+                        return nullptr;
+                    }
+                    context->memory_plan = std::make_unique<TFLiteMemoryPlan>();
+                    if (!context->memory_plan->Apply(context->interpreter.get(), model.memory_plan,
+                                                     model.offline_memory_plan, model.max_batch_size)) {
+                        SetError(hardware::HardwareAccelerator::ErrorCode::RESOURCE_EXHAUSTED);
+                        return nullptr;
+                    }
+                    RefreshTFLiteTensorInfo(*context);
+                    break;
+                }
+                case ModelFormat::ONNX:
+                    if (!BindONNXBuffers(model, *context)) {
+                        return nullptr;
+                    }
+                    break;
+                case ModelFormat::PYTORCH:
+                case ModelFormat::CUSTOM:
+                    break;
+                default:
+                    SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+                    return nullptr;
+            }
+        } catch (const std::exception& e) {
+            ReportError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED, e.what());
+            SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+            return nullptr;
+        }
+        UpdateArenaBytes(*context);
+        return context;
+    }
+
+    // Dedicated context behind the stateful zero-copy and named-tensor API.
+    // Kept out of the pool so concurrent RunInference calls never touch the
+    // buffers a caller is filling.
+    // A swapped-in model is picked up only between Invoke cycles, so inputs
+    // already written for the next Invoke stay with the model they were
+    // written for.
+    ExecutionContext* PrimaryContext() {
+        auto model = CurrentModel();
+        if (!model) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+            return primary_context_.get();
+        }
+        if (!primary_context_ || (primary_model_ != model && !primary_inputs_pending_)) {
+            auto context = CreateContext(*model);
+            if (context) {
+                primary_context_ = std::move(context);
+                primary_model_ = std::move(model);
+            }
+        }
+        return primary_context_.get();
+    }
+
+    // Float elements per sample of the first input; only meaningful for
+    // single-input float models
+    size_t GetInputSize(ModelInstance& model) {
+        switch (model.format) {
+            case ModelFormat::TFLITE:
+            case ModelFormat::ONNX:
+                return model.input_info.empty() ? 0 : model.input_info[0].bytes / sizeof(float);
+            case ModelFormat::PYTORCH: {
+                auto input_shape = model.module.get_method("forward").graph()->inputs()[0]->type()->sizes();
                 return std::accumulate(input_shape.begin(), input_shape.end(), 1, std::multiplies<int64_t>());
             }
             case ModelFormat::CUSTOM:
@@ -327,338 +2142,1005 @@ private:
         }
     }
 
-    bool LoadTFLiteModel() {
-        try {
-            if (!std::filesystem::exists(model_path_)) {
-                last_error_ = hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT;
-                return false;
-            }
+    // Share the file's read-only mapping with every other engine that loads
+    // the same model
+    bool MapModelFile(ModelInstance& model) {
+        model.blob = core::ModelBlobStore::Instance().Acquire(model.path);
+        if (!model.blob) {
+            ReportError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED,
+                        "Failed to map model file " + model.path);
+            SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+            return false;
+        }
+        return true;
+    }
+
+    bool LoadTFLiteModel(ModelInstance& model) {
+        try {
+            if (!std::filesystem::exists(model.path)) {
+                SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+                return false;
+            }
+
+            if (!MapModelFile(model)) {
+                return false;
+            }
+
+            // Weights stay in the shared mapping and are referenced in place
+            // by every interpreter
+            model.tflite_model = tflite::FlatBufferModel::BuildFromBuffer(
+                reinterpret_cast<const char*>(model.blob->data()), model.blob->size());
+            if (!model.tflite_model) {
+                SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+                return false;
+            }
+
+            if (model.memory_plan == MemoryPlanStrategy::OFFLINE) {
+                // Without a usable plan the contexts fall back to GREEDY_BY_SIZE
+                const auto metadata = model.tflite_model->ReadAllMetadata();
+                auto plan = metadata.find("OfflineMemoryAllocation");
+                if (plan == metadata.end() ||
+                    !ParseOfflineMemoryPlan(plan->second, 0, &model.offline_memory_plan)) {
+                    model.offline_memory_plan.clear();
+                }
+            }
+
+            if (model.compiled_cache) {
+                model.cache_key = MakeCacheKey(model, "xnnpack_weights", TFLITE_VERSION_STRING);
+                std::string cached = model.compiled_cache->Lookup(model.cache_key);
+                model.cache_hit = !cached.empty();
+                model.cache_artifact_path = model.cache_hit
+                    ? cached : model.compiled_cache->GetArtifactPath(model.cache_key);
+            }
+            return true;
+        } catch (const std::exception& e) {
+            ReportError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED, e.what());
+            SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+            return false;
+        }
+    }
+
+    // A TFLite model runs whole on the accelerator when it supports at least
+    // one of its ops; the accelerator's own runtime handles the rest, and
+    // adaptive_backend can still prefer the CPU. A model with no supported
+    // op stays on the CPU. Decided at load time.
+    void PlanPlacement(ModelInstance& model) {
+        model.placement = Placement::CPU;
+        if (!UseAccelerator() || !model.accelerator) {
+            return;
+        }
+
+        OpSupportSummary summary = AnalyzeOpSupport(*model.tflite_model, *model.accelerator);
+        if (summary.supported_ops > 0) {
+            model.placement = Placement::ACCELERATOR;
+        }
+    }
+
+    bool LoadPyTorchModel(ModelInstance& model) {
+        try {
+            if (!std::filesystem::exists(model.path)) {
+                SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+                return false;
+            }
+
+            // Initialize PyTorch JIT module
+            model.module = torch::jit::load(model.path);
+            model.module.eval();
+
+            if (hw_acceleration_enabled_) {
+                model.module.to(torch::kCUDA);
+            }
+
+            return true;
+        } catch (const std::exception& e) {
+            ReportError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED, e.what());
+            SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+            return false;
+        }
+    }
+
+    CompiledModelKey MakeCacheKey(const ModelInstance& model, const std::string& artifact,
+                                  const std::string& runtime_version) const {
+        CompiledModelKey key;
+        key.model_hash = model.blob->content_hash();
+        key.backend = model.format == ModelFormat::TFLITE ? "tflite" : "onnx";
+        key.artifact = artifact;
+        key.accelerator = hw_acceleration_enabled_ && accelerator_
+            ? accelerator_->GetAcceleratorType() + "/" + accelerator_->GetDriverVersion()
+            : "cpu";
+        key.num_threads = num_threads_;
+        key.runtime_version = runtime_version;
+        return key;
+    }
+
+    // Load the session from a cached optimized graph, skipping graph
+    // optimization. On a miss, arrange for this load's session creation to
+    // write the optimized graph into the cache instead.
+    void LoadCachedONNXSession(ModelInstance& model, Ort::SessionOptions& session_options) {
+        model.cache_key = MakeCacheKey(model, "ort_optimized", Ort::GetVersionString());
+        std::string cached = model.compiled_cache->Lookup(model.cache_key);
+        if (!cached.empty()) {
+            auto cached_blob = core::ModelBlobStore::Instance().Acquire(cached);
+            try {
+                if (cached_blob) {
+                    Ort::SessionOptions cached_options = session_options.Clone();
+                    cached_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+                    model.session = std::make_unique<Ort::Session>(env_, cached_blob->data(),
+                                                                   cached_blob->size(),
+                                                                   cached_options);
+                    return;
+                }
+            } catch (const Ort::Exception&) {
+                // Fall through and rebuild the entry
+            }
+            model.compiled_cache->Invalidate(model.cache_key);
+        }
+
+        session_options.SetOptimizedModelFilePath(
+            model.compiled_cache->GetArtifactPath(model.cache_key).c_str());
+    }
+
+    bool LoadONNXModel(ModelInstance& model) {
+        try {
+            if (!std::filesystem::exists(model.path)) {
+                SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+                return false;
+            }
+
+            // Initialize ONNX Runtime session. Session::Run is thread-safe,
+            // so all execution contexts share it and only own their bindings.
+            Ort::SessionOptions session_options;
+            session_options.SetIntraOpNumThreads(num_threads_);
+
+            // An artifact from OptimizeModel needs no further graph passes; a
+            // fast start defers the expensive ones to the background optimizer
+            if (model.pre_optimized) {
+                session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+            } else if (model.fast_start) {
+                session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_BASIC);
+            }
+            if (model.op_profile) {
+                // Trace is collected and removed by GetOpProfile
+                const std::string profile_prefix = model.path + ".ort_profile";
+                session_options.EnableProfiling(profile_prefix.c_str());
+            }
+
+            if (hw_acceleration_enabled_) {
+                OrtCUDAProviderOptions cuda_options;
+                session_options.AppendExecutionProvider_CUDA(cuda_options);
+            }
+
+            if (!MapModelFile(model)) {
+                return false;
+            }
+
+            if (model.compiled_cache) {
+                LoadCachedONNXSession(model, session_options);
+            }
+            if (!model.session) {
+                model.session = std::make_unique<Ort::Session>(env_, model.blob->data(),
+                                                               model.blob->size(),
+                                                               session_options);
+                if (model.compiled_cache) {
+                    model.compiled_cache->Commit(model.cache_key);
+                }
+            }
+            model.onnx_profiling = model.op_profile != nullptr;
+
+            // Setup input/output bindings
+            Ort::AllocatorWithDefaultOptions allocator;
+
+            size_t num_inputs = model.session->GetInputCount();
+            size_t num_outputs = model.session->GetOutputCount();
+
+            model.input_names.reserve(num_inputs);
+            model.output_names.reserve(num_outputs);
+
+            for (size_t i = 0; i < num_inputs; i++) {
+                model.input_names.push_back(
+                    model.session->GetInputNameAllocated(i, allocator).get());
+            }
+
+            for (size_t i = 0; i < num_outputs; i++) {
+                model.output_names.push_back(
+                    model.session->GetOutputNameAllocated(i, allocator).get());
+            }
+
+            return true;
+        } catch (const std::exception& e) {
+            ReportError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED, e.what());
+            SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+            return false;
+        }
+    }
+
+    bool LoadCustomModel(ModelInstance& model) {
+        try {
+            if (!std::filesystem::exists(model.path)) {
+                SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+                return false;
+            }
+
+            if (!MapModelFile(model)) {
+                return false;
+            }
+
+            // Read custom header and validate format
+            CustomModelHeader header;
+            if (model.blob->size() < sizeof(header)) {
+                SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+                return false;
+            }
+            std::memcpy(&header, model.blob->data(), sizeof(header));
+
+            if (header.magic != CUSTOM_MODEL_MAGIC ||
+                header.model_size > model.blob->size() - sizeof(header)) {
+                SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+                return false;
+            }
+
+            // The model body is used in place from the mapping
+            model.custom_model_data = Span<const uint8_t>(model.blob->data() + sizeof(header),
+                                                          header.model_size);
+
+            return true;
+        } catch (const std::exception& e) {
+            ReportError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED, e.what());
+            SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+            return false;
+        }
+    }
+
+    tflite::SignatureRunner* GetSignatureRunner(const std::string& signature_key) {
+        ExecutionContext* context = PrimaryContext();
+        if (!context || !context->interpreter) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::UNSUPPORTED_OPERATION);
+            return nullptr;
+        }
+
+        tflite::SignatureRunner* runner =
+            context->interpreter->GetSignatureRunner(signature_key.c_str());
+        if (!runner) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+            return nullptr;
+        }
+
+        // Signature subgraphs are allocated lazily on first use
+        if (context->allocated_signatures.count(signature_key) == 0) {
+            if (runner->AllocateTensors() != kTfLiteOk) {
+                SetError(hardware::HardwareAccelerator::ErrorCode::RESOURCE_EXHAUSTED);
+                return nullptr;
+            }
+            context->allocated_signatures.insert(signature_key);
+        }
+        return runner;
+    }
+
+    // Re-estimate the memory owned by a context after it was (re)allocated
+    void UpdateArenaBytes(ExecutionContext& context) {
+        size_t bytes = 0;
+        if (context.interpreter) {
+            for (size_t i = 0; i < context.interpreter->subgraphs_size(); i++) {
+                tflite::Subgraph::SubgraphAllocInfo info{};
+                context.interpreter->subgraph(i)->GetMemoryAllocInfo(&info);
+                bytes += info.arena_size + info.arena_persist_size + info.dynamic_size;
+            }
+        }
+        for (const auto& buffer : context.onnx_inputs) {
+            bytes += buffer.storage.size();
+        }
+        for (const auto& buffer : context.onnx_outputs) {
+            bytes += buffer.storage.size();
+        }
+        if (context.memory_plan) {
+            bytes += context.memory_plan->GetArenaBytes();
+        }
+        bytes += context.batch_staging.capacity() * sizeof(float);
+        bytes += context.custom_output.capacity() * sizeof(float);
+
+        context.model->arena_bytes += bytes;
+        context.model->arena_bytes -= context.arena_bytes;
+        context.arena_bytes = bytes;
+    }
+
+    void RefreshTFLiteTensorInfo(ExecutionContext& context) {
+        context.input_info.clear();
+        context.output_info.clear();
+        for (size_t i = 0; i < context.interpreter->inputs().size(); i++) {
+            context.input_info.push_back(DescribeTFLiteTensor(context.interpreter->input_tensor(i)));
+        }
+        for (size_t i = 0; i < context.interpreter->outputs().size(); i++) {
+            context.output_info.push_back(DescribeTFLiteTensor(context.interpreter->output_tensor(i)));
+        }
+    }
+
+    bool GetInputBuffer(ExecutionContext& context, size_t index, TensorView* view) {
+        if (!view) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+            return false;
+        }
+
+        if (context.interpreter) {
+            if (index < context.interpreter->inputs().size()) {
+                FillView(context.interpreter->input_tensor(index), view);
+                return true;
+            }
+        } else if (context.io_binding) {
+            if (index < context.onnx_inputs.size()) {
+                view->data = context.onnx_inputs[index].storage.data();
+                view->bytes = context.onnx_inputs[index].storage.size();
+                view->type = context.input_info[index].type;
+                return true;
+            }
+        } else {
+            // PyTorch and custom models borrow the caller's input directly
+            SetError(hardware::HardwareAccelerator::ErrorCode::UNSUPPORTED_OPERATION);
+            return false;
+        }
+
+        SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+        return false;
+    }
+
+    bool GetOutputBuffer(ExecutionContext& context, size_t index, TensorView* view) {
+        if (!view) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+            return false;
+        }
+
+        if (context.interpreter) {
+            if (index < context.interpreter->outputs().size()) {
+                FillView(context.interpreter->output_tensor(index), view);
+                return true;
+            }
+        } else if (context.io_binding) {
+            if (index < context.onnx_outputs.size()) {
+                view->data = context.onnx_outputs[index].storage.data();
+                view->bytes = context.onnx_outputs[index].storage.size();
+                view->type = context.output_info[index].type;
+                return true;
+            }
+        } else if (context.torch_output.defined()) {
+            if (index == 0) {
+                view->data = context.torch_output.data_ptr<float>();
+                view->bytes = context.torch_output.numel() * sizeof(float);
+                view->type = TensorType::FLOAT32;
+                return true;
+            }
+        } else if (index == 0) {
+            view->data = context.custom_output.data();
+            view->bytes = context.custom_output.size() * sizeof(float);
+            view->type = TensorType::FLOAT32;
+            return true;
+        }
+
+        SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+        return false;
+    }
+
+    bool RunSequentialBatch(const std::vector<std::vector<float>>& inputs,
+                            std::vector<std::vector<float>>& outputs,
+                            InferenceMetrics* metrics,
+                            const CancellationToken* token) {
+        outputs.resize(inputs.size());
+        bool success = true;
+        InferenceMetrics batch_metrics{};
+
+        for (size_t i = 0; i < inputs.size(); i++) {
+            InferenceMetrics single_metrics{};
+            bool ran = token ? RunModel(inputs[i], outputs[i], &single_metrics, token)
+                             : RunInference(inputs[i], outputs[i], &single_metrics);
+            if (!ran) {
+                success = false;
+            }
+            batch_metrics.inference_time_ms += single_metrics.inference_time_ms;
+            batch_metrics.memory_usage_mb = std::max(batch_metrics.memory_usage_mb,
+                                                   single_metrics.memory_usage_mb);
+            batch_metrics.cpu_usage_percent = std::max(batch_metrics.cpu_usage_percent,
+                                                     single_metrics.cpu_usage_percent);
+            batch_metrics.gpu_usage_percent = std::max(batch_metrics.gpu_usage_percent,
+                                                     single_metrics.gpu_usage_percent);
+        }
+
+        if (metrics) {
+            *metrics = batch_metrics;
+        }
+
+        return success;
+    }
+
+    // Resize the leading dimension of the (single) model input. Reallocation
+    // only happens when the batch size actually changes.
+    bool ResizeBatch(ExecutionContext& context, size_t batch_size) {
+        if (batch_size == context.batch_size) {
+            return true;
+        }
+
+        if (context.interpreter) {
+            tflite::Interpreter& interpreter = *context.interpreter;
+            if (interpreter.inputs().size() != 1 ||
+                context.input_info.empty() || context.input_info[0].shape.empty()) {
+                return false;
+            }
+
+            std::vector<int> dims(context.input_info[0].shape.begin(),
+                                  context.input_info[0].shape.end());
+            dims[0] = static_cast<int>(batch_size);
+            if (interpreter.ResizeInputTensor(interpreter.inputs()[0], dims) != kTfLiteOk ||
+                interpreter.AllocateTensors() != kTfLiteOk) {
+                // Restore the previous batch so the interpreter stays usable
+                dims[0] = static_cast<int>(context.batch_size);
+                interpreter.ResizeInputTensor(interpreter.inputs()[0], dims);
+                interpreter.AllocateTensors();
+                return false;
+            }
+            RefreshTFLiteTensorInfo(context);
+        } else if (context.io_binding) {
+            if (context.onnx_inputs.size() != 1 || !context.onnx_inputs[0].dynamic_batch ||
+                !BindONNXBuffers(*context.model, context, batch_size)) {
+                return false;
+            }
+        } else if (context.model->format != ModelFormat::PYTORCH) {
+            // TorchScript modules take whatever leading dimension we pass;
+            // custom models only run one sample at a time
+            return false;
+        }
+
+        context.batch_size = batch_size;
+        UpdateArenaBytes(context);
+        return true;
+    }
+
+    bool PackBatch(ExecutionContext& context, const std::vector<std::vector<float>>& inputs) {
+        const size_t sample_size = inputs[0].size();
+        const bool staged = !context.interpreter && !context.io_binding;
+
+        float* dst = nullptr;
+        if (staged) {
+            context.batch_staging.resize(inputs.size() * sample_size);
+            dst = context.batch_staging.data();
+        } else {
+            TensorView view;
+            if (!GetInputBuffer(context, 0, &view)) {
+                return false;
+            }
+            if (view.type != TensorType::FLOAT32 ||
+                view.Count<float>() != inputs.size() * sample_size) {
+                SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+                return false;
+            }
+            dst = view.As<float>();
+        }
+
+        for (const auto& input : inputs) {
+            std::memcpy(dst, input.data(), sample_size * sizeof(float));
+            dst += sample_size;
+        }
+
+        if (staged) {
+            context.torch_input = torch::from_blob(context.batch_staging.data(),
+                                                   {static_cast<long>(inputs.size()),
+                                                    static_cast<long>(sample_size)});
+        }
+        return true;
+    }
+
+    bool UnpackBatch(ExecutionContext& context, std::vector<std::vector<float>>& outputs,
+                     size_t batch_size) {
+        TensorView view;
+        if (!GetOutputBuffer(context, 0, &view) || view.type != TensorType::FLOAT32) {
+            return false;
+        }
+
+        size_t total = view.Count<float>();
+        if (total % batch_size != 0) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+            return false;
+        }
+
+        const size_t per_sample = total / batch_size;
+        const float* src = view.As<const float>();
+        outputs.resize(batch_size);
+        for (auto& output : outputs) {
+            output.assign(src, src + per_sample);
+            src += per_sample;
+        }
+        return true;
+    }
+
+    bool UseAccelerator() const {
+        return hw_acceleration_enabled_ && accelerator_ && accelerator_->IsAvailable();
+    }
 
-            // Initialize TFLite interpreter
-            model_ = tflite::FlatBufferModel::BuildFromFile(model_path_.c_str());
-            if (!model_) {
-                last_error_ = hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
-                return false;
-            }
+    // Whole-model accelerator path; CPU-placed models run in their execution
+    // contexts
+    bool RunsOnAccelerator(const ModelInstance* model) const {
+        return model && hw_acceleration_enabled_ && model->accelerator &&
+               model->accelerator->IsAvailable() && model->placement == Placement::ACCELERATOR;
+    }
 
-            tflite::ops::builtin::BuiltinOpResolver resolver;
-            tflite::InterpreterBuilder builder(*model_, resolver);
-            builder.SetNumThreads(num_threads_);
-            
-            std::unique_ptr<tflite::Interpreter> interpreter;
-            builder(&interpreter);
-            
-            if (!interpreter) {
-                last_error_ = hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
-                return false;
-            }
+    // Backend for one request. Models without a selector keep the static
+    // placement; without a model there is nothing to run on the accelerator.
+    size_t SelectBackend(ModelInstance* model) {
+        if (!model || !RunsOnAccelerator(model)) {
+            return CPU_BACKEND;
+        }
+        return model->backend_selector ? model->backend_selector->Select() : ACCELERATOR_BACKEND;
+    }
 
-            // Allocate tensors
-            interpreter->AllocateTensors();
-            
-            interpreter_ = std::move(interpreter);
-            return true;
-        } catch (const std::exception& e) {
-            if (error_callback_) {
-                error_callback_(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED, e.what());
-            }
-            last_error_ = hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
+    // Accelerator unless measurements say the CPU is faster; used where a
+    // request cannot be split across backends, e.g. packed batches
+    bool PrefersAccelerator(const ModelInstance* model) const {
+        return RunsOnAccelerator(model) &&
+               !(model->backend_selector && model->backend_selector->Best() == CPU_BACKEND);
+    }
+
+    // Wall time from request start, so accelerator queueing counts against it
+    CancelScope BeginRequest(const CancellationToken* token) const {
+        CancelScope scope;
+        scope.token = token;
+        scope.generation = &cancel_generation_;
+        scope.start_generation = cancel_generation_.load(std::memory_order_relaxed);
+        return scope;
+    }
+
+    // True when a failed request was cancelled. Cancelled runs say nothing
+    // about a backend's speed, so callers skip RecordBackend for them.
+    bool RecordCancellation(const CancelScope& cancel, bool success) {
+        if (success || !cancel.Cancelled()) {
             return false;
         }
+        cancelled_requests_.fetch_add(1, std::memory_order_relaxed);
+        SetError(hardware::HardwareAccelerator::ErrorCode::CANCELLED);
+        return true;
     }
 
-    bool LoadPyTorchModel() {
-        try {
-            if (!std::filesystem::exists(model_path_)) {
-                last_error_ = hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT;
-                return false;
-            }
+    void RecordBackend(ModelInstance* model, size_t backend,
+                       std::chrono::high_resolution_clock::time_point start_time, bool success) {
+        if (!model || !model->backend_selector || !RunsOnAccelerator(model)) {
+            return;
+        }
+        float elapsed_ms = std::chrono::duration<float, std::milli>(
+            std::chrono::high_resolution_clock::now() - start_time).count();
+        model->backend_selector->Record(backend, elapsed_ms, success);
+    }
 
-            // Initialize PyTorch JIT module
-            module_ = torch::jit::load(model_path_);
-            module_.eval();
-            
-            if (hw_acceleration_enabled_) {
-                module_.to(torch::kCUDA);
-            }
-            
-            return true;
-        } catch (const std::exception& e) {
-            if (error_callback_) {
-                error_callback_(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED, e.what());
-            }
-            last_error_ = hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
-            return false;
+    // Hand the context's last op profile to the caller's metrics
+    void TakeOpProfile(ExecutionContext& context, InferenceMetrics* metrics) {
+        if (metrics && context.op_profiler) {
+            metrics->op_profile.swap(context.op_profile);
         }
     }
 
-    bool LoadONNXModel() {
+    // Fold ORT's session trace into the window; profiling stops for the
+    // session afterwards
+    void CollectONNXProfile(ModelInstance& model) const {
+        if (!model.session) {
+            return;
+        }
         try {
-            if (!std::filesystem::exists(model_path_)) {
-                last_error_ = hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT;
-                return false;
-            }
-
-            // Initialize ONNX Runtime session
-            Ort::SessionOptions session_options;
-            session_options.SetIntraOpNumThreads(num_threads_);
-            
-            if (hw_acceleration_enabled_) {
-                OrtCUDAProviderOptions cuda_options;
-                session_options.AppendExecutionProvider_CUDA(cuda_options);
-            }
-            
-            env_ = Ort::Env(ORT_LOGGING_LEVEL_WARNING, "onnx_model");
-            session_ = std::make_unique<Ort::Session>(env_, model_path_.c_str(), 
-                                                    session_options);
-            
-            // Setup input/output bindings
             Ort::AllocatorWithDefaultOptions allocator;
-            
-            size_t num_inputs = session_->GetInputCount();
-            size_t num_outputs = session_->GetOutputCount();
-            
-            input_names_.reserve(num_inputs);
-            output_names_.reserve(num_outputs);
-            
-            for (size_t i = 0; i < num_inputs; i++) {
-                input_names_.push_back(
-                    session_->GetInputNameAllocated(i, allocator).get());
-            }
-            
-            for (size_t i = 0; i < num_outputs; i++) {
-                output_names_.push_back(
-                    session_->GetOutputNameAllocated(i, allocator).get());
-            }
-            
-            return true;
-        } catch (const std::exception& e) {
-            if (error_callback_) {
-                error_callback_(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED, e.what());
+            auto trace = model.session->EndProfilingAllocated(allocator);
+            std::vector<std::vector<OpProfile>> runs;
+            if (ParseONNXProfile(trace.get(), &runs)) {
+                for (const auto& run : runs) {
+                    model.op_profile->Add(run);
+                }
             }
-            last_error_ = hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
-            return false;
+            std::error_code ec;
+            std::filesystem::remove(trace.get(), ec);
+        } catch (const Ort::Exception& e) {
+            ReportError(hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR, e.what());
         }
     }
 
-    bool LoadCustomModel() {
-        try {
-            if (!std::filesystem::exists(model_path_)) {
-                last_error_ = hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT;
-                return false;
-            }
+    // Every request is counted, with or without metrics; process-level
+    // figures come from the shared sampler rather than from /proc here
+    void RecordMetrics(std::chrono::high_resolution_clock::time_point start_time,
+                       bool success,
+                       const hardware::HardwareAccelerator::PerformanceMetrics& hw_metrics,
+                       InferenceMetrics* metrics) {
+        auto end_time = std::chrono::high_resolution_clock::now();
+        float elapsed_ms = std::chrono::duration<float, std::milli>(end_time - start_time).count();
+        latency_.Record(elapsed_ms, success);
+        if (!metrics) {
+            return;
+        }
 
-            // Load custom model format
-            std::ifstream model_file(model_path_, std::ios::binary);
-            if (!model_file) {
-                last_error_ = hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
-                return false;
+        monitoring::ProcessStats process = process_stats_->Get();
+        metrics->inference_time_ms = elapsed_ms;
+        metrics->memory_usage_mb = process.memory_usage_mb;
+        metrics->cpu_usage_percent = process.cpu_usage_percent;
+        metrics->gpu_usage_percent = hw_acceleration_enabled_ ? hw_metrics.utilizationPercent : 0.0f;
+    }
+
+    // Stage a single sample into the context and execute. TFLite and ONNX
+    // copy into their preallocated input buffers; PyTorch and custom models
+    // borrow the caller's memory for the duration of the call.
+    bool RunCPUInference(ExecutionContext& context, Span<const float> input) {
+        if (input.empty()) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+            return false;
+        }
+        if (!ResizeBatch(context, 1)) {
+            return false;
+        }
+
+        switch (context.model->format) {
+            case ModelFormat::TFLITE:
+            case ModelFormat::ONNX: {
+                TensorView view;
+                if (!GetInputBuffer(context, 0, &view)) {
+                    return false;
+                }
+                // A short input would leave the previous request's values in
+                // the tail of the buffer
+                if (view.type != TensorType::FLOAT32 || input.size() != view.Count<float>()) {
+                    SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+                    return false;
+                }
+                std::memcpy(view.data, input.data(), input.size_bytes());
+                break;
             }
-            
-            // Read custom header and validate format
-            CustomModelHeader header;
-            model_file.read(reinterpret_cast<char*>(&header), sizeof(header));
-            
-            if (header.magic != CUSTOM_MODEL_MAGIC) {
-                last_error_ = hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT;
+            case ModelFormat::PYTORCH:
+                context.torch_input = torch::from_blob(const_cast<float*>(input.data()),
+                                                       {1, static_cast<long>(input.size())});
+                break;
+            case ModelFormat::CUSTOM:
+                context.custom_input = input;
+                break;
+            default:
+                SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
                 return false;
-            }
-            
-            // Setup model for inference
-            custom_model_data_.resize(header.model_size);
-            model_file.read(reinterpret_cast<char*>(custom_model_data_.data()), 
-                          header.model_size);
-            
-            return true;
-        } catch (const std::exception& e) {
-            if (error_callback_) {
-                error_callback_(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED, e.what());
-            }
-            last_error_ = hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
+        }
+
+        return Execute(context);
+    }
+
+    // Preprocess an image straight into the context's input 0 buffer
+    bool PreprocessInput(ExecutionContext& context, const ImageBuffer& image) {
+        if (!ResizeBatch(context, 1)) {
+            return false;
+        }
+        TensorView view;
+        if (context.input_info.empty() || !GetInputBuffer(context, 0, &view)) {
+            return false;
+        }
+        if (!context.model->preprocessor->Run(image, context.input_info[0], view.data, view.bytes)) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
             return false;
         }
+        return true;
     }
 
-    bool RunCPUInference(const std::vector<float>& input, std::vector<float>& output) {
-        try {
-            if (input.empty()) {
-                last_error_ = hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT;
-                return false;
-            }
+    // Run the model on whatever is currently in the context's input buffers
+    bool Execute(ExecutionContext& context) {
+        ModelInstance* model = context.model;
+        if (context.cancel.Cancelled()) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::CANCELLED);
+            return false;
+        }
 
-            switch (format_) {
+        try {
+            switch (model->format) {
                 case ModelFormat::TFLITE: {
-                    auto* input_tensor = interpreter_->input_tensor(0);
-                    std::memcpy(input_tensor->data.f, input.data(), 
-                              input.size() * sizeof(float));
-                    
-                    interpreter_->Invoke();
-                    
-                    auto* output_tensor = interpreter_->output_tensor(0);
-                    output.resize(output_tensor->bytes / sizeof(float));
-                    std::memcpy(output.data(), output_tensor->data.f, 
-                              output_tensor->bytes);
+                    if (context.op_profiler) {
+                        context.op_profiler->Start();
+                    }
+                    const bool invoked = context.interpreter &&
+                                         context.interpreter->Invoke() == kTfLiteOk;
+                    if (context.op_profiler) {
+                        context.op_profiler->Stop(&context.op_profile);
+                        if (invoked) {
+                            model->op_profile->Add(context.op_profile);
+                        }
+                    }
+                    if (!invoked) {
+                        SetError(context.cancel.Cancelled()
+                            ? hardware::HardwareAccelerator::ErrorCode::CANCELLED
+                            : hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR);
+                        return false;
+                    }
                     break;
                 }
                 case ModelFormat::PYTORCH: {
-                    torch::Tensor input_tensor = 
-                        torch::from_blob(const_cast<float*>(input.data()),
-                                       {1, static_cast<long>(input.size())});
-                    
+                    if (!context.torch_input.defined()) {
+                        SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+                        return false;
+                    }
                     std::vector<torch::jit::IValue> inputs;
-                    inputs.push_back(input_tensor);
-                    
-                    auto output_tensor = module_.forward(inputs).toTensor();
-                    output.resize(output_tensor.numel());
-                    std::memcpy(output.data(), output_tensor.data_ptr<float>(),
-                              output_tensor.numel() * sizeof(float));
+                    inputs.push_back(context.torch_input);
+                    context.torch_output = model->module.forward(inputs).toTensor().contiguous();
                     break;
                 }
-                case ModelFormat::ONNX: {
-                    Ort::MemoryInfo memory_info = 
-                        Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-                    
-                    std::vector<int64_t> input_shape = {1, static_cast<int64_t>(input.size())};
-                    Ort::Value input_tensor = Ort::Value::CreateTensor<float>(
-                        memory_info, const_cast<float*>(input.data()), input.size(),
-                        input_shape.data(), input_shape.size());
-                    
-                    auto output_tensors = session_->Run(
-                        Ort::RunOptions{nullptr}, 
-                        input_names_.data(), &input_tensor, 1,
-                        output_names_.data(), output_names_.size());
-                    
-                    auto& output_tensor = output_tensors[0];
-                    auto output_shape = output_tensor.GetTensorTypeAndShapeInfo().GetShape();
-                    size_t output_size = std::accumulate(output_shape.begin(), 
-                                                       output_shape.end(), 1,
-                                                       std::multiplies<int64_t>());
-                    
-                    output.resize(output_size);
-                    std::memcpy(output.data(), output_tensor.GetTensorData<float>(),
-                              output_size * sizeof(float));
+                case ModelFormat::ONNX:
+                    if (!model->session || !context.io_binding) {
+                        SetError(hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED);
+                        return false;
+                    }
+                    // Inputs and outputs are bound to preallocated buffers, so
+                    // Run() neither allocates tensors nor copies results out
+                    {
+                        WatchedRun watched(*this, context);
+                        model->session->Run(*context.run_options, *context.io_binding);
+                    }
                     break;
-                }
                 case ModelFormat::CUSTOM: {
-                    // Custom inference implementation
-                    CustomInferenceContext context;
-                    context.input_data = input.data();
-                    context.input_size = input.size();
-                    context.model_data = custom_model_data_.data();
-                    context.model_size = custom_model_data_.size();
-                    
-                    std::vector<float> result;
-                    if (!RunCustomInference(context, result)) {
+                    CustomInferenceContext custom_context;
+                    custom_context.input_data = context.custom_input.data();
+                    custom_context.input_size = context.custom_input.size();
+                    custom_context.model_data = model->custom_model_data.data();
+                    custom_context.model_size = model->custom_model_data.size();
+
+                    if (!RunCustomInference(custom_context, context.custom_output)) {
                         return false;
                     }
-                    
-                    output = std::move(result);
                     break;
                 }
                 default:
-                    last_error_ = hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT;
+                    SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
                     return false;
             }
-            
+
             return true;
         } catch (const std::exception& e) {
-            if (error_callback_) {
-                error_callback_(hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR, e.what());
+            if (context.cancel.Cancelled()) {
+                // A terminated ONNX run
+                SetError(hardware::HardwareAccelerator::ErrorCode::CANCELLED);
+                return false;
             }
-            last_error_ = hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR;
+            ReportError(hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR, e.what());
+            SetError(hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR);
             return false;
         }
     }
 
-    float GetCurrentMemoryUsage() {
-        try {
-            // Get process status
-            std::ifstream status("/proc/self/status");
-            std::string line;
-            while (std::getline(status, line)) {
-                if (line.find("VmRSS:") != std::string::npos) {
-                    // Extract memory usage in KB and convert to MB
-                    int kb;
-                    sscanf(line.c_str(), "VmRSS: %d", &kb);
-                    return kb / 1024.0f;
+    // Registers a running ONNX context with the watchdog for its lifetime;
+    // a terminated RunOptions is reset on the way out
+    class WatchedRun {
+    public:
+        WatchedRun(Impl& engine, ExecutionContext& context) : engine_(engine), context_(context) {
+            std::lock_guard<std::mutex> lock(engine_.watchdog_mutex_);
+            engine_.watched_runs_.push_back(&context_);
+            if (!engine_.watchdog_.joinable()) {
+                engine_.watchdog_ = std::thread(&Impl::WatchdogLoop, &engine_);
+            }
+            engine_.watchdog_cv_.notify_one();
+        }
+
+        ~WatchedRun() {
+            bool terminated = false;
+            {
+                std::lock_guard<std::mutex> lock(engine_.watchdog_mutex_);
+                auto& runs = engine_.watched_runs_;
+                runs.erase(std::find(runs.begin(), runs.end(), &context_));
+                std::swap(terminated, context_.terminated);
+            }
+            if (terminated) {
+                try {
+                    context_.run_options->UnsetTerminate();
+                } catch (const std::exception&) {
+                }
+            }
+        }
+
+    private:
+        Impl& engine_;
+        ExecutionContext& context_;
+    };
+
+    // ONNX Runtime has no cancellation callback, so running sessions are
+    // polled and terminated from here once their request is cancelled
+    void WatchdogLoop() {
+        std::unique_lock<std::mutex> lock(watchdog_mutex_);
+        while (!watchdog_stopping_) {
+            if (watched_runs_.empty()) {
+                watchdog_cv_.wait(lock);
+                continue;
+            }
+            for (ExecutionContext* context : watched_runs_) {
+                if (!context->terminated && context->cancel.Cancelled()) {
+                    try {
+                        context->run_options->SetTerminate();
+                        context->terminated = true;
+                    } catch (const std::exception&) {
+                    }
                 }
             }
-        } catch (...) {
-            // Fallback if reading proc fails
+            watchdog_cv_.wait_for(lock, CANCEL_POLL_INTERVAL);
         }
-        return 0.0f;
     }
 
-    float GetCPUUsage() {
-        try {
-            // Get process CPU stats
-            std::ifstream stat("/proc/self/stat");
-            unsigned long utime, stime;
-            stat >> utime >> stime;
-            
-            // Calculate CPU usage percentage
-            float total_time = utime + stime;
-            float cpu_usage = (total_time / sysconf(_SC_CLK_TCK)) * 100.0f;
-            
-            return cpu_usage;
-        } catch (...) {
-            // Fallback if reading proc fails
-        }
-        return 0.0f;
-    }
-
-    std::unique_ptr<hardware::HardwareAccelerator> accelerator_;
-    std::string model_path_;
-    ModelFormat format_;
+    void StopWatchdog() {
+        {
+            std::lock_guard<std::mutex> lock(watchdog_mutex_);
+            watchdog_stopping_ = true;
+        }
+        watchdog_cv_.notify_all();
+        if (watchdog_.joinable()) {
+            watchdog_.join();
+        }
+    }
+
+    bool CopyOutput(ExecutionContext& context, Span<float> output, size_t* output_size) {
+        TensorView view;
+        if (!GetOutputBuffer(context, 0, &view)) {
+            return false;
+        }
+        if (view.type != TensorType::FLOAT32) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::INVALID_INPUT);
+            return false;
+        }
+
+        size_t count = view.Count<float>();
+        if (output_size) {
+            *output_size = count;
+        }
+        if (count > output.size()) {
+            SetError(hardware::HardwareAccelerator::ErrorCode::RESOURCE_EXHAUSTED);
+            return false;
+        }
+        std::memcpy(output.data(), view.data, count * sizeof(float));
+        return true;
+    }
+
+    // Preallocate context-owned buffers for every ONNX input and output and
+    // bind them once, so inference never creates Ort::Value objects per call.
+    // Rebinding only happens when the batch size changes.
+    bool BindONNXBuffers(ModelInstance& model, ExecutionContext& context, size_t batch_size = 1) {
+        Ort::MemoryInfo memory_info =
+            Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+
+        context.io_binding = std::make_unique<Ort::IoBinding>(*model.session);
+        context.run_options = std::make_unique<Ort::RunOptions>();
+        context.onnx_inputs.clear();
+        context.onnx_outputs.clear();
+        context.input_info.clear();
+        context.output_info.clear();
+        context.onnx_inputs.reserve(model.input_names.size());
+        context.onnx_outputs.reserve(model.output_names.size());
+
+        for (size_t i = 0; i < model.input_names.size(); i++) {
+            context.onnx_inputs.push_back(CreateONNXBuffer(
+                model.session->GetInputTypeInfo(i), memory_info,
+                model.input_names[i], batch_size, context.input_info));
+            context.io_binding->BindInput(model.input_names[i].c_str(),
+                                          context.onnx_inputs.back().value);
+        }
+
+        for (size_t i = 0; i < model.output_names.size(); i++) {
+            context.onnx_outputs.push_back(CreateONNXBuffer(
+                model.session->GetOutputTypeInfo(i), memory_info,
+                model.output_names[i], batch_size, context.output_info));
+            context.io_binding->BindOutput(model.output_names[i].c_str(),
+                                           context.onnx_outputs.back().value);
+        }
+
+        return true;
+    }
+
+    ONNXBuffer CreateONNXBuffer(const Ort::TypeInfo& type_info, const Ort::MemoryInfo& memory_info,
+                                const std::string& name, size_t batch_size,
+                                std::vector<TensorInfo>& tensors) {
+        auto tensor_info = type_info.GetTensorTypeAndShapeInfo();
+        ONNXTensorElementDataType element_type = tensor_info.GetElementType();
+
+        ONNXBuffer buffer;
+        buffer.shape = tensor_info.GetShape();
+
+        // A dynamic leading axis is the batch dimension; any other dynamic
+        // axis is pinned to 1 for the preallocated binding
+        buffer.dynamic_batch = !buffer.shape.empty() && buffer.shape[0] < 0;
+        for (auto& dim : buffer.shape) {
+            if (dim < 0) {
+                dim = 1;
+            }
+        }
+        if (buffer.dynamic_batch) {
+            buffer.shape[0] = static_cast<int64_t>(batch_size);
+        }
+
+        TensorInfo info;
+        info.name = name;
+        info.type = FromONNXType(element_type);
+        info.shape = buffer.shape;
+
+        size_t count = std::accumulate(buffer.shape.begin(), buffer.shape.end(),
+                                       static_cast<int64_t>(1), std::multiplies<int64_t>());
+        info.bytes = count * TensorTypeSize(info.type);
+        buffer.storage.resize(info.bytes);
+        buffer.value = Ort::Value::CreateTensor(
+            memory_info, buffer.storage.data(), buffer.storage.size(),
+            buffer.shape.data(), buffer.shape.size(), element_type);
+
+        tensors.push_back(std::move(info));
+        return buffer;
+    }
+
+    std::shared_ptr<hardware::HardwareAccelerator> accelerator_;   // Also held by loaded models
+    std::mutex accelerator_mutex_;
+    // Replaced by loads and SetExecutionContextLimits while requests read
+    // it; only accessed through GetConfig/SetConfig. Also guards the error
+    // callback and compiled-model cache, which the optimizer thread reads.
+    mutable std::mutex config_mutex_;
     ModelConfig config_;
     int num_threads_;
     bool hw_acceleration_enabled_;
     size_t memory_limit_mb_;
     hardware::HardwareAccelerator::PowerProfile power_profile_;
     ErrorCallback error_callback_;
-    hardware::HardwareAccelerator::ErrorCode last_error_{hardware::HardwareAccelerator::ErrorCode::SUCCESS};
-    
-    // TFLite specific members
-    std::unique_ptr<tflite::FlatBufferModel> model_;
-    std::unique_ptr<tflite::Interpreter> interpreter_;
-    
-    // PyTorch specific members
-    torch::jit::Module module_;
-    
-    // ONNX Runtime specific members
+    std::atomic<hardware::HardwareAccelerator::ErrorCode> last_error_{hardware::HardwareAccelerator::ErrorCode::SUCCESS};
+
+    // Must outlive every session created from it
     Ort::Env env_{ORT_LOGGING_LEVEL_WARNING, "onnx_model"};
-    std::unique_ptr<Ort::Session> session_;
-    std::vector<std::string> input_names_;
-    std::vector<std::string> output_names_;
-    
-    // Custom model specific members
-    std::vector<uint8_t> custom_model_data_;
+
+    // Current model version. Read and replaced with std::atomic_load/store;
+    // every request pins the version it started on.
+    std::shared_ptr<ModelInstance> model_;
+    std::mutex swap_mutex_;
+    std::atomic<uint64_t> load_generation_{0};
+    std::atomic<uint64_t> model_version_{0};
+    std::shared_ptr<ResultCache> result_cache_;
+    std::shared_ptr<monitoring::ProcessStatsSampler> process_stats_;
+    monitoring::LatencyRecorder latency_;
+    std::thread optimize_thread_;
+
+    std::shared_ptr<ModelInstance> primary_model_;
+    std::unique_ptr<ExecutionContext> primary_context_;
+    bool primary_inputs_pending_ = false;
+    std::shared_ptr<CompiledModelCache> compiled_cache_;
+
+    // SubmitInference worker threads
+    std::mutex async_mutex_;
+    std::condition_variable async_cv_;
+    std::deque<AsyncRequest> async_queue_;
+    std::vector<std::thread> async_workers_;
+    bool async_running_ = false;
+    uint64_t async_request_id_ = 0;
+
+    // Cancellation: CancelAllInferences bumps the generation every running
+    // request compares against; the watchdog terminates cancelled ONNX runs
+    std::atomic<uint64_t> cancel_generation_{0};
+    std::atomic<uint64_t> cancelled_requests_{0};
+    std::mutex watchdog_mutex_;
+    std::condition_variable watchdog_cv_;
+    std::vector<ExecutionContext*> watched_runs_;
+    bool watchdog_stopping_ = false;
+    std::thread watchdog_;
+
+    // Custom model format
     static constexpr uint32_t CUSTOM_MODEL_MAGIC = 0x4D4F4445; // "MODE"
-    
+
     struct CustomModelHeader {
         uint32_t magic;
         uint32_t version;
         uint32_t model_size;
     };
-    
+
     struct CustomInferenceContext {
         const float* input_data;
         size_t input_size;
         const uint8_t* model_data;
         size_t model_size;
     };
-    
+
     bool RunCustomInference(const CustomInferenceContext& context,
                           std::vector<float>& output) {
         // Custom inference implementation
         // This is a placeholder - implement actual custom inference logic
         output.resize(context.input_size);
-        std::memcpy(output.data(), context.input_data, 
+        std::memcpy(output.data(), context.input_data,
                    context.input_size * sizeof(float));
         return true;
     }
 };
 
+class StreamingSession::Impl {
+public:
+    ModelEngine::Impl* engine = nullptr;
+    std::unique_ptr<StreamState> stream;
+};
+
 ModelEngine::ModelEngine() : pImpl(std::make_unique<Impl>()) {}
 ModelEngine::~ModelEngine() = default;
 
@@ -666,33 +3148,212 @@ bool ModelEngine::Initialize(std::unique_ptr<hardware::HardwareAccelerator> acce
     return pImpl->Initialize(std::move(accelerator));
 }
 
-bool ModelEngine::LoadModel(const std::string& model_path, 
+bool ModelEngine::LoadModel(const std::string& model_path,
                           ModelFormat format,
                           const ModelConfig& config) {
     return pImpl->LoadModel(model_path, format, config);
 }
 
-bool ModelEngine::RunInference(const std::vector<float>& input, 
+bool ModelEngine::ReplaceModel(const std::string& model_path,
+                             ModelFormat format,
+                             const ModelConfig& config,
+                             size_t warmup_runs) {
+    return pImpl->ReplaceModel(model_path, format, config, warmup_runs);
+}
+
+std::unique_ptr<StreamingSession> ModelEngine::CreateStreamingSession(const StreamingConfig& config) {
+    auto stream = pImpl->OpenStream(config);
+    if (!stream) {
+        return nullptr;
+    }
+    auto impl = std::make_unique<StreamingSession::Impl>();
+    impl->engine = pImpl.get();
+    impl->stream = std::move(stream);
+    return std::unique_ptr<StreamingSession>(new StreamingSession(std::move(impl)));
+}
+
+bool ModelEngine::RunInference(const std::vector<float>& input,
                              std::vector<float>& output,
                              InferenceMetrics* metrics) {
     return pImpl->RunInference(input, output, metrics);
 }
 
+bool ModelEngine::RunInference(Span<const float> input,
+                             Span<float> output,
+                             size_t* output_size,
+                             InferenceMetrics* metrics) {
+    return pImpl->RunInference(input, output, output_size, metrics);
+}
+
+bool ModelEngine::RunInference(const std::vector<float>& input,
+                             InferenceResult* result) {
+    return pImpl->RunRequest(input, nullptr, result);
+}
+
+bool ModelEngine::RunInference(const std::vector<float>& input,
+                             const CancellationToken& token,
+                             InferenceResult* result) {
+    return pImpl->RunRequest(input, &token, result);
+}
+
+bool ModelEngine::RunInference(const ImageBuffer& image,
+                             std::vector<float>& output,
+                             InferenceMetrics* metrics) {
+    return pImpl->RunInference(image, output, metrics);
+}
+
+bool ModelEngine::RunInference(const std::vector<float>& input,
+                             std::vector<float>& output,
+                             const CancellationToken& token,
+                             InferenceMetrics* metrics) {
+    return pImpl->RunInference(input, output, token, metrics);
+}
+
+std::future<InferenceResult> ModelEngine::SubmitInference(std::vector<float> input,
+                                                         CompletionCallback callback,
+                                                         std::shared_ptr<const CancellationToken> token) {
+    return pImpl->SubmitInference(std::move(input), std::move(callback), std::move(token));
+}
+
+void ModelEngine::CancelAllInferences() {
+    pImpl->CancelAllInferences();
+}
+
+bool ModelEngine::SetBatchSize(size_t batch_size) {
+    return pImpl->SetBatchSize(batch_size);
+}
+
+bool ModelEngine::GetInputBuffer(size_t index, TensorView* view) {
+    return pImpl->GetInputBuffer(index, view);
+}
+
+bool ModelEngine::GetOutputBuffer(size_t index, TensorView* view) const {
+    return pImpl->GetOutputBuffer(index, view);
+}
+
+bool ModelEngine::GetOutputTensor(size_t index, TensorView* view, TensorInfo* info) const {
+    return pImpl->GetOutputTensor(index, view, info);
+}
+
+bool ModelEngine::Invoke(InferenceMetrics* metrics) {
+    return pImpl->Invoke(metrics);
+}
+
 bool ModelEngine::RunBatchInference(const std::vector<std::vector<float>>& inputs,
                                   std::vector<std::vector<float>>& outputs,
                                   InferenceMetrics* metrics) {
     return pImpl->RunBatchInference(inputs, outputs, metrics);
 }
 
+bool ModelEngine::RunBatchInference(const std::vector<std::vector<float>>& inputs,
+                                  std::vector<std::vector<float>>& outputs,
+                                  const CancellationToken& token,
+                                  InferenceMetrics* metrics) {
+    return pImpl->RunBatchInference(inputs, outputs, metrics, &token);
+}
+
+std::vector<std::string> ModelEngine::GetSignatureKeys() const {
+    return pImpl->GetSignatureKeys();
+}
+
+std::vector<TensorInfo> ModelEngine::GetInputTensorInfo(const std::string& signature_key) const {
+    return pImpl->GetTensorInfo(true, signature_key);
+}
+
+std::vector<TensorInfo> ModelEngine::GetOutputTensorInfo(const std::string& signature_key) const {
+    return pImpl->GetTensorInfo(false, signature_key);
+}
+
+bool ModelEngine::GetInputBuffer(const std::string& name, TensorView* view,
+                                 const std::string& signature_key) {
+    return pImpl->GetTensorBuffer(true, name, signature_key, view);
+}
+
+bool ModelEngine::GetOutputBuffer(const std::string& name, TensorView* view,
+                                  const std::string& signature_key) const {
+    return pImpl->GetTensorBuffer(false, name, signature_key, view);
+}
+
+bool ModelEngine::SetInput(const std::string& name, const void* data, size_t bytes,
+                           TensorType type, const std::string& signature_key) {
+    return pImpl->SetInput(name, data, bytes, type, signature_key);
+}
+
+bool ModelEngine::GetOutput(const std::string& name, void* data, size_t bytes,
+                            TensorType type, const std::string& signature_key) const {
+    return pImpl->GetOutput(name, data, bytes, type, signature_key);
+}
+
+bool ModelEngine::InvokeSignature(const std::string& signature_key, InferenceMetrics* metrics) {
+    return pImpl->InvokeSignature(signature_key, metrics);
+}
+
+std::vector<std::vector<int64_t>> ModelEngine::GetInputShapes() const {
+    return pImpl->GetShapes(true);
+}
+
+std::vector<std::vector<int64_t>> ModelEngine::GetOutputShapes() const {
+    return pImpl->GetShapes(false);
+}
+
 std::string ModelEngine::GetModelInfo() const {
-    // Implement model info retrieval
-    std::stringstream info;
-    info << "Model Path: " << pImpl->model_path_ << "\n";
-    info << "Format: " << static_cast<int>(pImpl->format_) << "\n";
-    info << "Hardware Acceleration: " << (pImpl->hw_acceleration_enabled_ ? "Enabled" : "Disabled") << "\n";
-    info << "Threads: " << pImpl->num_threads_ << "\n";
-    info << "Memory Limit: " << pImpl->memory_limit_mb_ << " MB\n";
-    return info.str();
+    return pImpl->GetModelInfo();
+}
+
+ModelConfig ModelEngine::GetModelConfig() const {
+    return pImpl->GetModelConfig();
+}
+
+void ModelEngine::SetExecutionContextLimits(size_t num_contexts, size_t max_contexts) {
+    pImpl->SetExecutionContextLimits(num_contexts, max_contexts);
+}
+
+size_t ModelEngine::GetExecutionContextCount() const {
+    return pImpl->GetExecutionContextCount();
+}
+
+ResultCacheStats ModelEngine::GetResultCacheStats() const {
+    return pImpl->GetResultCacheStats();
+}
+
+std::vector<hardware::BackendStats> ModelEngine::GetBackendStats() const {
+    return pImpl->GetBackendStats();
+}
+
+InferenceStats ModelEngine::GetInferenceStats() const {
+    return pImpl->GetInferenceStats();
+}
+
+void ModelEngine::ResetInferenceStats() {
+    pImpl->ResetInferenceStats();
+}
+
+std::vector<OpProfileSummary> ModelEngine::GetOpProfile() const {
+    return pImpl->GetOpProfile();
+}
+
+void ModelEngine::ResetOpProfile() {
+    pImpl->ResetOpProfile();
+}
+
+MemoryFootprint ModelEngine::GetMemoryFootprint() const {
+    return pImpl->GetMemoryFootprint();
+}
+
+MemoryPlanStats ModelEngine::GetMemoryPlanStats() const {
+    return pImpl->GetMemoryPlanStats();
+}
+
+size_t ModelEngine::ShedArenas() {
+    return pImpl->ShedArenas();
+}
+
+void ModelEngine::UnloadModel() {
+    pImpl->UnloadModel();
+}
+
+bool ModelEngine::IsModelLoaded() const {
+    return pImpl->IsModelLoaded();
 }
 
 void ModelEngine::SetNumThreads(int num_threads) {
@@ -731,9 +3392,32 @@ void ModelEngine::ReleaseResources() {
     pImpl->ReleaseResources();
 }
 
+WarmUpReport ModelEngine::WarmUp(const WarmUpOptions& options) {
+    return pImpl->WarmUp(options);
+}
+
 bool ModelEngine::WarmUp(size_t num_runs) {
     return pImpl->WarmUp(num_runs);
 }
 
+StreamingSession::StreamingSession(std::unique_ptr<Impl> impl) : pImpl(std::move(impl)) {}
+
+StreamingSession::~StreamingSession() = default;
+
+bool StreamingSession::Step(Span<const float> chunk,
+                            Span<float> output,
+                            size_t* output_size,
+                            InferenceMetrics* metrics) {
+    return pImpl->engine->StreamStep(*pImpl->stream, chunk, output, output_size, metrics);
+}
+
+void StreamingSession::Reset() {
+    pImpl->engine->ResetStream(*pImpl->stream);
+}
+
+uint64_t StreamingSession::GetStepCount() const {
+    return pImpl->stream->steps;
+}
+
 } // namespace inference
-} // namespace mobileai 
\ No newline at end of file
+} // namespace mobileai
@@ -1,10 +1,16 @@
 #pragma once
 
+#include "../hardware/backend_selector.h"
 #include "../hardware/hardware_accelerator.h"
+#include "cancellation_token.h"
+#include "image_preprocessor.h"
+#include "tensor_view.h"
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include <functional>
+#include <future>
 #include <chrono>
 
 namespace mobileai {
@@ -17,20 +23,180 @@ enum class ModelFormat {
     CUSTOM
 };
 
+// How the activations of a TFLite execution context share memory
+enum class MemoryPlanStrategy {
+    ARENA,            // TFLite's ArenaPlanner: first fit, in execution order
+    GREEDY_BY_SIZE,   // Largest tensors first, each in the tightest gap free for its lifetime
+    IN_PLACE,         // GREEDY_BY_SIZE, and element-wise ops write over an input that dies with them
+    OFFLINE           // Offsets from the model's "OfflineMemoryAllocation" metadata; the rest greedy
+};
+
 // Model configuration options
 struct ModelConfig {
     bool enable_optimization = true;
-    bool enable_caching = false;
+    bool enable_caching = false;       // Reuse prepared artifacts (optimized graphs, packed weights) across loads
+    std::string cache_dir;             // Prepared-artifact cache; defaults to <model dir>/.mobileai_cache
     size_t max_batch_size = 1;
+    size_t num_execution_contexts = 1;  // Contexts created at load and kept warm
+    size_t max_execution_contexts = 1;  // Extra contexts are created under load, up to this
+    size_t result_cache_mb = 0;         // Memoize outputs of repeated inputs; 0 = off
+    // Per-op timings in InferenceMetrics and GetOpProfile. ONNX models are
+    // profiled by ONNX Runtime as a one-shot snapshot: its trace grows with
+    // every run from load until the first GetOpProfile, which ends profiling
+    // for that model version; later runs are not profiled.
+    bool enable_op_profiling = false;
+    size_t op_profile_window = 100;     // Requests aggregated per GetOpProfile window
+    bool adaptive_backend = true;       // Route each request to the accelerator or the CPU, whichever measures faster
+    bool enable_preprocessing = false;  // Accept images through RunInference(ImageBuffer), prepared per preprocessing
+    PreprocessSpec preprocessing;
+    MemoryPlanStrategy memory_plan = MemoryPlanStrategy::ARENA;   // TFLite only
     std::string custom_options;
 };
 
-// Performance metrics for inference
+// One operator's share of a request (ModelConfig::enable_op_profiling)
+struct OpProfile {
+    std::string name;          // First output tensor (TFLite) or node name (ONNX)
+    std::string type;          // e.g. CONV_2D, Conv; a delegate kernel's delegate name
+    std::string device;        // "cpu", "xnnpack", another delegate's name, or the ONNX execution provider
+    int node_index = -1;       // TFLite node; -1 for ONNX
+    float duration_ms = 0.0f;
+    size_t arena_bytes = 0;    // Activation bytes the op reads and writes; weights excluded
+};
+
+// An operator aggregated over a profiling window
+struct OpProfileSummary {
+    OpProfile op;              // op.duration_ms is the mean over the window
+    uint64_t runs = 0;
+    float max_ms = 0.0f;
+    float share = 0.0f;        // Fraction of all profiled op time in the window
+};
+
+// Performance metrics for inference. Memory and CPU usage are process-wide
+// figures from a background sampler, refreshed every 250 ms.
 struct InferenceMetrics {
     float inference_time_ms;
     float memory_usage_mb;
     float cpu_usage_percent;
     float gpu_usage_percent;
+    std::vector<OpProfile> op_profile;  // TFLite requests run on the CPU path, when op profiling is on
+};
+
+// Counters kept for every request, whether or not metrics were requested
+struct InferenceStats {
+    uint64_t requests = 0;
+    uint64_t failures = 0;
+    uint64_t cancelled = 0;       // Ended by cancellation or deadline, queued requests included
+    float average_ms = 0.0f;
+    float p50_ms = 0.0f;          // Percentiles from a log2 histogram, within a factor of sqrt(2)
+    float p95_ms = 0.0f;
+    float p99_ms = 0.0f;
+    float max_ms = 0.0f;
+    float memory_usage_mb = 0.0f;     // Process resident set size
+    float cpu_usage_percent = 0.0f;   // Process CPU over the last sampling interval
+};
+
+// Memory attributable to the loaded model
+struct MemoryFootprint {
+    size_t weights_bytes = 0;      // Model file mapping or parameters
+    size_t arena_bytes = 0;        // Activation arenas and I/O buffers of all execution contexts
+    size_t accelerator_bytes = 0;  // Buffers held by the hardware accelerator
+
+    size_t Total() const { return weights_bytes + arena_bytes + accelerator_bytes; }
+};
+
+// Activation layout of one execution context, as created at load. The lower
+// bound and fragmentation are only computed for TFLite models.
+struct MemoryPlanStats {
+    MemoryPlanStrategy strategy = MemoryPlanStrategy::ARENA;   // As applied, after any fallback
+    size_t weights_bytes = 0;
+    size_t peak_arena_bytes = 0;    // Planned activations plus op scratch, sized for max_batch_size
+    size_t lower_bound_bytes = 0;   // Most bytes live at once; no layout of the same buffers fits in less
+    float fragmentation = 0.0f;     // 1 - lower_bound / peak_arena
+    size_t planned_tensors = 0;     // Moved out of TFLite's arena
+    size_t in_place_tensors = 0;    // Written over a dying input (IN_PLACE)
+};
+
+// What WarmUp exercises and when it considers latency settled
+struct WarmUpOptions {
+    std::vector<size_t> batch_sizes;  // Batch sizes that will be served; empty = {1}
+    bool warm_signatures = true;      // Also run every TFLite signature once warm
+    size_t min_runs = 3;              // Per context, signature and batch size
+    size_t max_runs = 30;
+    float tolerance = 0.05f;          // Converged once the last 3 runs are within this fraction
+};
+
+// Latency of one warmed configuration
+struct WarmUpStage {
+    std::string signature;            // Empty for the default graph
+    size_t batch_size = 1;
+    float first_run_ms = 0.0f;        // Cold run on the first context
+    float steady_state_ms = 0.0f;     // Slowest converged latency across contexts
+    size_t runs = 0;
+    bool converged = false;
+};
+
+struct WarmUpReport {
+    bool success = false;
+    float first_run_ms = 0.0f;        // Cold latency of the very first run
+    float steady_state_ms = 0.0f;     // Default graph at the smallest batch size
+    bool converged = false;           // Every stage settled before max_runs
+    std::vector<WarmUpStage> stages;
+};
+
+// ModelConfig::result_cache_mb counters
+struct ResultCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t coalesced = 0;   // Requests that waited on an identical in-flight request
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+// Outcome of a SubmitInference request
+struct InferenceResult {
+    uint64_t request_id = 0;
+    bool success = false;
+    hardware::HardwareAccelerator::ErrorCode error = hardware::HardwareAccelerator::ErrorCode::SUCCESS;
+    std::vector<float> output;
+    InferenceMetrics metrics{};
+};
+
+// Options for ModelEngine::CreateStreamingSession
+struct StreamingConfig {
+    // Output -> input tensor names copied across after every step, for
+    // models exported with explicit state (e.g. ring buffers of past 1-D
+    // conv activations). Recurrent state in TFLite variable tensors
+    // (LSTM/GRU/SVDF) persists between steps without a binding.
+    std::vector<std::pair<std::string, std::string>> state_bindings;
+};
+
+// Stateful, chunk-at-a-time inference over one dedicated execution context.
+// Input 0 receives the chunk; a chunk smaller than input 0 is slid into a
+// window the session keeps, for models that were not exported for streaming.
+// Not thread-safe; must not outlive the engine that created it.
+class StreamingSession {
+public:
+    ~StreamingSession();
+
+    // output receives output 0 of this step; see RunInference for sizing
+    bool Step(Span<const float> chunk,
+              Span<float> output,
+              size_t* output_size,
+              InferenceMetrics* metrics = nullptr);
+
+    // Clear recurrent state, bound state inputs and the window
+    void Reset();
+    uint64_t GetStepCount() const;
+
+private:
+    friend class ModelEngine;
+    class Impl;
+    explicit StreamingSession(std::unique_ptr<Impl> impl);
+    std::unique_ptr<Impl> pImpl;
+
+    StreamingSession(const StreamingSession&) = delete;
+    StreamingSession& operator=(const StreamingSession&) = delete;
 };
 
 class ModelEngine {
@@ -41,47 +207,206 @@ public:
     // Initialize with specific hardware accelerator
     bool Initialize(std::unique_ptr<hardware::HardwareAccelerator> accelerator);
 
-    // Load model with configuration options
+    // Load model with configuration options. With enable_optimization the
+    // engine serves the source model immediately, optimizes on a background
+    // thread and swaps the optimized version in when it is ready; the
+    // artifact is kept next to the model (<path>.optimized) for later loads.
     bool LoadModel(const std::string& model_path, 
                   ModelFormat format,
                   const ModelConfig& config = ModelConfig());
 
-    // Run inference with performance metrics
+    // Load and warm a new model version next to the current one, then switch
+    // new requests over atomically. Requests already running finish on the
+    // old version, which is freed once they complete. On failure the current
+    // version keeps serving.
+    bool ReplaceModel(const std::string& model_path,
+                     ModelFormat format,
+                     const ModelConfig& config = ModelConfig(),
+                     size_t warmup_runs = 1);
+
+    // Run inference with performance metrics. Safe to call from several
+    // threads: each call checks out its own execution context (interpreter,
+    // IoBinding, ...) over the shared model weights, and blocks while all
+    // max_execution_contexts are busy. With result_cache_mb set, a repeated
+    // input is answered from the cache, and identical concurrent requests
+    // share a single run.
     bool RunInference(const std::vector<float>& input, 
                      std::vector<float>& output,
                      InferenceMetrics* metrics = nullptr);
 
-    // Run batch inference
+    // Run inference on caller-owned buffers without intermediate allocations.
+    // Fails with RESOURCE_EXHAUSTED if output is too small; output_size always
+    // receives the number of elements the model produced.
+    bool RunInference(Span<const float> input,
+                     Span<float> output,
+                     size_t* output_size,
+                     InferenceMetrics* metrics = nullptr);
+
+    // As above, filling result with the output, metrics and this request's
+    // own error code; GetLastError may already report another request's.
+    bool RunInference(const std::vector<float>& input, InferenceResult* result);
+
+    // Run an image model on a raw image (ModelConfig::enable_preprocessing,
+    // TFLite and ONNX). The image is resized, normalized and converted in one
+    // pass straight into input 0, in the tensor's own layout and type; no
+    // float vector is staged on the CPU path. Bypasses the result cache.
+    bool RunInference(const ImageBuffer& image,
+                     std::vector<float>& output,
+                     InferenceMetrics* metrics = nullptr);
+
+    // Cancellable inference. Once token is cancelled or its deadline passes,
+    // a TFLite run stops at the next op boundary and an ONNX run is
+    // terminated through its RunOptions; the request fails with CANCELLED
+    // and its execution context returns to the pool at once. Requests still
+    // waiting for a context give up too. PyTorch, custom and whole-model
+    // accelerator runs are only checked before they start. Bypasses the
+    // result cache.
+    bool RunInference(const std::vector<float>& input,
+                     std::vector<float>& output,
+                     const CancellationToken& token,
+                     InferenceMetrics* metrics = nullptr);
+
+    // As above, filling result with this request's own error code
+    bool RunInference(const std::vector<float>& input,
+                     const CancellationToken& token,
+                     InferenceResult* result);
+
+    // Queue an inference and return immediately. Requests run on engine-owned
+    // worker threads, up to max_execution_contexts at a time. The callback,
+    // if any, runs on the worker thread just before the future becomes ready;
+    // poll the future with wait_for(0) or block on get(). A token makes the
+    // request cancellable as above, also while it is queued.
+    using CompletionCallback = std::function<void(const InferenceResult&)>;
+    std::future<InferenceResult> SubmitInference(std::vector<float> input,
+                                                 CompletionCallback callback = nullptr,
+                                                 std::shared_ptr<const CancellationToken> token = nullptr);
+
+    // Cancel every running and queued RunInference and SubmitInference
+    // request, with or without a token. Requests that start afterwards are
+    // unaffected.
+    void CancelAllInferences();
+
+    // Open a streaming session on the current model version (TFLite and
+    // ONNX). Each session owns an execution context outside the pool, so
+    // its state is never seen by other requests. Returns nullptr on failure.
+    std::unique_ptr<StreamingSession> CreateStreamingSession(
+        const StreamingConfig& config = StreamingConfig());
+
+    // Zero-copy tensor I/O: write inputs straight into the backend's buffers,
+    // call Invoke(), then read the outputs as borrowed views. These and the
+    // named-tensor calls below share one dedicated context and must be driven
+    // from a single thread.
+    // SetBatchSize resizes the leading input dimension for zero-copy batches;
+    // the single-sample RunInference overloads reset it to 1.
+    bool SetBatchSize(size_t batch_size);
+    bool GetInputBuffer(size_t index, TensorView* view);
+    bool GetOutputBuffer(size_t index, TensorView* view) const;
+    bool Invoke(InferenceMetrics* metrics = nullptr);
+    // An output view with its current shape and quantization, as taken by
+    // the post-processing in output_postprocessor.h
+    bool GetOutputTensor(size_t index, TensorView* view, TensorInfo* info) const;
+
+    // Named, typed tensor access. Names are the model's tensor names, or the
+    // signature's input/output names when a signature key is given. Types
+    // must match the tensor exactly; quantized tensors are not dequantized.
+    std::vector<std::string> GetSignatureKeys() const;
+    std::vector<TensorInfo> GetInputTensorInfo(const std::string& signature_key = "") const;
+    std::vector<TensorInfo> GetOutputTensorInfo(const std::string& signature_key = "") const;
+    bool GetInputBuffer(const std::string& name, TensorView* view,
+                       const std::string& signature_key = "");
+    bool GetOutputBuffer(const std::string& name, TensorView* view,
+                        const std::string& signature_key = "") const;
+    bool SetInput(const std::string& name, const void* data, size_t bytes, TensorType type,
+                 const std::string& signature_key = "");
+    bool GetOutput(const std::string& name, void* data, size_t bytes, TensorType type,
+                  const std::string& signature_key = "") const;
+    bool InvokeSignature(const std::string& signature_key, InferenceMetrics* metrics = nullptr);
+
+    // Run batch inference. Equal-sized samples are packed into one tensor and
+    // executed with a single Invoke when the backend can resize its batch
+    // dimension (TFLite, ONNX dynamic axis, PyTorch); otherwise falls back to
+    // one run per sample.
     bool RunBatchInference(const std::vector<std::vector<float>>& inputs,
                           std::vector<std::vector<float>>& outputs,
                           InferenceMetrics* metrics = nullptr);
 
+    // Cancellable batch. A packed batch stops as a whole, like the token
+    // overload of RunInference; per-sample runs each check the token.
+    bool RunBatchInference(const std::vector<std::vector<float>>& inputs,
+                          std::vector<std::vector<float>>& outputs,
+                          const CancellationToken& token,
+                          InferenceMetrics* metrics = nullptr);
+
     // Get model information
     std::string GetModelInfo() const;
+    ModelConfig GetModelConfig() const;
     std::vector<std::string> GetSupportedOperations() const;
-    std::vector<std::pair<size_t, size_t>> GetInputShapes() const;
-    std::vector<std::pair<size_t, size_t>> GetOutputShapes() const;
+    std::vector<std::vector<int64_t>> GetInputShapes() const;
+    std::vector<std::vector<int64_t>> GetOutputShapes() const;
+
+    // Resize the execution context pool of the loaded model. Idle contexts
+    // above num_contexts are released immediately; busy contexts above
+    // max_contexts are released when their request finishes.
+    void SetExecutionContextLimits(size_t num_contexts, size_t max_contexts);
+    size_t GetExecutionContextCount() const;
+    ResultCacheStats GetResultCacheStats() const;
+    // Always-on latency and failure counters across all inference calls
+    InferenceStats GetInferenceStats() const;
+    void ResetInferenceStats();
+    // Measured latency per backend ("accelerator", "cpu") under
+    // ModelConfig::adaptive_backend; empty when the model has one backend
+    std::vector<hardware::BackendStats> GetBackendStats() const;
+    // Ops of the current model version aggregated over the last complete
+    // window (ModelConfig::op_profile_window), most expensive first. ONNX
+    // Runtime profiles a session as a whole: the first call ends the ONNX
+    // profile and reports every run since load.
+    std::vector<OpProfileSummary> GetOpProfile() const;
+    void ResetOpProfile();
     
     // Performance and resource management
     void SetNumThreads(int num_threads);
     void EnableHardwareAcceleration(bool enable);
     void SetPowerProfile(hardware::HardwareAccelerator::PowerProfile profile);
+    // Caps the model's footprint: the context pool stops growing beyond
+    // num_execution_contexts once another context would exceed the limit
     void SetMemoryLimit(size_t memory_mb);
+
+    // Residency control, used by ResidencyManager. ShedArenas frees idle
+    // execution contexts but keeps the weights loaded; contexts are rebuilt
+    // on demand. UnloadModel drops the model but keeps the engine's settings
+    // and accelerator. Neither may race with the zero-copy/named tensor API.
+    MemoryFootprint GetMemoryFootprint() const;
+    // Layout chosen by ModelConfig::memory_plan for the current model
+    MemoryPlanStats GetMemoryPlanStats() const;
+    size_t ShedArenas();
+    void UnloadModel();
+    bool IsModelLoaded() const;
     
     // Error handling and callbacks
     using ErrorCallback = std::function<void(hardware::HardwareAccelerator::ErrorCode, const std::string&)>;
     void SetErrorCallback(ErrorCallback callback);
     hardware::HardwareAccelerator::ErrorCode GetLastError() const;
 
-    // Model optimization
+    // Model optimization. OptimizeModel writes an optimized copy of the
+    // loaded PyTorch or ONNX model; TFLite and custom models have none and
+    // fail with UNSUPPORTED_OPERATION.
     bool OptimizeModel(const std::string& output_path);
     bool QuantizeModel(const std::string& output_path, bool dynamic = false);
     
     // Resource management
     void ReleaseResources();
+
+    // Prepare the engine for traffic: fault in the weight pages, then run
+    // zeroed inputs (every input, whatever its type) through each retained
+    // execution context at every requested batch size and through every
+    // signature, until latency stops improving. This allocates the arenas
+    // and starts the backends' thread pools. The fixed-count overload runs
+    // exactly num_runs times per configuration.
+    WarmUpReport WarmUp(const WarmUpOptions& options);
     bool WarmUp(size_t num_runs = 3);
 
 private:
+    friend class StreamingSession;
     class Impl;
     std::unique_ptr<Impl> pImpl;
 };
@@ -0,0 +1,244 @@
+#include "op_profiler.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+
+namespace mobileai {
+namespace inference {
+
+using json = nlohmann::json;
+
+namespace {
+
+// Delegate kernels run on the device of the delegate that claimed them
+std::string DeviceOf(const TfLiteRegistration* registration) {
+    if (registration->builtin_code != kTfLiteBuiltinDelegate) {
+        return "cpu";
+    }
+    const std::string delegate = registration->custom_name ? registration->custom_name : "";
+    if (delegate.find("XNNPack") != std::string::npos) {
+        return "xnnpack";
+    }
+    return delegate.empty() ? "delegate" : delegate;
+}
+
+// ORT writes sizes as strings in some versions and numbers in others
+size_t SizeArg(const json& args, const char* key) {
+    auto it = args.find(key);
+    if (it == args.end()) {
+        return 0;
+    }
+    if (it->is_number_unsigned()) {
+        return it->get<size_t>();
+    }
+    if (it->is_string()) {
+        try {
+            return static_cast<size_t>(std::stoull(it->get<std::string>()));
+        } catch (const std::exception&) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+// "CPUExecutionProvider" -> "cpu"
+std::string DeviceOf(const std::string& provider) {
+    std::string device = provider;
+    const std::string suffix = "ExecutionProvider";
+    if (device.size() > suffix.size() &&
+        device.compare(device.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        device.resize(device.size() - suffix.size());
+    }
+    std::transform(device.begin(), device.end(), device.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return device.empty() ? "cpu" : device;
+}
+
+} // namespace
+
+TFLiteOpProfiler::TFLiteOpProfiler(tflite::Interpreter* interpreter)
+    : interpreter_(interpreter) {
+    auto profiler = std::make_unique<tflite::profiling::BufferedProfiler>(
+        1024, true /*allow_dynamic_buffer_increase*/);
+    profiler_ = profiler.get();
+    interpreter_->AddProfiler(std::move(profiler));
+}
+
+void TFLiteOpProfiler::Start() {
+    profiler_->Reset();
+    profiler_->StartProfiling();
+}
+
+void TFLiteOpProfiler::Stop(std::vector<OpProfile>* ops) {
+    profiler_->StopProfiling();
+    ops->clear();
+    for (const auto* event : profiler_->GetProfileEvents()) {
+        if (event->event_type != tflite::Profiler::EventType::OPERATOR_INVOKE_EVENT) {
+            continue;
+        }
+        auto* subgraph = interpreter_->subgraph(static_cast<int>(event->extra_event_metadata));
+        const auto* node_and_registration =
+            subgraph ? subgraph->node_and_registration(static_cast<int>(event->event_metadata))
+                     : nullptr;
+        if (!node_and_registration) {
+            continue;
+        }
+        const TfLiteNode& node = node_and_registration->first;
+
+        OpProfile op;
+        op.node_index = static_cast<int>(event->event_metadata);
+        op.type = event->tag;
+        op.device = DeviceOf(&node_and_registration->second);
+        op.duration_ms = event->elapsed_time / 1000.0f;
+        op.arena_bytes = ArenaBytes(subgraph, node);
+        if (node.outputs->size > 0 && node.outputs->data[0] >= 0) {
+            const TfLiteTensor* output = subgraph->tensor(node.outputs->data[0]);
+            op.name = output && output->name ? output->name : "";
+        }
+        if (op.name.empty()) {
+            op.name = "node_" + std::to_string(op.node_index);
+        }
+        ops->push_back(std::move(op));
+    }
+}
+
+// Activations the node reads and writes; weights live in the model mapping
+size_t TFLiteOpProfiler::ArenaBytes(tflite::Subgraph* subgraph, const TfLiteNode& node) const {
+    size_t bytes = 0;
+    for (const TfLiteIntArray* tensors : {node.inputs, node.outputs}) {
+        for (int i = 0; i < tensors->size; i++) {
+            if (tensors->data[i] < 0) {
+                continue;
+            }
+            const TfLiteTensor* tensor = subgraph->tensor(tensors->data[i]);
+            if (tensor && (tensor->allocation_type == kTfLiteArenaRw ||
+                           tensor->allocation_type == kTfLiteArenaRwPersistent ||
+                           tensor->allocation_type == kTfLiteDynamic)) {
+                bytes += tensor->bytes;
+            }
+        }
+    }
+    return bytes;
+}
+
+bool ParseONNXProfile(const std::string& path, std::vector<std::vector<OpProfile>>* runs) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    json trace;
+    try {
+        file >> trace;
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (!trace.is_array()) {
+        return false;
+    }
+
+    struct Span {
+        uint64_t begin;
+        uint64_t end;
+    };
+    std::vector<Span> run_spans;
+    std::vector<std::pair<uint64_t, OpProfile>> node_events;
+
+    const std::string kernel_suffix = "_kernel_time";
+    for (const auto& event : trace) {
+        const std::string category = event.value("cat", "");
+        const std::string name = event.value("name", "");
+        const uint64_t begin = event.value("ts", uint64_t(0));
+        const uint64_t duration = event.value("dur", uint64_t(0));
+
+        if (category == "Session" && name == "model_run") {
+            run_spans.push_back({begin, begin + duration});
+        } else if (category == "Node" && name.size() > kernel_suffix.size() &&
+                   name.compare(name.size() - kernel_suffix.size(), kernel_suffix.size(),
+                                kernel_suffix) == 0) {
+            const json args = event.value("args", json::object());
+            OpProfile op;
+            op.name = name.substr(0, name.size() - kernel_suffix.size());
+            op.type = args.value("op_name", "");
+            op.device = DeviceOf(args.value("provider", ""));
+            op.duration_ms = duration / 1000.0f;
+            op.arena_bytes = SizeArg(args, "activation_size") + SizeArg(args, "output_size");
+            node_events.emplace_back(begin, std::move(op));
+        }
+    }
+
+    runs->assign(run_spans.size(), std::vector<OpProfile>());
+    for (auto& event : node_events) {
+        for (size_t i = 0; i < run_spans.size(); i++) {
+            if (event.first >= run_spans[i].begin && event.first <= run_spans[i].end) {
+                (*runs)[i].push_back(std::move(event.second));
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+OpProfileWindow::OpProfileWindow(size_t window_requests)
+    : window_requests_(std::max<size_t>(window_requests, 1)) {}
+
+void OpProfileWindow::Add(const std::vector<OpProfile>& ops) {
+    if (ops.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& op : ops) {
+        Accumulator& accumulator = current_[Key(op.node_index, op.name, op.device)];
+        if (accumulator.runs == 0) {
+            accumulator.op = op;
+        }
+        accumulator.runs++;
+        accumulator.total_ms += op.duration_ms;
+        accumulator.max_ms = std::max(accumulator.max_ms, op.duration_ms);
+        accumulator.op.arena_bytes = std::max(accumulator.op.arena_bytes, op.arena_bytes);
+    }
+
+    if (++requests_ >= window_requests_) {
+        completed_ = std::move(current_);
+        current_.clear();
+        requests_ = 0;
+    }
+}
+
+std::vector<OpProfileSummary> OpProfileWindow::GetSummary() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Window& window = completed_.empty() ? current_ : completed_;
+
+    double window_ms = 0.0;
+    for (const auto& entry : window) {
+        window_ms += entry.second.total_ms;
+    }
+
+    std::vector<OpProfileSummary> summary;
+    summary.reserve(window.size());
+    for (const auto& entry : window) {
+        const Accumulator& accumulator = entry.second;
+        OpProfileSummary op;
+        op.op = accumulator.op;
+        op.op.duration_ms = static_cast<float>(accumulator.total_ms / accumulator.runs);
+        op.runs = accumulator.runs;
+        op.max_ms = accumulator.max_ms;
+        op.share = window_ms > 0.0 ? static_cast<float>(accumulator.total_ms / window_ms) : 0.0f;
+        summary.push_back(std::move(op));
+    }
+    std::sort(summary.begin(), summary.end(),
+              [](const OpProfileSummary& a, const OpProfileSummary& b) { return a.share > b.share; });
+    return summary;
+}
+
+void OpProfileWindow::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_.clear();
+    completed_.clear();
+    requests_ = 0;
+}
+
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "model_engine.h"
+#include <tensorflow/lite/interpreter.h>
+#include <tensorflow/lite/profiling/buffered_profiler.h>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace mobileai {
+namespace inference {
+
+// Per-op profile of each Invoke of one interpreter, recorded by a buffered
+// profiler installed under the interpreter's root profiler. Only the
+// interpreter's own nodes are reported; a delegate kernel is one op, on the
+// delegate's device.
+class TFLiteOpProfiler {
+public:
+    explicit TFLiteOpProfiler(tflite::Interpreter* interpreter);
+
+    void Start();
+    // ops receives one entry per node executed since Start
+    void Stop(std::vector<OpProfile>* ops);
+
+private:
+    size_t ArenaBytes(tflite::Subgraph* subgraph, const TfLiteNode& node) const;
+
+    tflite::Interpreter* interpreter_;
+    tflite::profiling::BufferedProfiler* profiler_;   // Owned by the interpreter
+};
+
+// Reads the trace ONNX Runtime writes when session profiling ends. ORT
+// profiles a session as a whole rather than per run; node events are
+// grouped into runs by the model_run spans that contain them.
+bool ParseONNXProfile(const std::string& path, std::vector<std::vector<OpProfile>>* runs);
+
+// Aggregates per-request op profiles over tumbling windows of
+// window_requests requests. The summary is the last complete window, or the
+// current one until a window has completed. Thread-safe.
+class OpProfileWindow {
+public:
+    explicit OpProfileWindow(size_t window_requests);
+
+    void Add(const std::vector<OpProfile>& ops);
+
+    // Most expensive ops first, by total time in the window
+    std::vector<OpProfileSummary> GetSummary() const;
+    void Reset();
+
+private:
+    struct Accumulator {
+        OpProfile op;
+        uint64_t runs = 0;
+        double total_ms = 0.0;
+        float max_ms = 0.0f;
+    };
+    using Key = std::tuple<int, std::string, std::string>;   // Node index, name, device
+    using Window = std::map<Key, Accumulator>;
+
+    size_t window_requests_;
+    mutable std::mutex mutex_;
+    Window current_;
+    Window completed_;
+    size_t requests_ = 0;
+};
+
+} // namespace inference
+} // namespace mobileai
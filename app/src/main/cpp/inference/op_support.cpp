@@ -0,0 +1,44 @@
+#include "op_support.h"
+#include <tensorflow/lite/schema/schema_generated.h>
+#include <tensorflow/lite/schema/schema_utils.h>
+#include <string>
+#include <unordered_map>
+
+namespace mobileai {
+namespace inference {
+
+OpSupportSummary AnalyzeOpSupport(const tflite::FlatBufferModel& model,
+                                  const hardware::HardwareAccelerator& accelerator) {
+    OpSupportSummary summary;
+    const tflite::Model* schema = model.GetModel();
+    if (!schema || !schema->subgraphs() || schema->subgraphs()->size() == 0 ||
+        !schema->operator_codes()) {
+        return summary;
+    }
+
+    const auto* operators = schema->subgraphs()->Get(0)->operators();
+    if (!operators) {
+        return summary;
+    }
+    std::unordered_map<std::string, bool> op_support;
+    for (const auto* op : *operators) {
+        const auto* code = schema->operator_codes()->Get(op->opcode_index());
+        tflite::BuiltinOperator builtin = tflite::GetBuiltinCode(code);
+        std::string name = builtin == tflite::BuiltinOperator_CUSTOM
+            ? (code->custom_code() ? code->custom_code()->str() : "")
+            : tflite::EnumNameBuiltinOperator(builtin);
+
+        auto it = op_support.find(name);
+        if (it == op_support.end()) {
+            it = op_support.emplace(name, accelerator.SupportsOperation(name)).first;
+        }
+        summary.total_ops++;
+        if (it->second) {
+            summary.supported_ops++;
+        }
+    }
+    return summary;
+}
+
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../hardware/hardware_accelerator.h"
+#include <tensorflow/lite/model.h>
+#include <cstddef>
+
+namespace mobileai {
+namespace inference {
+
+struct OpSupportSummary {
+    size_t total_ops = 0;
+    size_t supported_ops = 0;   // Per HardwareAccelerator::SupportsOperation
+};
+
+// Op support in the model's main subgraph; the accelerator is asked about
+// each op name once
+OpSupportSummary AnalyzeOpSupport(const tflite::FlatBufferModel& model,
+                                  const hardware::HardwareAccelerator& accelerator);
+
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,550 @@
+#include "output_postprocessor.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace mobileai {
+namespace inference {
+
+namespace {
+
+// Calls visit with a null pointer of the tensor's element type
+template <typename Visitor>
+bool VisitElementType(TensorType type, Visitor&& visit) {
+    switch (type) {
+        case TensorType::FLOAT32: visit(static_cast<const float*>(nullptr)); return true;
+        case TensorType::UINT8:   visit(static_cast<const uint8_t*>(nullptr)); return true;
+        case TensorType::INT8:    visit(static_cast<const int8_t*>(nullptr)); return true;
+        default:                  return false;
+    }
+}
+
+template <typename Tag>
+using ElementOf = std::remove_const_t<std::remove_pointer_t<Tag>>;
+
+QuantizationParams Params(const TensorInfo& info) {
+    return info.type == TensorType::FLOAT32 ? QuantizationParams() : info.quantization;
+}
+
+float Dequantize(float value, const QuantizationParams& q) {
+    return q.scale > 0.0f ? q.scale * (value - q.zero_point) : value;
+}
+
+float Sigmoid(float x) {
+    return 1.0f / (1.0f + std::exp(-x));
+}
+
+// ---- Float kernels. exp() is a Cephes-style polynomial, valid for the
+// non-positive arguments softmax produces once the max is subtracted.
+
+#if defined(__ARM_NEON)
+float32x4_t Exp4(float32x4_t x) {
+    x = vmaxq_f32(vminq_f32(x, vdupq_n_f32(0.0f)), vdupq_n_f32(-87.0f));
+    // Truncation rounds toward zero, so x * log2(e) - 0.5 truncates to the nearest integer
+    int32x4_t n = vcvtq_s32_f32(vsubq_f32(vmulq_f32(x, vdupq_n_f32(1.44269504f)), vdupq_n_f32(0.5f)));
+    float32x4_t nf = vcvtq_f32_s32(n);
+    float32x4_t r = vmlsq_f32(x, nf, vdupq_n_f32(0.693359375f));
+    r = vmlsq_f32(r, nf, vdupq_n_f32(-2.12194440e-4f));
+
+    float32x4_t p = vdupq_n_f32(1.9875691500e-4f);
+    p = vmlaq_f32(vdupq_n_f32(1.3981999507e-3f), p, r);
+    p = vmlaq_f32(vdupq_n_f32(8.3334519073e-3f), p, r);
+    p = vmlaq_f32(vdupq_n_f32(4.1665795894e-2f), p, r);
+    p = vmlaq_f32(vdupq_n_f32(1.6666665459e-1f), p, r);
+    p = vmlaq_f32(vdupq_n_f32(5.0000001201e-1f), p, r);
+    p = vmlaq_f32(vaddq_f32(r, vdupq_n_f32(1.0f)), vmulq_f32(p, r), r);
+
+    int32x4_t bits = vshlq_n_s32(vaddq_s32(n, vdupq_n_s32(127)), 23);
+    return vmulq_f32(p, vreinterpretq_f32_s32(bits));
+}
+
+float HorizontalSum(float32x4_t v) {
+    float32x2_t pair = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(pair, pair), 0);
+}
+
+float HorizontalMax(float32x4_t v) {
+    float32x2_t pair = vmax_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpmax_f32(pair, pair), 0);
+}
+#elif defined(__SSE2__)
+__m128 Exp4(__m128 x) {
+    x = _mm_max_ps(_mm_min_ps(x, _mm_setzero_ps()), _mm_set1_ps(-87.0f));
+    __m128i n = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(1.44269504f)));
+    __m128 nf = _mm_cvtepi32_ps(n);
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(nf, _mm_set1_ps(0.693359375f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(nf, _mm_set1_ps(-2.12194440e-4f)));
+
+    __m128 p = _mm_set1_ps(1.9875691500e-4f);
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.3981999507e-3f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(8.3334519073e-3f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(4.1665795894e-2f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(1.6666665459e-1f));
+    p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(5.0000001201e-1f));
+    p = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(p, r), r), _mm_add_ps(r, _mm_set1_ps(1.0f)));
+
+    __m128i bits = _mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(p, _mm_castsi128_ps(bits));
+}
+
+float HorizontalSum(__m128 v) {
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, v);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+float HorizontalMax(__m128 v) {
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, v);
+    return std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+}
+#endif
+
+float MaxValue(const float* values, size_t count) {
+    float max = -std::numeric_limits<float>::infinity();
+    size_t i = 0;
+#if defined(__ARM_NEON)
+    if (count >= 4) {
+        float32x4_t acc = vld1q_f32(values);
+        for (i = 4; i + 4 <= count; i += 4) {
+            acc = vmaxq_f32(acc, vld1q_f32(values + i));
+        }
+        max = HorizontalMax(acc);
+    }
+#elif defined(__SSE2__)
+    if (count >= 4) {
+        __m128 acc = _mm_loadu_ps(values);
+        for (i = 4; i + 4 <= count; i += 4) {
+            acc = _mm_max_ps(acc, _mm_loadu_ps(values + i));
+        }
+        max = HorizontalMax(acc);
+    }
+#endif
+    for (; i < count; i++) {
+        max = std::max(max, values[i]);
+    }
+    return max;
+}
+
+// Sum of exp(value - shift); each term is also stored to out when given
+float ExpSum(const float* values, float* out, size_t count, float shift) {
+    float sum = 0.0f;
+    size_t i = 0;
+#if defined(__ARM_NEON)
+    const float32x4_t s = vdupq_n_f32(shift);
+    float32x4_t acc = vdupq_n_f32(0.0f);
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t e = Exp4(vsubq_f32(vld1q_f32(values + i), s));
+        if (out) {
+            vst1q_f32(out + i, e);
+        }
+        acc = vaddq_f32(acc, e);
+    }
+    sum = HorizontalSum(acc);
+#elif defined(__SSE2__)
+    const __m128 s = _mm_set1_ps(shift);
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        __m128 e = Exp4(_mm_sub_ps(_mm_loadu_ps(values + i), s));
+        if (out) {
+            _mm_storeu_ps(out + i, e);
+        }
+        acc = _mm_add_ps(acc, e);
+    }
+    sum = HorizontalSum(acc);
+#endif
+    for (; i < count; i++) {
+        float e = std::exp(values[i] - shift);
+        if (out) {
+            out[i] = e;
+        }
+        sum += e;
+    }
+    return sum;
+}
+
+void ScaleValues(float* values, size_t count, float scale) {
+    size_t i = 0;
+#if defined(__ARM_NEON)
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(values + i, vmulq_n_f32(vld1q_f32(values + i), scale));
+    }
+#elif defined(__SSE2__)
+    const __m128 s = _mm_set1_ps(scale);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(values + i, _mm_mul_ps(_mm_loadu_ps(values + i), s));
+    }
+#endif
+    for (; i < count; i++) {
+        values[i] *= scale;
+    }
+}
+
+// best/label track the running maximum per pixel; label holds class indices as floats
+void UpdateArgmax(const float* plane, float* best, float* label, float class_id, size_t count) {
+    size_t i = 0;
+#if defined(__ARM_NEON)
+    const float32x4_t c = vdupq_n_f32(class_id);
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t p = vld1q_f32(plane + i);
+        float32x4_t b = vld1q_f32(best + i);
+        uint32x4_t greater = vcgtq_f32(p, b);
+        vst1q_f32(best + i, vbslq_f32(greater, p, b));
+        vst1q_f32(label + i, vbslq_f32(greater, c, vld1q_f32(label + i)));
+    }
+#elif defined(__SSE2__)
+    const __m128 c = _mm_set1_ps(class_id);
+    for (; i + 4 <= count; i += 4) {
+        __m128 p = _mm_loadu_ps(plane + i);
+        __m128 b = _mm_loadu_ps(best + i);
+        __m128 greater = _mm_cmpgt_ps(p, b);
+        _mm_storeu_ps(best + i, _mm_or_ps(_mm_and_ps(greater, p), _mm_andnot_ps(greater, b)));
+        __m128 l = _mm_loadu_ps(label + i);
+        _mm_storeu_ps(label + i, _mm_or_ps(_mm_and_ps(greater, c), _mm_andnot_ps(greater, l)));
+    }
+#endif
+    for (; i < count; i++) {
+        if (plane[i] > best[i]) {
+            best[i] = plane[i];
+            label[i] = class_id;
+        }
+    }
+}
+
+// ---- Top-k
+
+// Min-heap of the k best entries so far, worst at the front; ties keep the
+// lower index
+template <typename T>
+void SelectTopK(const T* values, size_t count, size_t k, std::vector<std::pair<T, int>>* heap) {
+    auto better = [](const std::pair<T, int>& a, const std::pair<T, int>& b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    };
+    heap->clear();
+    heap->reserve(k);
+    for (size_t i = 0; i < count; i++) {
+        if (heap->size() < k) {
+            heap->emplace_back(values[i], static_cast<int>(i));
+            std::push_heap(heap->begin(), heap->end(), better);
+        } else if (values[i] > heap->front().first) {
+            std::pop_heap(heap->begin(), heap->end(), better);
+            heap->back() = {values[i], static_cast<int>(i)};
+            std::push_heap(heap->begin(), heap->end(), better);
+        }
+    }
+    std::sort_heap(heap->begin(), heap->end(), better);
+}
+
+// Softmax denominator relative to the max entry
+float SumExp(const float* values, size_t count, float max, const QuantizationParams&) {
+    return ExpSum(values, nullptr, count, max);
+}
+
+// 8-bit entries take at most 256 distinct values: count them, then evaluate
+// exp once per value
+template <typename T>
+float SumExp(const T* values, size_t count, T max, const QuantizationParams& q) {
+    uint32_t histogram[256] = {};
+    for (size_t i = 0; i < count; i++) {
+        histogram[static_cast<uint8_t>(values[i])]++;
+    }
+    const float scale = q.scale > 0.0f ? q.scale : 1.0f;
+    float sum = 0.0f;
+    for (int i = 0; i < 256; i++) {
+        if (histogram[i]) {
+            const T raw = static_cast<T>(static_cast<uint8_t>(i));
+            sum += histogram[i] * std::exp(scale * (static_cast<float>(raw) - max));
+        }
+    }
+    return sum;
+}
+
+// ---- Segmentation
+
+template <typename T>
+void ArgmaxPlanes(const T* planes, size_t pixels, size_t classes, uint8_t* labels) {
+    thread_local std::vector<T> best;
+    best.assign(planes, planes + pixels);
+    std::fill(labels, labels + pixels, 0);
+    for (size_t c = 1; c < classes; c++) {
+        const T* plane = planes + c * pixels;
+        for (size_t i = 0; i < pixels; i++) {
+            if (plane[i] > best[i]) {
+                best[i] = plane[i];
+                labels[i] = static_cast<uint8_t>(c);
+            }
+        }
+    }
+}
+
+void ArgmaxPlanes(const float* planes, size_t pixels, size_t classes, uint8_t* labels) {
+    thread_local std::vector<float> best;
+    thread_local std::vector<float> label;
+    best.assign(planes, planes + pixels);
+    label.assign(pixels, 0.0f);
+    for (size_t c = 1; c < classes; c++) {
+        UpdateArgmax(planes + c * pixels, best.data(), label.data(), static_cast<float>(c), pixels);
+    }
+    for (size_t i = 0; i < pixels; i++) {
+        labels[i] = static_cast<uint8_t>(label[i]);
+    }
+}
+
+// ---- Detection
+
+struct Candidate {
+    size_t row;
+    int class_id;
+    float score;
+};
+
+// A real-valued score threshold in a tensor's raw domain, so entries can be
+// rejected before they are dequantized
+float RawThreshold(float threshold, bool logits, const QuantizationParams& q) {
+    if (logits) {
+        if (threshold <= 0.0f) {
+            return -std::numeric_limits<float>::infinity();
+        }
+        if (threshold >= 1.0f) {
+            return std::numeric_limits<float>::infinity();
+        }
+        threshold = std::log(threshold / (1.0f - threshold));
+    }
+    return q.scale > 0.0f ? threshold / q.scale + q.zero_point : threshold;
+}
+
+float ReadValue(const TensorView& view, TensorType type, const QuantizationParams& q, size_t index) {
+    switch (type) {
+        case TensorType::UINT8: return Dequantize(static_cast<const uint8_t*>(view.data)[index], q);
+        case TensorType::INT8:  return Dequantize(static_cast<const int8_t*>(view.data)[index], q);
+        default:                return static_cast<const float*>(view.data)[index];
+    }
+}
+
+float Area(const Detection& box) {
+    return std::max(box.xmax - box.xmin, 0.0f) * std::max(box.ymax - box.ymin, 0.0f);
+}
+
+float IoU(const Detection& a, const Detection& b) {
+    const float width = std::min(a.xmax, b.xmax) - std::max(a.xmin, b.xmin);
+    const float height = std::min(a.ymax, b.ymax) - std::max(a.ymin, b.ymin);
+    if (width <= 0.0f || height <= 0.0f) {
+        return 0.0f;
+    }
+    const float intersection = width * height;
+    const float combined = Area(a) + Area(b) - intersection;
+    return combined > 0.0f ? intersection / combined : 0.0f;
+}
+
+// Last dimension of a tensor and the number of rows of that length
+bool Rows(const TensorView& view, const TensorInfo& info, size_t* columns, size_t* rows) {
+    const size_t element_size = TensorTypeSize(info.type);
+    if (!view.data || info.shape.empty() || info.shape.back() <= 0 || element_size == 0) {
+        return false;
+    }
+    *columns = static_cast<size_t>(info.shape.back());
+    *rows = view.bytes / element_size / *columns;
+    return true;
+}
+
+} // namespace
+
+bool TopK(const TensorView& view, const TensorInfo& info, size_t k, bool softmax,
+          std::vector<Classification>* results) {
+    if (!results || !view.data) {
+        return false;
+    }
+    results->clear();
+    const QuantizationParams q = Params(info);
+
+    return VisitElementType(info.type, [&](auto tag) {
+        using T = ElementOf<decltype(tag)>;
+        const T* values = static_cast<const T*>(view.data);
+        const size_t count = view.bytes / sizeof(T);
+
+        std::vector<std::pair<T, int>> heap;
+        SelectTopK(values, count, std::min(k, count), &heap);
+        if (heap.empty()) {
+            return;
+        }
+
+        // The best entry is also the max the softmax is taken relative to
+        const float max = Dequantize(heap.front().first, q);
+        const float denominator = softmax ? SumExp(values, count, heap.front().first, q) : 1.0f;
+        results->reserve(heap.size());
+        for (const auto& entry : heap) {
+            const float value = Dequantize(entry.first, q);
+            results->push_back({entry.second, softmax ? std::exp(value - max) / denominator : value});
+        }
+    });
+}
+
+void Softmax(Span<const float> logits, Span<float> probabilities) {
+    const size_t count = std::min(logits.size(), probabilities.size());
+    if (count == 0) {
+        return;
+    }
+    const float max = MaxValue(logits.data(), count);
+    const float sum = ExpSum(logits.data(), probabilities.data(), count, max);
+    ScaleValues(probabilities.data(), count, 1.0f / sum);
+}
+
+bool ArgmaxMap(const TensorView& view, const TensorInfo& info, TensorLayout layout,
+               SegmentationMap* map) {
+    if (!map || !view.data || info.shape.size() != 4 || info.shape[0] != 1) {
+        return false;
+    }
+    const bool nchw = layout == TensorLayout::NCHW;
+    const int64_t classes = nchw ? info.shape[1] : info.shape[3];
+    const int64_t height = nchw ? info.shape[2] : info.shape[1];
+    const int64_t width = nchw ? info.shape[3] : info.shape[2];
+    if (classes < 1 || classes > 256 || height < 1 || width < 1) {
+        return false;
+    }
+    const size_t pixels = static_cast<size_t>(height * width);
+    if (view.bytes < pixels * classes * TensorTypeSize(info.type)) {
+        return false;
+    }
+
+    map->width = static_cast<int>(width);
+    map->height = static_cast<int>(height);
+    map->labels.resize(pixels);
+    uint8_t* labels = map->labels.data();
+
+    return VisitElementType(info.type, [&](auto tag) {
+        using T = ElementOf<decltype(tag)>;
+        const T* values = static_cast<const T*>(view.data);
+        if (nchw) {
+            ArgmaxPlanes(values, pixels, static_cast<size_t>(classes), labels);
+            return;
+        }
+        for (size_t p = 0; p < pixels; p++) {
+            const T* scores = values + p * classes;
+            int64_t best = 0;
+            for (int64_t c = 1; c < classes; c++) {
+                if (scores[c] > scores[best]) {
+                    best = c;
+                }
+            }
+            labels[p] = static_cast<uint8_t>(best);
+        }
+    });
+}
+
+bool DecodeDetections(const TensorView& boxes, const TensorInfo& box_info,
+                      const TensorView& scores, const TensorInfo& score_info,
+                      const DetectionSpec& spec, std::vector<Detection>* detections) {
+    if (!detections) {
+        return false;
+    }
+    detections->clear();
+
+    size_t box_columns = 0, box_rows = 0, score_columns = 0, score_rows = 0;
+    if (!Rows(boxes, box_info, &box_columns, &box_rows) ||
+        !Rows(scores, score_info, &score_columns, &score_rows) ||
+        box_columns < 4 || box_rows != score_rows || score_columns <= spec.score_offset ||
+        (spec.objectness && spec.score_offset == 0) ||
+        (!spec.anchors.empty() && spec.anchors.size() != box_rows) ||
+        !VisitElementType(box_info.type, [](auto) {})) {
+        return false;
+    }
+    const size_t num_classes = score_columns - spec.score_offset;
+    const QuantizationParams box_q = Params(box_info);
+    const QuantizationParams score_q = Params(score_info);
+    const float raw_threshold = RawThreshold(spec.score_threshold, spec.sigmoid, score_q);
+
+    // Threshold on raw scores; a row whose objectness fails is skipped whole
+    std::vector<Candidate> candidates;
+    auto probability = [&](float raw) {
+        const float value = Dequantize(raw, score_q);
+        return spec.sigmoid ? Sigmoid(value) : value;
+    };
+    bool supported = VisitElementType(score_info.type, [&](auto tag) {
+        using T = ElementOf<decltype(tag)>;
+        const T* values = static_cast<const T*>(scores.data);
+        for (size_t row = 0; row < score_rows; row++) {
+            const T* entries = values + row * score_columns;
+            float objectness = 1.0f;
+            if (spec.objectness) {
+                if (static_cast<float>(entries[spec.score_offset - 1]) < raw_threshold) {
+                    continue;
+                }
+                objectness = probability(entries[spec.score_offset - 1]);
+            }
+            const T* class_scores = entries + spec.score_offset;
+            for (size_t c = 0; c < num_classes; c++) {
+                if (static_cast<float>(class_scores[c]) < raw_threshold) {
+                    continue;
+                }
+                const float score = objectness * probability(class_scores[c]);
+                if (score >= spec.score_threshold) {
+                    candidates.push_back({row, static_cast<int>(c), score});
+                }
+            }
+        }
+    });
+    if (!supported) {
+        return false;
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+
+    // Greedy NMS; boxes are only decoded for candidates that get this far
+    for (const Candidate& candidate : candidates) {
+        if (detections->size() >= spec.max_detections) {
+            break;
+        }
+        float v[4];
+        for (size_t i = 0; i < 4; i++) {
+            v[i] = ReadValue(boxes, box_info.type, box_q, candidate.row * box_columns + i);
+        }
+
+        Detection box;
+        if (spec.encoding == BoxEncoding::CORNERS) {
+            box.xmin = v[0];
+            box.ymin = v[1];
+            box.xmax = v[2];
+            box.ymax = v[3];
+        } else {
+            float cx = v[0], cy = v[1], w = v[2], h = v[3];
+            if (!spec.anchors.empty()) {
+                const Anchor& anchor = spec.anchors[candidate.row];
+                cx = anchor.cx + v[0] / spec.anchor_scale[0] * anchor.width;
+                cy = anchor.cy + v[1] / spec.anchor_scale[1] * anchor.height;
+                w = anchor.width * std::exp(v[2] / spec.anchor_scale[2]);
+                h = anchor.height * std::exp(v[3] / spec.anchor_scale[3]);
+            }
+            box.xmin = cx - w / 2.0f;
+            box.ymin = cy - h / 2.0f;
+            box.xmax = cx + w / 2.0f;
+            box.ymax = cy + h / 2.0f;
+        }
+        box.score = candidate.score;
+        box.class_id = candidate.class_id;
+
+        bool suppressed = false;
+        for (const Detection& kept : *detections) {
+            if ((spec.class_agnostic || kept.class_id == box.class_id) &&
+                IoU(kept, box) > spec.iou_threshold) {
+                suppressed = true;
+                break;
+            }
+        }
+        if (!suppressed) {
+            detections->push_back(box);
+        }
+    }
+    return true;
+}
+
+} // namespace inference
+} // namespace mobileai
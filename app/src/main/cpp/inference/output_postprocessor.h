@@ -0,0 +1,89 @@
+#pragma once
+
+#include "image_preprocessor.h"
+#include "tensor_view.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mobileai {
+namespace inference {
+
+// Post-processing that reads model outputs in place, typically views from
+// ModelEngine::GetOutputTensor. Tensors are FLOAT32, or UINT8/INT8 with their
+// quantization parameters (a zero scale means raw values); quantized values
+// are compared in their integer domain and only dequantized for the entries
+// a result actually returns. Stateless and thread-safe; false means an
+// unsupported type or shape.
+
+struct Classification {
+    int index = 0;
+    float score = 0.0f;
+};
+
+// The k largest entries of a logits or score vector ([N] or [1, N]), best
+// first, in one pass with a k-entry heap. With softmax the scores are
+// probabilities over all N entries; otherwise the entries' own values.
+bool TopK(const TensorView& view, const TensorInfo& info, size_t k, bool softmax,
+          std::vector<Classification>* results);
+
+// Numerically stable softmax; logits and probabilities may be the same buffer
+void Softmax(Span<const float> logits, Span<float> probabilities);
+
+struct SegmentationMap {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> labels;   // Row-major class index per pixel
+};
+
+// Per-pixel argmax over the class axis of a [1,H,W,C] or [1,C,H,W] score
+// map with at most 256 classes
+bool ArgmaxMap(const TensorView& view, const TensorInfo& info, TensorLayout layout,
+               SegmentationMap* map);
+
+enum class BoxEncoding {
+    CENTER_SIZE,   // cx, cy, w, h
+    CORNERS        // xmin, ymin, xmax, ymax
+};
+
+struct Anchor {
+    float cx = 0.0f;
+    float cy = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+};
+
+// Box rows are the first four values of each row of the box tensor; class
+// scores start at score_offset in each row of the score tensor. Both may be
+// the same tensor (e.g. YOLO rows of box, objectness, classes).
+struct DetectionSpec {
+    BoxEncoding encoding = BoxEncoding::CENTER_SIZE;
+    std::vector<Anchor> anchors;           // SSD: CENTER_SIZE values are offsets from one anchor per row
+    float anchor_scale[4] = {10.0f, 10.0f, 5.0f, 5.0f};   // Divisors of the cx, cy, w, h offsets
+    size_t score_offset = 0;
+    bool objectness = false;               // Column score_offset - 1 scales every class score
+    bool sigmoid = false;                  // Scores and objectness are logits
+    float score_threshold = 0.5f;
+    float iou_threshold = 0.45f;
+    size_t max_detections = 100;
+    bool class_agnostic = false;           // Boxes of different classes suppress each other
+};
+
+struct Detection {
+    float xmin = 0.0f;
+    float ymin = 0.0f;
+    float xmax = 0.0f;
+    float ymax = 0.0f;
+    float score = 0.0f;
+    int class_id = 0;
+};
+
+// Threshold, decode and greedy non-max suppression, best first. Rows below
+// the threshold are rejected on their raw values; only surviving rows are
+// dequantized and decoded.
+bool DecodeDetections(const TensorView& boxes, const TensorInfo& box_info,
+                      const TensorView& scores, const TensorInfo& score_info,
+                      const DetectionSpec& spec, std::vector<Detection>* detections);
+
+} // namespace inference
+} // namespace mobileai
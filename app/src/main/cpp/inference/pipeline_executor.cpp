@@ -0,0 +1,330 @@
+#include "pipeline_executor.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace mobileai {
+namespace inference {
+
+class PipelineExecutor::Impl {
+public:
+    Impl(std::vector<PipelineStage> stages, const PipelineConfig& config)
+        : config_(config) {
+        for (auto& stage : stages) {
+            auto state = std::make_unique<Stage>();
+            state->name = std::move(stage.name);
+            state->engine = std::move(stage.engine);
+            stages_.push_back(std::move(state));
+        }
+    }
+
+    ~Impl() {
+        Stop();
+    }
+
+    bool Start() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) return true;
+        if (stages_.empty()) return false;
+        for (const auto& stage : stages_) {
+            if (!stage->engine) return false;
+        }
+
+        // The last stage writes straight into the frame's result
+        const size_t buffer_count = std::max<size_t>(config_.buffers_per_stage, 1);
+        for (size_t i = 0; i + 1 < stages_.size(); i++) {
+            Stage& stage = *stages_[i];
+            stage.buffers.assign(buffer_count, std::vector<float>());
+            stage.free_buffers.clear();
+            for (size_t b = 0; b < buffer_count; b++) {
+                stage.free_buffers.push_back(b);
+            }
+        }
+
+        ResetStatsLocked();
+        running_ = true;
+        for (size_t i = 0; i < stages_.size(); i++) {
+            stages_[i]->thread = std::thread(&Impl::StageLoop, this, i);
+        }
+        return true;
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) return;
+            running_ = false;
+        }
+        for (auto& stage : stages_) {
+            stage->cv.notify_all();
+        }
+        for (auto& stage : stages_) {
+            if (stage->thread.joinable()) {
+                stage->thread.join();
+            }
+        }
+
+        // Fail every frame still between stages so no caller waits forever
+        std::vector<std::unique_ptr<Frame>> pending;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& stage : stages_) {
+                for (auto& frame : stage->queue) {
+                    pending.push_back(std::move(frame));
+                }
+                stage->queue.clear();
+            }
+            frames_failed_ += pending.size();
+        }
+        for (auto& frame : pending) {
+            frame->result.error = hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
+            Complete(*frame);
+        }
+    }
+
+    bool IsRunning() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return running_;
+    }
+
+    std::future<InferenceResult> Submit(std::vector<float> input,
+                                        ModelEngine::CompletionCallback callback) {
+        auto frame = std::make_unique<Frame>();
+        frame->input = std::move(input);
+        frame->callback = std::move(callback);
+        frame->submit_time = std::chrono::steady_clock::now();
+        std::future<InferenceResult> future = frame->promise.get_future();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        frame->result.request_id = ++next_frame_id_;
+        if (!running_ || stages_[0]->queue.size() >= config_.max_queue_size) {
+            frame->result.error = running_
+                ? hardware::HardwareAccelerator::ErrorCode::RESOURCE_EXHAUSTED
+                : hardware::HardwareAccelerator::ErrorCode::INITIALIZATION_FAILED;
+            frames_rejected_++;
+            lock.unlock();
+            Complete(*frame);
+            return future;
+        }
+
+        stages_[0]->queue.push_back(std::move(frame));
+        stages_[0]->cv.notify_one();
+        return future;
+    }
+
+    PipelineStats GetStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        PipelineStats stats;
+        stats.frames_completed = frames_completed_;
+        stats.frames_failed = frames_failed_;
+        stats.frames_rejected = frames_rejected_;
+
+        float elapsed_s = std::chrono::duration<float>(
+            std::chrono::steady_clock::now() - stats_start_).count();
+        if (elapsed_s > 0.0f) {
+            stats.throughput_fps = frames_completed_ / elapsed_s;
+        }
+
+        for (const auto& stage : stages_) {
+            PipelineStageStats stage_stats;
+            stage_stats.name = stage->name;
+            stage_stats.frames = stage->frames;
+            if (stage->frames > 0) {
+                stage_stats.average_time_ms = static_cast<float>(stage->busy_ms / stage->frames);
+                stage_stats.average_stall_ms = static_cast<float>(stage->stall_ms / stage->frames);
+            }
+            stats.stages.push_back(std::move(stage_stats));
+        }
+        return stats;
+    }
+
+    void ResetStats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ResetStatsLocked();
+    }
+
+private:
+    struct Frame {
+        std::vector<float> input;       // Submitted sample, read by the first stage
+        size_t buffer = 0;              // Previous stage's buffer holding the current input
+        ModelEngine::CompletionCallback callback;
+        std::promise<InferenceResult> promise;
+        InferenceResult result;
+        std::chrono::steady_clock::time_point submit_time;
+    };
+
+    struct Stage {
+        std::string name;
+        std::shared_ptr<ModelEngine> engine;
+        std::thread thread;
+        std::condition_variable cv;     // Frame queued, buffer freed, or stopping
+        std::deque<std::unique_ptr<Frame>> queue;
+
+        // Outputs handed to the next stage; returned once it has read them
+        std::vector<std::vector<float>> buffers;
+        std::vector<size_t> free_buffers;
+
+        uint64_t frames = 0;
+        double busy_ms = 0.0;
+        double stall_ms = 0.0;
+    };
+
+    void StageLoop(size_t index) {
+        Stage& stage = *stages_[index];
+        Stage* previous = index > 0 ? stages_[index - 1].get() : nullptr;
+        Stage* next = index + 1 < stages_.size() ? stages_[index + 1].get() : nullptr;
+
+        while (true) {
+            std::unique_ptr<Frame> frame;
+            size_t output_buffer = 0;
+            double stall_ms = 0.0;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                stage.cv.wait(lock, [this, &stage] { return !running_ || !stage.queue.empty(); });
+                if (!running_) return;
+
+                if (next) {
+                    // Waiting here is the back-pressure that keeps a fast
+                    // stage from running ahead of a slow one
+                    auto stall_start = std::chrono::steady_clock::now();
+                    stage.cv.wait(lock, [this, &stage] {
+                        return !running_ || !stage.free_buffers.empty();
+                    });
+                    if (!running_) return;
+                    output_buffer = stage.free_buffers.back();
+                    stage.free_buffers.pop_back();
+                    stall_ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - stall_start).count();
+                }
+                frame = std::move(stage.queue.front());
+                stage.queue.pop_front();
+            }
+
+            // Buffers are only resized by their owning stage, and a buffer
+            // is never written while the next stage is reading it
+            const std::vector<float>& input = previous ? previous->buffers[frame->buffer]
+                                                       : frame->input;
+            std::vector<float>& output = next ? stage.buffers[output_buffer]
+                                              : frame->result.output;
+
+            InferenceMetrics metrics{};
+            auto start = std::chrono::steady_clock::now();
+            bool success = stage.engine->RunInference(input, output, &metrics);
+            double busy_ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+
+            frame->result.metrics.memory_usage_mb =
+                std::max(frame->result.metrics.memory_usage_mb, metrics.memory_usage_mb);
+            frame->result.metrics.cpu_usage_percent =
+                std::max(frame->result.metrics.cpu_usage_percent, metrics.cpu_usage_percent);
+            frame->result.metrics.gpu_usage_percent =
+                std::max(frame->result.metrics.gpu_usage_percent, metrics.gpu_usage_percent);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (previous) {
+                    previous->free_buffers.push_back(frame->buffer);
+                    previous->cv.notify_one();
+                }
+                stage.frames++;
+                stage.busy_ms += busy_ms;
+                stage.stall_ms += stall_ms;
+
+                if (success && next) {
+                    frame->buffer = output_buffer;
+                    next->queue.push_back(std::move(frame));
+                    next->cv.notify_one();
+                    continue;
+                }
+                if (next) {
+                    stage.free_buffers.push_back(output_buffer);
+                }
+                if (success) {
+                    frames_completed_++;
+                } else {
+                    frames_failed_++;
+                }
+            }
+
+            frame->result.success = success;
+            frame->result.error = success ? hardware::HardwareAccelerator::ErrorCode::SUCCESS
+                                          : stage.engine->GetLastError();
+            if (!success) {
+                frame->result.output.clear();
+            }
+            frame->result.metrics.inference_time_ms = std::chrono::duration<float, std::milli>(
+                std::chrono::steady_clock::now() - frame->submit_time).count();
+            Complete(*frame);
+        }
+    }
+
+    void Complete(Frame& frame) {
+        if (frame.callback) {
+            try {
+                frame.callback(frame.result);
+            } catch (...) {
+                // A throwing callback must not take the stage down
+            }
+        }
+        frame.promise.set_value(std::move(frame.result));
+    }
+
+    void ResetStatsLocked() {
+        frames_completed_ = 0;
+        frames_failed_ = 0;
+        frames_rejected_ = 0;
+        stats_start_ = std::chrono::steady_clock::now();
+        for (auto& stage : stages_) {
+            stage->frames = 0;
+            stage->busy_ms = 0.0;
+            stage->stall_ms = 0.0;
+        }
+    }
+
+    PipelineConfig config_;
+    std::vector<std::unique_ptr<Stage>> stages_;
+
+    mutable std::mutex mutex_;
+    bool running_ = false;
+    uint64_t next_frame_id_ = 0;
+    uint64_t frames_completed_ = 0;
+    uint64_t frames_failed_ = 0;
+    uint64_t frames_rejected_ = 0;
+    std::chrono::steady_clock::time_point stats_start_;
+};
+
+PipelineExecutor::PipelineExecutor(std::vector<PipelineStage> stages, const PipelineConfig& config)
+    : pImpl(std::make_unique<Impl>(std::move(stages), config)) {}
+
+PipelineExecutor::~PipelineExecutor() = default;
+
+bool PipelineExecutor::Start() {
+    return pImpl->Start();
+}
+
+void PipelineExecutor::Stop() {
+    pImpl->Stop();
+}
+
+bool PipelineExecutor::IsRunning() const {
+    return pImpl->IsRunning();
+}
+
+std::future<InferenceResult> PipelineExecutor::Submit(std::vector<float> input,
+                                                      ModelEngine::CompletionCallback callback) {
+    return pImpl->Submit(std::move(input), std::move(callback));
+}
+
+PipelineStats PipelineExecutor::GetStats() const {
+    return pImpl->GetStats();
+}
+
+void PipelineExecutor::ResetStats() {
+    pImpl->ResetStats();
+}
+
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "model_engine.h"
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mobileai {
+namespace inference {
+
+// One step of a pipeline. The engine decides the device: initialize it with
+// the accelerator the stage should run on, or disable hardware acceleration
+// to pin it to the CPU.
+struct PipelineStage {
+    std::string name;
+    std::shared_ptr<ModelEngine> engine;
+};
+
+struct PipelineConfig {
+    size_t buffers_per_stage = 2;   // Intermediate buffers between stages; 2 = double buffering
+    size_t max_queue_size = 4;      // Frames waiting for the first stage; more are rejected
+};
+
+struct PipelineStageStats {
+    std::string name;
+    uint64_t frames = 0;
+    float average_time_ms = 0.0f;   // Time spent in the stage's engine
+    float average_stall_ms = 0.0f;  // Time waiting for a free output buffer
+};
+
+struct PipelineStats {
+    uint64_t frames_completed = 0;
+    uint64_t frames_failed = 0;
+    uint64_t frames_rejected = 0;
+    float throughput_fps = 0.0f;    // Since Start() or ResetStats()
+    std::vector<PipelineStageStats> stages;
+};
+
+// Runs a chain of models as a pipeline, one thread per stage. Each stage's
+// output goes into one of a small set of buffers that the next stage reads
+// from. While stage 2 works on frame N, stage 1 can already run frame N+1.
+// Throughput is therefore bound by the slowest stage rather than the sum of
+// all stages. A stage blocks once every buffer ahead of it is full, so at
+// most buffers_per_stage frames sit between any two stages. Frames complete
+// in submission order.
+class PipelineExecutor {
+public:
+    explicit PipelineExecutor(std::vector<PipelineStage> stages,
+                              const PipelineConfig& config = PipelineConfig());
+    ~PipelineExecutor();
+
+    bool Start();
+    // Frames still in the pipeline fail with INITIALIZATION_FAILED
+    void Stop();
+    bool IsRunning() const;
+
+    // Queue a frame; the result holds the last stage's output. The callback,
+    // if any, runs on the last stage's thread. Rejected frames complete
+    // immediately with RESOURCE_EXHAUSTED.
+    std::future<InferenceResult> Submit(std::vector<float> input,
+                                        ModelEngine::CompletionCallback callback = nullptr);
+
+    PipelineStats GetStats() const;
+    void ResetStats();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+
+    PipelineExecutor(const PipelineExecutor&) = delete;
+    PipelineExecutor& operator=(const PipelineExecutor&) = delete;
+};
+
+} // namespace inference
+} // namespace mobileai
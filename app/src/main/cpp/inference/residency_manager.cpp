@@ -0,0 +1,277 @@
+#include "residency_manager.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+
+namespace mobileai {
+namespace inference {
+
+class ResidencyManager::Impl {
+public:
+    explicit Impl(const ResidencyConfig& config) : config_(config) {}
+
+    bool RegisterModel(const std::string& model_id,
+                       std::shared_ptr<ModelEngine> engine,
+                       const std::string& model_path,
+                       ModelFormat format,
+                       const ModelConfig& config) {
+        if (!engine) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& entry = entries_[model_id];
+        if (!entry) {
+            entry = std::make_shared<Entry>();
+        }
+        entry->engine = std::move(engine);
+        entry->model_path = model_path;
+        entry->format = format;
+        entry->config = config;
+        return true;
+    }
+
+    void UnregisterModel(const std::string& model_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.erase(model_id);
+    }
+
+    std::shared_ptr<ModelEngine> Acquire(const std::string& model_id) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto it = entries_.find(model_id);
+        if (it == entries_.end()) {
+            return nullptr;
+        }
+
+        std::shared_ptr<Entry> entry = it->second;
+        auto now = std::chrono::steady_clock::now();
+        RecordAccess(*entry, now);
+
+        // Pinned from here on, so evictions for other models leave it alone
+        std::shared_ptr<ModelEngine> lease = Lease(entry);
+        if (lease->IsModelLoaded()) {
+            EnforceBudget(0, now);
+            return lease;
+        }
+
+        const std::string model_path = entry->model_path;
+        const ModelFormat format = entry->format;
+        const ModelConfig config = entry->config;
+
+        // Make room for the weights before they are mapped and reserve them,
+        // so loads of other models meanwhile count them against the budget
+        // too; concurrent Acquires of this model share the first reservation.
+        // Then load without holding up requests for models already resident.
+        std::error_code ec;
+        const auto file_size = std::filesystem::file_size(model_path, ec);
+        const size_t reserved = (entry->reserved_bytes > 0 || ec) ? 0 : static_cast<size_t>(file_size);
+        EnforceBudget(reserved, now);
+        entry->reserved_bytes += reserved;
+        lock.unlock();
+
+        bool loaded = true;
+        float reload_time_ms = 0.0f;
+        {
+            // Concurrent Acquires of one model load it once
+            std::lock_guard<std::mutex> load_lock(entry->load_mutex);
+            if (!lease->IsModelLoaded()) {
+                auto load_start = std::chrono::steady_clock::now();
+                loaded = lease->LoadModel(model_path, format, config);
+                reload_time_ms = std::chrono::duration<float, std::milli>(
+                    std::chrono::steady_clock::now() - load_start).count();
+            }
+        }
+
+        lock.lock();
+        entry->reserved_bytes -= reserved;
+        if (!loaded) {
+            return nullptr;
+        }
+        if (reload_time_ms > 0.0f) {
+            entry->reload_time_ms = reload_time_ms;
+            entry->loads++;
+        }
+        // The estimate leaves out activation arenas; settle on the real footprint
+        EnforceBudget(0, now);
+        return lease;
+    }
+
+    void SetMemoryBudget(size_t memory_budget_mb) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        config_.memory_budget_mb = memory_budget_mb;
+        EnforceBudget(0, std::chrono::steady_clock::now());
+    }
+
+    size_t GetResidentBytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ResidentBytes();
+    }
+
+    std::vector<ModelResidency> GetResidency() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = std::chrono::steady_clock::now();
+
+        std::vector<ModelResidency> residency;
+        residency.reserve(entries_.size());
+        for (const auto& item : entries_) {
+            const Entry& entry = *item.second;
+            ModelResidency info;
+            info.model_id = item.first;
+            info.loaded = entry.engine->IsModelLoaded();
+            info.footprint = entry.engine->GetMemoryFootprint();
+            info.reload_time_ms = entry.reload_time_ms;
+            info.access_frequency = DecayedFrequency(entry, now);
+            info.retention_score = RetentionScore(entry, info.footprint, now);
+            info.loads = entry.loads;
+            info.evictions = entry.evictions;
+            residency.push_back(std::move(info));
+        }
+        return residency;
+    }
+
+private:
+    struct Entry {
+        std::shared_ptr<ModelEngine> engine;
+        std::string model_path;
+        ModelFormat format = ModelFormat::TFLITE;
+        ModelConfig config;
+
+        float reload_time_ms = 0.0f;
+        float access_frequency = 0.0f;
+        std::chrono::steady_clock::time_point last_access;
+        uint64_t loads = 0;
+        uint64_t evictions = 0;
+
+        std::mutex load_mutex;        // Held while loading, outside the manager's mutex
+        size_t reserved_bytes = 0;    // Estimated weights of a load in progress
+        std::atomic<size_t> pins{0};  // Outstanding leases from Acquire
+    };
+
+    // The engine, pinned until the last copy of the returned pointer is gone
+    static std::shared_ptr<ModelEngine> Lease(const std::shared_ptr<Entry>& entry) {
+        entry->pins++;
+        ModelEngine* engine = entry->engine.get();
+        return std::shared_ptr<ModelEngine>(
+            engine, [entry, owner = entry->engine](ModelEngine*) { entry->pins--; });
+    }
+
+    float DecayedFrequency(const Entry& entry,
+                           std::chrono::steady_clock::time_point now) const {
+        if (entry.access_frequency == 0.0f) {
+            return 0.0f;
+        }
+        float elapsed = std::chrono::duration<float>(now - entry.last_access).count();
+        float half_life = std::max(1.0f, static_cast<float>(config_.frequency_half_life.count()));
+        return entry.access_frequency * std::exp2(-elapsed / half_life);
+    }
+
+    void RecordAccess(Entry& entry, std::chrono::steady_clock::time_point now) {
+        entry.access_frequency = DecayedFrequency(entry, now) + 1.0f;
+        entry.last_access = now;
+    }
+
+    // Expected reload cost avoided by keeping one MB of this model resident
+    float RetentionScore(const Entry& entry, const MemoryFootprint& footprint,
+                         std::chrono::steady_clock::time_point now) const {
+        float megabytes = std::max(1.0f, footprint.Total() / (1024.0f * 1024.0f));
+        // Never-measured models count as at least 1 ms to reload
+        float reload_ms = std::max(1.0f, entry.reload_time_ms);
+        return reload_ms * DecayedFrequency(entry, now) / megabytes;
+    }
+
+    // Includes the reservations of loads in progress
+    size_t ResidentBytes() const {
+        size_t total = 0;
+        for (const auto& item : entries_) {
+            total += item.second->engine->GetMemoryFootprint().Total() + item.second->reserved_bytes;
+        }
+        return total;
+    }
+
+    // Reclaim memory from the lowest-scoring models until the budget holds
+    // with incoming_bytes more loaded. Arenas are shed across all candidates
+    // before any weights are dropped, since they are rebuilt in milliseconds
+    // rather than a full reload. Pinned models are left alone.
+    void EnforceBudget(size_t incoming_bytes, std::chrono::steady_clock::time_point now) {
+        if (config_.memory_budget_mb == 0) {
+            return;
+        }
+        const size_t budget = config_.memory_budget_mb * 1024 * 1024;
+        if (ResidentBytes() + incoming_bytes <= budget) {
+            return;
+        }
+
+        std::vector<std::pair<float, Entry*>> candidates;
+        for (auto& item : entries_) {
+            Entry& entry = *item.second;
+            if (entry.pins > 0 || !entry.engine->IsModelLoaded()) {
+                continue;
+            }
+            float score = RetentionScore(entry, entry.engine->GetMemoryFootprint(), now);
+            candidates.emplace_back(score, &entry);
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        // Footprints are re-read after every step rather than predicted, so
+        // whatever an engine keeps after shedding or unloading still counts
+        for (auto& candidate : candidates) {
+            if (ResidentBytes() + incoming_bytes <= budget) {
+                return;
+            }
+            candidate.second->engine->ShedArenas();
+        }
+
+        for (auto& candidate : candidates) {
+            if (ResidentBytes() + incoming_bytes <= budget) {
+                return;
+            }
+            Entry& entry = *candidate.second;
+            entry.engine->UnloadModel();
+            entry.evictions++;
+        }
+    }
+
+    ResidencyConfig config_;
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, std::shared_ptr<Entry>> entries_;
+};
+
+ResidencyManager::ResidencyManager(const ResidencyConfig& config)
+    : pImpl(std::make_unique<Impl>(config)) {}
+
+ResidencyManager::~ResidencyManager() = default;
+
+bool ResidencyManager::RegisterModel(const std::string& model_id,
+                                     std::shared_ptr<ModelEngine> engine,
+                                     const std::string& model_path,
+                                     ModelFormat format,
+                                     const ModelConfig& config) {
+    return pImpl->RegisterModel(model_id, std::move(engine), model_path, format, config);
+}
+
+void ResidencyManager::UnregisterModel(const std::string& model_id) {
+    pImpl->UnregisterModel(model_id);
+}
+
+std::shared_ptr<ModelEngine> ResidencyManager::Acquire(const std::string& model_id) {
+    return pImpl->Acquire(model_id);
+}
+
+void ResidencyManager::SetMemoryBudget(size_t memory_budget_mb) {
+    pImpl->SetMemoryBudget(memory_budget_mb);
+}
+
+size_t ResidencyManager::GetResidentBytes() const {
+    return pImpl->GetResidentBytes();
+}
+
+std::vector<ModelResidency> ResidencyManager::GetResidency() const {
+    return pImpl->GetResidency();
+}
+
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "model_engine.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mobileai {
+namespace inference {
+
+struct ResidencyConfig {
+    size_t memory_budget_mb = 0;                  // 0 = unlimited
+    std::chrono::seconds frequency_half_life{60}; // Decay of the access-frequency estimate
+};
+
+struct ModelResidency {
+    std::string model_id;
+    bool loaded = false;
+    MemoryFootprint footprint;
+    float reload_time_ms = 0.0f;    // Measured on the most recent load
+    float access_frequency = 0.0f;  // Decayed accesses, roughly "recent uses"
+    float retention_score = 0.0f;   // Reload cost avoided per MB kept resident
+    uint64_t loads = 0;
+    uint64_t evictions = 0;
+};
+
+// Keeps a set of engines within one memory budget. Models are loaded on
+// first use and, when the budget is exceeded, memory is reclaimed from the
+// models that are cheapest to bring back: reload time x access frequency per
+// MB of footprint. Idle activation arenas are shed first; weights are only
+// unloaded when that is not enough. A model is never evicted while a
+// pointer returned by Acquire for it is held.
+class ResidencyManager {
+public:
+    explicit ResidencyManager(const ResidencyConfig& config = ResidencyConfig());
+    ~ResidencyManager();
+
+    // The engine must already be initialized; it is loaded lazily by Acquire
+    bool RegisterModel(const std::string& model_id,
+                      std::shared_ptr<ModelEngine> engine,
+                      const std::string& model_path,
+                      ModelFormat format,
+                      const ModelConfig& config = ModelConfig());
+    void UnregisterModel(const std::string& model_id);
+
+    // Returns the engine with its model loaded, evicting others as needed
+    // before the load; nullptr if the model is unknown or fails to load. The
+    // model stays pinned until the returned pointer and its copies are
+    // released, so hold it only for the requests at hand.
+    std::shared_ptr<ModelEngine> Acquire(const std::string& model_id);
+
+    void SetMemoryBudget(size_t memory_budget_mb);
+    size_t GetResidentBytes() const;
+    std::vector<ModelResidency> GetResidency() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl;
+
+    ResidencyManager(const ResidencyManager&) = delete;
+    ResidencyManager& operator=(const ResidencyManager&) = delete;
+};
+
+} // namespace inference
+} // namespace mobileai
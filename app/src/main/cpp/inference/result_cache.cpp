@@ -0,0 +1,156 @@
+#include "result_cache.h"
+#include <cstring>
+#include <iterator>
+
+namespace mobileai {
+namespace inference {
+
+namespace {
+
+// MurmurHash64A: eight bytes per step, so hashing stays far below the cost
+// of the inference it saves
+uint64_t HashInput(const void* data, size_t bytes) {
+    constexpr uint64_t MULTIPLIER = 0xc6a4a7935bd1e995ULL;
+    constexpr int SHIFT = 47;
+
+    const uint8_t* bytes_ptr = static_cast<const uint8_t*>(data);
+    uint64_t hash = 0x8445d61a4e774912ULL ^ (bytes * MULTIPLIER);
+
+    const size_t blocks = bytes / 8;
+    for (size_t i = 0; i < blocks; i++) {
+        uint64_t block;
+        std::memcpy(&block, bytes_ptr + i * 8, sizeof(block));
+        block *= MULTIPLIER;
+        block ^= block >> SHIFT;
+        block *= MULTIPLIER;
+        hash ^= block;
+        hash *= MULTIPLIER;
+    }
+
+    const uint8_t* tail = bytes_ptr + blocks * 8;
+    const size_t remaining = bytes & 7;
+    if (remaining > 0) {
+        uint64_t last = 0;
+        std::memcpy(&last, tail, remaining);
+        hash ^= last;
+        hash *= MULTIPLIER;
+    }
+
+    hash ^= hash >> SHIFT;
+    hash *= MULTIPLIER;
+    hash ^= hash >> SHIFT;
+    return hash;
+}
+
+} // namespace
+
+ResultCache::ResultCache(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+bool ResultCache::GetOrCompute(uint64_t model_version, Span<const float> input,
+                               std::vector<float>& output, const Compute& compute) {
+    const Key key{HashInput(input.data(), input.size_bytes()), model_version};
+    std::shared_ptr<Flight> flight;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto cached = index_.equal_range(key);
+        for (auto it = cached.first; it != cached.second; ++it) {
+            if (SameInput(it->second->input, input)) {
+                lru_.splice(lru_.begin(), lru_, it->second);
+                output = it->second->output;
+                stats_.hits++;
+                return true;
+            }
+        }
+
+        auto running = flights_.equal_range(key);
+        for (auto it = running.first; it != running.second; ++it) {
+            if (SameInput(it->second->input, input)) {
+                std::shared_ptr<Flight> leader = it->second;
+                stats_.coalesced++;
+                leader->cv.wait(lock, [&leader] { return leader->done; });
+                if (leader->success) {
+                    output = leader->output;
+                }
+                return leader->success;
+            }
+        }
+
+        stats_.misses++;
+        flight = std::make_shared<Flight>();
+        flight->input.assign(input.begin(), input.end());
+        flights_.emplace(key, flight);
+    }
+
+    bool success = compute(output);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flight->done = true;
+        flight->success = success;
+        if (success) {
+            flight->output = output;
+            Insert(key, input, output);
+        }
+
+        auto running = flights_.equal_range(key);
+        for (auto it = running.first; it != running.second; ++it) {
+            if (it->second == flight) {
+                flights_.erase(it);
+                break;
+            }
+        }
+    }
+    flight->cv.notify_all();
+    return success;
+}
+
+void ResultCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+    stats_.entries = 0;
+    stats_.bytes = 0;
+}
+
+ResultCacheStats ResultCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+bool ResultCache::SameInput(const std::vector<float>& stored, Span<const float> input) {
+    return stored.size() == input.size() &&
+           std::memcmp(stored.data(), input.data(), input.size_bytes()) == 0;
+}
+
+void ResultCache::Insert(const Key& key, Span<const float> input, const std::vector<float>& output) {
+    const size_t bytes = (input.size() + output.size()) * sizeof(float) + sizeof(Entry);
+    if (bytes > max_bytes_) {
+        return;
+    }
+
+    lru_.push_front(Entry{key, std::vector<float>(input.begin(), input.end()), output, bytes});
+    index_.emplace(key, lru_.begin());
+    stats_.bytes += bytes;
+    stats_.entries = lru_.size();
+    Trim();
+}
+
+void ResultCache::Trim() {
+    while (stats_.bytes > max_bytes_ && !lru_.empty()) {
+        auto victim = std::prev(lru_.end());
+        auto indexed = index_.equal_range(victim->key);
+        for (auto it = indexed.first; it != indexed.second; ++it) {
+            if (it->second == victim) {
+                index_.erase(it);
+                break;
+            }
+        }
+        stats_.bytes -= victim->bytes;
+        stats_.evictions++;
+        lru_.pop_back();
+    }
+    stats_.entries = lru_.size();
+}
+
+} // namespace inference
+} // namespace mobileai
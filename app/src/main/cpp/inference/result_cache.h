@@ -0,0 +1,80 @@
+#pragma once
+
+#include "model_engine.h"
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace mobileai {
+namespace inference {
+
+// In-memory memo of model outputs, keyed by a hash of the input plus the
+// model version that produced them. Inputs are kept and compared on lookup,
+// so a hash collision can never return another input's output. Entries are
+// evicted least recently used first to stay within the byte budget; failed
+// runs are never cached.
+class ResultCache {
+public:
+    explicit ResultCache(size_t max_bytes);
+
+    // Copy the cached output for input into output, or run compute to produce
+    // it. Concurrent calls for the same input and version run compute once;
+    // the others wait and receive the same result.
+    using Compute = std::function<bool(std::vector<float>& output)>;
+    bool GetOrCompute(uint64_t model_version, Span<const float> input,
+                      std::vector<float>& output, const Compute& compute);
+
+    // Drop every completed entry, e.g. after the model changed
+    void Clear();
+    ResultCacheStats GetStats() const;
+
+private:
+    struct Key {
+        uint64_t hash;
+        uint64_t model_version;
+        bool operator==(const Key& other) const {
+            return hash == other.hash && model_version == other.model_version;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return static_cast<size_t>(key.hash ^ (key.model_version * 0x9e3779b97f4a7c15ULL));
+        }
+    };
+
+    struct Entry {
+        Key key;
+        std::vector<float> input;
+        std::vector<float> output;
+        size_t bytes;
+    };
+
+    // An in-progress computation other callers can wait on
+    struct Flight {
+        std::vector<float> input;
+        std::condition_variable cv;
+        bool done = false;
+        bool success = false;
+        std::vector<float> output;
+    };
+
+    static bool SameInput(const std::vector<float>& stored, Span<const float> input);
+    void Insert(const Key& key, Span<const float> input, const std::vector<float>& output);
+    void Trim();
+
+    size_t max_bytes_;
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;   // Most recently used first
+    std::unordered_multimap<Key, std::list<Entry>::iterator, KeyHash> index_;
+    std::unordered_multimap<Key, std::shared_ptr<Flight>, KeyHash> flights_;
+    ResultCacheStats stats_;
+};
+
+} // namespace inference
+} // namespace mobileai
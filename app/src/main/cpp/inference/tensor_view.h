@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mobileai {
+namespace inference {
+
+// Non-owning view over a contiguous range of elements
+template <typename T>
+class Span {
+public:
+    constexpr Span() noexcept : data_(nullptr), size_(0) {}
+    constexpr Span(T* data, size_t size) noexcept : data_(data), size_(size) {}
+
+    // Implicit conversion from contiguous containers (std::vector, std::array, ...)
+    template <typename Container,
+              typename = std::enable_if_t<std::is_convertible<
+                  decltype(std::declval<Container&>().data()), T*>::value>>
+    Span(Container& container) noexcept
+        : data_(container.data()), size_(container.size()) {}
+
+    // Span<T> -> Span<const T>
+    template <typename U,
+              typename = std::enable_if_t<std::is_convertible<U*, T*>::value>>
+    constexpr Span(const Span<U>& other) noexcept
+        : data_(other.data()), size_(other.size()) {}
+
+    constexpr T* data() const noexcept { return data_; }
+    constexpr size_t size() const noexcept { return size_; }
+    constexpr size_t size_bytes() const noexcept { return size_ * sizeof(T); }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+
+    constexpr T& operator[](size_t index) const noexcept { return data_[index]; }
+    constexpr T* begin() const noexcept { return data_; }
+    constexpr T* end() const noexcept { return data_ + size_; }
+
+private:
+    T* data_;
+    size_t size_;
+};
+
+// Element types understood by the engine. No implicit conversion happens
+// between them: quantized models take and return their native type.
+enum class TensorType {
+    FLOAT32,
+    FLOAT16,
+    INT8,
+    UINT8,
+    INT16,
+    INT32,
+    INT64,
+    UNKNOWN
+};
+
+// IEEE 754 half precision value, stored as raw bits
+struct Float16 {
+    uint16_t bits;
+};
+
+inline size_t TensorTypeSize(TensorType type) {
+    switch (type) {
+        case TensorType::FLOAT32: return 4;
+        case TensorType::FLOAT16: return 2;
+        case TensorType::INT8:    return 1;
+        case TensorType::UINT8:   return 1;
+        case TensorType::INT16:   return 2;
+        case TensorType::INT32:   return 4;
+        case TensorType::INT64:   return 8;
+        default:                  return 0;
+    }
+}
+
+template <typename T> struct TensorTypeOf;
+template <> struct TensorTypeOf<float>    { static constexpr TensorType value = TensorType::FLOAT32; };
+template <> struct TensorTypeOf<Float16>  { static constexpr TensorType value = TensorType::FLOAT16; };
+template <> struct TensorTypeOf<int8_t>   { static constexpr TensorType value = TensorType::INT8; };
+template <> struct TensorTypeOf<uint8_t>  { static constexpr TensorType value = TensorType::UINT8; };
+template <> struct TensorTypeOf<int16_t>  { static constexpr TensorType value = TensorType::INT16; };
+template <> struct TensorTypeOf<int32_t>  { static constexpr TensorType value = TensorType::INT32; };
+template <> struct TensorTypeOf<int64_t>  { static constexpr TensorType value = TensorType::INT64; };
+
+// Affine quantization: real_value = scale * (quantized_value - zero_point)
+struct QuantizationParams {
+    float scale = 0.0f;
+    int32_t zero_point = 0;
+};
+
+// Static description of a model input or output
+struct TensorInfo {
+    std::string name;
+    TensorType type = TensorType::UNKNOWN;
+    std::vector<int64_t> shape;
+    QuantizationParams quantization;
+    size_t bytes = 0;
+};
+
+// Borrowed view of a tensor buffer owned by the inference backend.
+// Input views may be written directly before ModelEngine::Invoke(); output
+// views are valid until the next Invoke(), LoadModel() or ReleaseResources().
+struct TensorView {
+    void* data = nullptr;
+    size_t bytes = 0;
+    TensorType type = TensorType::FLOAT32;
+
+    template <typename T>
+    T* As() const { return static_cast<T*>(data); }
+
+    template <typename T>
+    size_t Count() const { return bytes / sizeof(T); }
+
+    template <typename T>
+    Span<T> AsSpan() const { return Span<T>(As<T>(), Count<T>()); }
+};
+
+} // namespace inference
+} // namespace mobileai
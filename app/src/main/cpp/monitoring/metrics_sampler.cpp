@@ -0,0 +1,208 @@
+#include "metrics_sampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace mobileai {
+namespace monitoring {
+
+namespace {
+
+// One sample from /proc/self/stat, read without iostreams
+bool ReadProcStat(ProcStatFields* fields) {
+    int fd = open("/proc/self/stat", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    char buffer[1024];
+    ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (length <= 0) {
+        return false;
+    }
+    buffer[length] = '\0';
+    return ProcessStatsSampler::ParseProcStat(buffer, fields);
+}
+
+float ResidentMB(const ProcStatFields& fields) {
+    const double page_size = static_cast<double>(sysconf(_SC_PAGESIZE));
+    return static_cast<float>(fields.resident_pages * page_size / (1024.0 * 1024.0));
+}
+
+} // namespace
+
+std::shared_ptr<ProcessStatsSampler> ProcessStatsSampler::Shared() {
+    static std::mutex mutex;
+    static std::weak_ptr<ProcessStatsSampler> shared;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto sampler = shared.lock();
+    if (!sampler) {
+        sampler = std::make_shared<ProcessStatsSampler>();
+        shared = sampler;
+    }
+    return sampler;
+}
+
+ProcessStatsSampler::ProcessStatsSampler(std::chrono::milliseconds interval)
+    : interval_(interval),
+      last_wall_(std::chrono::steady_clock::now()) {
+    // Memory is valid from the start; CPU needs two samples
+    ProcStatFields fields;
+    if (ReadProcStat(&fields)) {
+        last_cpu_ticks_ = fields.cpu_ticks;
+        memory_usage_mb_.store(ResidentMB(fields), std::memory_order_relaxed);
+    }
+    thread_ = std::thread(&ProcessStatsSampler::Run, this);
+}
+
+ProcessStatsSampler::~ProcessStatsSampler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+ProcessStats ProcessStatsSampler::Get() const {
+    ProcessStats stats;
+    stats.memory_usage_mb = memory_usage_mb_.load(std::memory_order_relaxed);
+    stats.cpu_usage_percent = cpu_usage_percent_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ProcessStatsSampler::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!cv_.wait_for(lock, interval_, [this] { return stopping_; })) {
+        lock.unlock();
+        Sample();
+        lock.lock();
+    }
+}
+
+bool ProcessStatsSampler::ParseProcStat(const char* line, ProcStatFields* fields) {
+    // The command name is in parentheses and may contain anything, so the
+    // numeric fields are counted from the last ')'. After it come state
+    // (field 3) and so on; utime and stime are fields 14 and 15, rss is 24.
+    const char* rest = strrchr(line, ')');
+    if (!rest) {
+        return false;
+    }
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+    long long rss = 0;
+    if (sscanf(rest + 1, " %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %*s %llu %llu"
+                         " %*s %*s %*s %*s %*s %*s %*s %*s %lld",
+               &utime, &stime, &rss) != 3) {
+        return false;
+    }
+    fields->cpu_ticks = utime + stime;
+    fields->resident_pages = rss > 0 ? static_cast<uint64_t>(rss) : 0;
+    return true;
+}
+
+void ProcessStatsSampler::Sample() {
+    ProcStatFields fields;
+    if (!ReadProcStat(&fields)) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    double wall_s = std::chrono::duration<double>(now - last_wall_).count();
+    if (wall_s > 0.0) {
+        const double cpu_s = static_cast<double>(fields.cpu_ticks - last_cpu_ticks_) /
+                             static_cast<double>(sysconf(_SC_CLK_TCK));
+        cpu_usage_percent_.store(static_cast<float>(cpu_s / wall_s * 100.0),
+                                 std::memory_order_relaxed);
+    }
+    last_wall_ = now;
+    last_cpu_ticks_ = fields.cpu_ticks;
+
+    memory_usage_mb_.store(ResidentMB(fields), std::memory_order_relaxed);
+}
+
+void LatencyRecorder::Record(float latency_ms, bool success) {
+    Slot& slot = slots_[ThreadSlot()];
+    const uint64_t latency_us = static_cast<uint64_t>(std::max(latency_ms, 0.0f) * 1000.0f);
+
+    size_t bucket = 0;
+    for (uint64_t value = latency_us; value > 1 && bucket + 1 < BUCKET_COUNT; value >>= 1) {
+        bucket++;
+    }
+
+    slot.requests.fetch_add(1, std::memory_order_relaxed);
+    if (!success) {
+        slot.failures.fetch_add(1, std::memory_order_relaxed);
+    }
+    slot.total_us.fetch_add(latency_us, std::memory_order_relaxed);
+    slot.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    // Slots are rarely shared between threads, so the max rarely retries
+    uint64_t max_us = slot.max_us.load(std::memory_order_relaxed);
+    while (latency_us > max_us &&
+           !slot.max_us.compare_exchange_weak(max_us, latency_us, std::memory_order_relaxed)) {
+    }
+}
+
+LatencySnapshot LatencyRecorder::Snapshot() const {
+    LatencySnapshot snapshot;
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+    uint64_t buckets[BUCKET_COUNT] = {};
+    for (const Slot& slot : slots_) {
+        snapshot.requests += slot.requests.load(std::memory_order_relaxed);
+        snapshot.failures += slot.failures.load(std::memory_order_relaxed);
+        total_us += slot.total_us.load(std::memory_order_relaxed);
+        max_us = std::max(max_us, slot.max_us.load(std::memory_order_relaxed));
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            buckets[i] += slot.buckets[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    snapshot.max_ms = max_us / 1000.0f;
+    if (snapshot.requests == 0) {
+        return snapshot;
+    }
+    snapshot.average_ms = static_cast<float>(total_us / 1000.0 / snapshot.requests);
+
+    // Geometric middle of the bucket holding each percentile
+    const float targets[] = {0.50f, 0.95f, 0.99f};
+    float* results[] = {&snapshot.p50_ms, &snapshot.p95_ms, &snapshot.p99_ms};
+    size_t next = 0;
+    uint64_t counted = 0;
+    for (size_t i = 0; i < BUCKET_COUNT && next < 3; i++) {
+        counted += buckets[i];
+        const float bucket_ms = std::ldexp(1.0f, static_cast<int>(i)) * std::sqrt(2.0f) / 1000.0f;
+        while (next < 3 && counted >= targets[next] * snapshot.requests) {
+            *results[next++] = std::min(bucket_ms, snapshot.max_ms);
+        }
+    }
+    return snapshot;
+}
+
+void LatencyRecorder::Reset() {
+    for (Slot& slot : slots_) {
+        slot.requests.store(0, std::memory_order_relaxed);
+        slot.failures.store(0, std::memory_order_relaxed);
+        slot.total_us.store(0, std::memory_order_relaxed);
+        slot.max_us.store(0, std::memory_order_relaxed);
+        for (auto& bucket : slot.buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+// Threads are spread over the slots round-robin on first use
+size_t LatencyRecorder::ThreadSlot() {
+    static std::atomic<size_t> next_slot{0};
+    thread_local size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % SLOT_COUNT;
+    return slot;
+}
+
+} // namespace monitoring
+} // namespace mobileai
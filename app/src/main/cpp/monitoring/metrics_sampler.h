@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace mobileai {
+namespace monitoring {
+
+// Process-level resource usage as of the last sample
+struct ProcessStats {
+    float memory_usage_mb = 0.0f;     // Resident set size
+    float cpu_usage_percent = 0.0f;   // CPU time over wall time since the previous sample; >100 across cores
+};
+
+// Fields of one /proc/<pid>/stat line, in the kernel's units
+struct ProcStatFields {
+    uint64_t cpu_ticks = 0;        // utime + stime, in sysconf(_SC_CLK_TCK) ticks
+    uint64_t resident_pages = 0;   // rss
+};
+
+// Refreshes ProcessStats on a background thread, so readers only load two
+// atomics instead of parsing /proc on their own thread. One sampler is
+// shared by every engine in the process and stops with its last user.
+class ProcessStatsSampler {
+public:
+    static std::shared_ptr<ProcessStatsSampler> Shared();
+
+    explicit ProcessStatsSampler(std::chrono::milliseconds interval = std::chrono::milliseconds(250));
+    ~ProcessStatsSampler();
+
+    ProcessStats Get() const;
+
+    // Parses a /proc/<pid>/stat line; false if it is malformed. The command
+    // name may itself contain spaces and parentheses.
+    static bool ParseProcStat(const char* line, ProcStatFields* fields);
+
+private:
+    void Run();
+    void Sample();
+
+    std::chrono::milliseconds interval_;
+    std::atomic<float> memory_usage_mb_{0.0f};
+    std::atomic<float> cpu_usage_percent_{0.0f};
+
+    // Previous sample, touched only by the sampling thread after construction
+    std::chrono::steady_clock::time_point last_wall_;
+    uint64_t last_cpu_ticks_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopping_ = false;
+    std::thread thread_;
+
+    ProcessStatsSampler(const ProcessStatsSampler&) = delete;
+    ProcessStatsSampler& operator=(const ProcessStatsSampler&) = delete;
+};
+
+struct LatencySnapshot {
+    uint64_t requests = 0;
+    uint64_t failures = 0;
+    float average_ms = 0.0f;
+    float p50_ms = 0.0f;       // Percentiles come from a log2 histogram and are
+    float p95_ms = 0.0f;       // accurate to within a factor of sqrt(2)
+    float p99_ms = 0.0f;
+    float max_ms = 0.0f;
+};
+
+// Always-on request latency counters. Each thread records into its own
+// cache-line-aligned slot with relaxed atomic adds, so recording never takes
+// a lock and threads do not contend; Snapshot sums the slots.
+class LatencyRecorder {
+public:
+    void Record(float latency_ms, bool success);
+    LatencySnapshot Snapshot() const;
+    void Reset();
+
+private:
+    static constexpr size_t SLOT_COUNT = 16;
+    static constexpr size_t BUCKET_COUNT = 32;   // Bucket i holds latencies in [2^i, 2^(i+1)) us
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> failures{0};
+        std::atomic<uint64_t> total_us{0};
+        std::atomic<uint64_t> max_us{0};
+        std::atomic<uint64_t> buckets[BUCKET_COUNT] = {};
+    };
+
+    static size_t ThreadSlot();
+
+    Slot slots_[SLOT_COUNT];
+};
+
+} // namespace monitoring
+} // namespace mobileai
@@ -0,0 +1,118 @@
+#include "hardware/backend_selector.h"
+#include <gtest/gtest.h>
+
+namespace mobileai {
+namespace hardware {
+namespace {
+
+// Select and report the backend's fixed latency
+size_t Serve(BackendSelector& selector, const std::vector<float>& latency_ms) {
+    size_t backend = selector.Select();
+    selector.Record(backend, latency_ms[backend], true);
+    return backend;
+}
+
+BackendSelectorConfig NoExploration() {
+    BackendSelectorConfig config;
+    config.exploration_rate = 0.0f;
+    config.min_samples = 2;
+    config.max_staleness = 1000;
+    return config;
+}
+
+TEST(BackendSelectorTest, MeasuresEveryBackendFirst) {
+    BackendSelector selector({"accelerator", "cpu"}, NoExploration());
+    std::vector<size_t> counts(2, 0);
+    for (int i = 0; i < 4; i++) {
+        counts[Serve(selector, {5.0f, 5.0f})]++;
+    }
+    EXPECT_EQ(counts[0], 2u);
+    EXPECT_EQ(counts[1], 2u);
+}
+
+TEST(BackendSelectorTest, ConvergesOnTheFasterBackend) {
+    BackendSelector selector({"accelerator", "cpu"}, NoExploration());
+    const std::vector<float> latency_ms = {12.0f, 4.0f};
+    for (int i = 0; i < 4; i++) {
+        Serve(selector, latency_ms);
+    }
+    for (int i = 0; i < 50; i++) {
+        EXPECT_EQ(Serve(selector, latency_ms), 1u);
+    }
+    EXPECT_EQ(selector.Best(), 1u);
+
+    std::vector<BackendStats> stats = selector.GetStats();
+    ASSERT_EQ(stats.size(), 2u);
+    EXPECT_EQ(stats[0].name, "accelerator");
+    EXPECT_FLOAT_EQ(stats[0].latency_ms, 12.0f);
+    EXPECT_FLOAT_EQ(stats[1].latency_ms, 4.0f);
+    EXPECT_EQ(stats[1].selections, 52u);
+}
+
+TEST(BackendSelectorTest, FollowsALatencyShift) {
+    BackendSelector selector({"accelerator", "cpu"}, NoExploration());
+    for (int i = 0; i < 10; i++) {
+        Serve(selector, {2.0f, 6.0f});
+    }
+    EXPECT_EQ(selector.Best(), 0u);
+
+    // The accelerator throttles; smoothing lets its estimate climb past the CPU's
+    for (int i = 0; i < 20; i++) {
+        Serve(selector, {20.0f, 6.0f});
+    }
+    EXPECT_EQ(selector.Best(), 1u);
+}
+
+TEST(BackendSelectorTest, RemeasuresStaleBackends) {
+    BackendSelectorConfig config = NoExploration();
+    config.max_staleness = 10;
+    BackendSelector selector({"accelerator", "cpu"}, config);
+    std::vector<size_t> counts(2, 0);
+    for (int i = 0; i < 100; i++) {
+        counts[Serve(selector, {1.0f, 9.0f})]++;
+    }
+    // Besides its initial samples, the slower backend gets one request per
+    // staleness period
+    EXPECT_GE(counts[1], 2u + 8u);
+    EXPECT_LE(counts[1], 2u + 10u);
+}
+
+TEST(BackendSelectorTest, ExploresAtTheConfiguredRate) {
+    BackendSelectorConfig config = NoExploration();
+    config.exploration_rate = 0.2f;
+    BackendSelector selector({"accelerator", "cpu"}, config);
+    std::vector<size_t> counts(2, 0);
+    for (int i = 0; i < 2000; i++) {
+        counts[Serve(selector, {1.0f, 9.0f})]++;
+    }
+    EXPECT_GT(counts[1], 250u);
+    EXPECT_LT(counts[1], 550u);
+}
+
+TEST(BackendSelectorTest, FailuresCountAsDoubledLatency) {
+    BackendSelector selector({"accelerator", "cpu"}, NoExploration());
+    selector.Record(0, 5.0f, true);
+    selector.Record(1, 8.0f, true);
+    EXPECT_EQ(selector.Best(), 0u);
+
+    selector.Record(0, 5.0f, false);
+    std::vector<BackendStats> stats = selector.GetStats();
+    EXPECT_EQ(stats[0].failures, 1u);
+    EXPECT_FLOAT_EQ(stats[0].last_latency_ms, 10.0f);
+}
+
+TEST(BackendSelectorTest, ResetForgetsMeasurements) {
+    BackendSelector selector({"accelerator", "cpu"}, NoExploration());
+    for (int i = 0; i < 10; i++) {
+        Serve(selector, {9.0f, 1.0f});
+    }
+    selector.Reset();
+    std::vector<BackendStats> stats = selector.GetStats();
+    EXPECT_EQ(stats[1].name, "cpu");
+    EXPECT_EQ(stats[1].selections, 0u);
+    EXPECT_EQ(selector.Best(), 0u);
+}
+
+} // namespace
+} // namespace hardware
+} // namespace mobileai
@@ -0,0 +1,102 @@
+#include "inference/batch_scheduler.h"
+#include "fake_model_engine.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace mobileai {
+namespace inference {
+namespace {
+
+class BatchSchedulerTest : public ::testing::Test {
+protected:
+    void LoadModel(size_t max_batch_size) {
+        ModelConfig config;
+        config.max_batch_size = max_batch_size;
+        engine_.LoadModel("model.tflite", ModelFormat::TFLITE, config);
+    }
+
+    // Run one request per input on its own thread
+    static std::vector<std::vector<float>> RunConcurrently(BatchScheduler& scheduler,
+                                                           const std::vector<std::vector<float>>& inputs,
+                                                           std::vector<char>* success) {
+        std::vector<std::vector<float>> outputs(inputs.size());
+        success->assign(inputs.size(), false);
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < inputs.size(); i++) {
+            threads.emplace_back([&, i] {
+                std::vector<float> output;
+                bool ok = scheduler.RunInference(inputs[i], output);
+                outputs[i] = std::move(output);
+                (*success)[i] = ok;
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        return outputs;
+    }
+
+    ModelEngine engine_;
+};
+
+TEST_F(BatchSchedulerTest, EachRequestReceivesItsOwnSlice) {
+    LoadModel(4);
+    BatchSchedulerConfig config;
+    config.max_queue_delay = std::chrono::seconds(2);
+    BatchScheduler scheduler(engine_, config);
+    ASSERT_TRUE(scheduler.Start());
+
+    const std::vector<std::vector<float>> inputs = {{1.0f, 1.5f}, {2.0f, 2.5f}, {3.0f, 3.5f}, {4.0f, 4.5f}};
+    std::vector<char> success;
+    auto outputs = RunConcurrently(scheduler, inputs, &success);
+    for (size_t i = 0; i < inputs.size(); i++) {
+        EXPECT_TRUE(success[i]);
+        EXPECT_EQ(outputs[i], inputs[i]);
+    }
+
+    BatchSchedulerStats stats = scheduler.GetStats();
+    EXPECT_EQ(stats.requests_completed, 4u);
+    EXPECT_EQ(stats.batches_executed, 1u);
+    EXPECT_FLOAT_EQ(stats.average_batch_size, 4.0f);
+}
+
+TEST_F(BatchSchedulerTest, BatchesAreCappedAtTheEngineLimit) {
+    LoadModel(2);
+    BatchSchedulerConfig config;
+    config.max_batch_size = 8;
+    config.max_queue_delay = std::chrono::seconds(2);
+    BatchScheduler scheduler(engine_, config);
+    ASSERT_TRUE(scheduler.Start());
+
+    std::vector<char> success;
+    RunConcurrently(scheduler, {{1.0f}, {2.0f}, {3.0f}, {4.0f}}, &success);
+    for (char ok : success) {
+        EXPECT_TRUE(ok);
+    }
+    EXPECT_EQ(scheduler.GetStats().batches_executed, 2u);
+}
+
+TEST_F(BatchSchedulerTest, PartialBatchRunsAfterTheQueueDelay) {
+    LoadModel(8);
+    BatchSchedulerConfig config;
+    config.max_queue_delay = std::chrono::milliseconds(5);
+    BatchScheduler scheduler(engine_, config);
+    ASSERT_TRUE(scheduler.Start());
+
+    std::vector<float> output;
+    EXPECT_TRUE(scheduler.RunInference({7.0f}, output));
+    EXPECT_EQ(output, std::vector<float>{7.0f});
+    EXPECT_FLOAT_EQ(scheduler.GetStats().average_batch_size, 1.0f);
+}
+
+TEST_F(BatchSchedulerTest, RejectsRequestsWhenStopped) {
+    LoadModel(2);
+    BatchScheduler scheduler(engine_);
+    std::vector<float> output;
+    EXPECT_FALSE(scheduler.RunInference({1.0f}, output));
+    EXPECT_EQ(scheduler.GetStats().requests_rejected, 1u);
+}
+
+} // namespace
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,148 @@
+#include "inference/compiled_model_cache.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace mobileai {
+namespace inference {
+namespace {
+
+class CompiledModelCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = std::filesystem::temp_directory_path() /
+               ("compiled_model_cache_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) +
+                "_" + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(dir_, ec);
+    }
+
+    static CompiledModelKey Key(uint64_t model_hash = 0x1234) {
+        CompiledModelKey key;
+        key.model_hash = model_hash;
+        key.backend = "onnx";
+        key.artifact = "ort_optimized";
+        key.accelerator = "cpu";
+        key.num_threads = 2;
+        key.runtime_version = "1.16.0";
+        return key;
+    }
+
+    // Stands in for a backend writing its artifact
+    static void WriteArtifact(CompiledModelCache& cache, const CompiledModelKey& key, size_t bytes) {
+        std::ofstream(cache.GetArtifactPath(key), std::ios::binary) << std::string(bytes, 'x');
+    }
+
+    static void SetLastUsed(CompiledModelCache& cache, const CompiledModelKey& key,
+                            std::chrono::hours age) {
+        std::filesystem::path manifest = cache.GetArtifactPath(key);
+        manifest.replace_extension(".manifest");
+        std::filesystem::last_write_time(manifest, std::filesystem::file_time_type::clock::now() - age);
+    }
+
+    std::filesystem::path dir_;
+};
+
+TEST_F(CompiledModelCacheTest, EveryKeyFieldSelectsItsOwnEntry) {
+    CompiledModelCache cache(dir_.string());
+    ASSERT_TRUE(cache.IsEnabled());
+    const CompiledModelKey base = Key();
+    EXPECT_EQ(cache.GetArtifactPath(base), cache.GetArtifactPath(Key()));
+
+    std::vector<CompiledModelKey> variants(6, base);
+    variants[0].model_hash++;
+    variants[1].backend = "tflite";
+    variants[2].artifact = "xnnpack_weights";
+    variants[3].accelerator = "qualcomm 2.1";
+    variants[4].num_threads = 4;
+    variants[5].runtime_version = "1.17.0";
+    for (const auto& variant : variants) {
+        EXPECT_NE(cache.GetArtifactPath(variant), cache.GetArtifactPath(base));
+    }
+}
+
+TEST_F(CompiledModelCacheTest, HitsOnlyAfterCommit) {
+    CompiledModelCache cache(dir_.string());
+    const CompiledModelKey key = Key();
+    EXPECT_EQ(cache.Lookup(key), "");
+
+    // Nothing written yet, or an empty artifact, cannot be committed
+    EXPECT_FALSE(cache.Commit(key));
+    WriteArtifact(cache, key, 0);
+    EXPECT_FALSE(cache.Commit(key));
+
+    WriteArtifact(cache, key, 64);
+    EXPECT_EQ(cache.Lookup(key), "");
+    ASSERT_TRUE(cache.Commit(key));
+    EXPECT_EQ(cache.Lookup(key), cache.GetArtifactPath(key));
+
+    // A new cache over the same directory sees the entry
+    CompiledModelCache reopened(dir_.string());
+    EXPECT_EQ(reopened.Lookup(key), cache.GetArtifactPath(key));
+    CompiledModelKey other_runtime = key;
+    other_runtime.runtime_version = "2.0.0";
+    EXPECT_EQ(reopened.Lookup(other_runtime), "");
+}
+
+TEST_F(CompiledModelCacheTest, InvalidateRemovesTheEntry) {
+    CompiledModelCache cache(dir_.string());
+    const CompiledModelKey key = Key();
+    WriteArtifact(cache, key, 64);
+    ASSERT_TRUE(cache.Commit(key));
+
+    cache.Invalidate(key);
+    EXPECT_EQ(cache.Lookup(key), "");
+    EXPECT_FALSE(std::filesystem::exists(cache.GetArtifactPath(key)));
+}
+
+TEST_F(CompiledModelCacheTest, ArtifactChangedAfterCommitIsDropped) {
+    CompiledModelCache cache(dir_.string());
+    const CompiledModelKey key = Key();
+    WriteArtifact(cache, key, 64);
+    ASSERT_TRUE(cache.Commit(key));
+
+    WriteArtifact(cache, key, 32);
+    EXPECT_EQ(cache.Lookup(key), "");
+    EXPECT_FALSE(std::filesystem::exists(cache.GetArtifactPath(key)));
+}
+
+TEST_F(CompiledModelCacheTest, TrimsLeastRecentlyUsedEntries) {
+    CompiledModelCache cache(dir_.string(), 250);
+    const CompiledModelKey a = Key(1);
+    const CompiledModelKey b = Key(2);
+    const CompiledModelKey c = Key(3);
+    WriteArtifact(cache, a, 100);
+    ASSERT_TRUE(cache.Commit(a));
+    WriteArtifact(cache, b, 100);
+    ASSERT_TRUE(cache.Commit(b));
+    SetLastUsed(cache, a, std::chrono::hours(2));
+    SetLastUsed(cache, b, std::chrono::hours(1));
+
+    // Using a makes b the oldest
+    ASSERT_NE(cache.Lookup(a), "");
+    WriteArtifact(cache, c, 100);
+    ASSERT_TRUE(cache.Commit(c));
+    EXPECT_NE(cache.Lookup(a), "");
+    EXPECT_EQ(cache.Lookup(b), "");
+    EXPECT_NE(cache.Lookup(c), "");
+}
+
+TEST_F(CompiledModelCacheTest, DisabledWhenTheDirectoryIsUnusable) {
+    std::filesystem::create_directories(dir_);
+    const std::filesystem::path file = dir_ / "file";
+    std::ofstream(file) << "not a directory";
+
+    CompiledModelCache cache((file / "cache").string());
+    EXPECT_FALSE(cache.IsEnabled());
+    EXPECT_EQ(cache.Lookup(Key()), "");
+    EXPECT_FALSE(cache.Commit(Key()));
+}
+
+} // namespace
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,241 @@
+#include "inference/deadline_scheduler.h"
+#include "fake_model_engine.h"
+#include <gtest/gtest.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace mobileai {
+namespace inference {
+namespace {
+
+using Clock = DeadlineScheduler::Clock;
+using ErrorCode = hardware::HardwareAccelerator::ErrorCode;
+
+// Holds the first request on the worker until released, and records the
+// order in which requests ran by their first input value
+class Gate {
+public:
+    bool Run(const std::vector<float>& input, std::vector<float>& output) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        order_.push_back(input[0]);
+        if (order_.size() == 1) {
+            cv_.notify_all();
+            cv_.wait(lock, [this] { return released_; });
+        }
+        output = input;
+        return input[0] >= 0.0f;
+    }
+
+    void WaitForFirst() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return !order_.empty(); });
+    }
+
+    void Release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        released_ = true;
+        cv_.notify_all();
+    }
+
+    std::vector<float> Order() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return order_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool released_ = false;
+    std::vector<float> order_;
+};
+
+class DeadlineSchedulerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ModelConfig config;
+        config.max_execution_contexts = 1;
+        engine_.LoadModel("model.tflite", ModelFormat::TFLITE, config);
+        testing::SetFakeInference([this](const std::vector<float>& input, std::vector<float>& output) {
+            return gate_.Run(input, output);
+        });
+    }
+
+    void TearDown() override {
+        gate_.Release();
+        testing::SetFakeInference(nullptr);
+    }
+
+    static DeadlineSchedulerConfig SingleWorker() {
+        DeadlineSchedulerConfig config;
+        config.num_workers = 1;
+        config.reserved_interactive_workers = 0;
+        return config;
+    }
+
+    ModelEngine engine_;
+    Gate gate_;
+};
+
+TEST_F(DeadlineSchedulerTest, DispatchesEarliestDeadlineFirst) {
+    DeadlineScheduler scheduler(SingleWorker());
+    ASSERT_TRUE(scheduler.AddModel("model", engine_));
+    ASSERT_TRUE(scheduler.Start());
+
+    const auto now = Clock::now();
+    auto blocker = scheduler.Submit("model", {0.0f}, now + std::chrono::hours(1));
+    gate_.WaitForFirst();
+
+    std::vector<std::future<InferenceResult>> futures;
+    futures.push_back(scheduler.Submit("model", {3.0f}, now + std::chrono::seconds(30)));
+    futures.push_back(scheduler.Submit("model", {1.0f}, now + std::chrono::seconds(10)));
+    futures.push_back(scheduler.Submit("model", {4.0f}, now + std::chrono::seconds(40)));
+    futures.push_back(scheduler.Submit("model", {2.0f}, now + std::chrono::seconds(20)));
+    gate_.Release();
+
+    EXPECT_TRUE(blocker.get().success);
+    for (auto& future : futures) {
+        EXPECT_TRUE(future.get().success);
+    }
+    EXPECT_EQ(gate_.Order(), (std::vector<float>{0.0f, 1.0f, 2.0f, 3.0f, 4.0f}));
+}
+
+TEST_F(DeadlineSchedulerTest, InteractiveRequestsRunAheadOfBackground) {
+    DeadlineScheduler scheduler(SingleWorker());
+    ASSERT_TRUE(scheduler.AddModel("model", engine_));
+    ASSERT_TRUE(scheduler.Start());
+
+    const auto now = Clock::now();
+    auto blocker = scheduler.Submit("model", {0.0f}, now + std::chrono::hours(1));
+    gate_.WaitForFirst();
+
+    auto background = scheduler.Submit("model", {2.0f}, now + std::chrono::seconds(1),
+                                       RequestPriority::BACKGROUND);
+    auto interactive = scheduler.Submit("model", {1.0f}, now + std::chrono::seconds(60),
+                                        RequestPriority::INTERACTIVE);
+    gate_.Release();
+
+    blocker.get();
+    EXPECT_TRUE(background.get().success);
+    EXPECT_TRUE(interactive.get().success);
+    EXPECT_EQ(gate_.Order(), (std::vector<float>{0.0f, 1.0f, 2.0f}));
+
+    DeadlineSchedulerStats stats = scheduler.GetStats();
+    EXPECT_EQ(stats.interactive.requests_completed, 2u);
+    EXPECT_EQ(stats.background.requests_completed, 1u);
+}
+
+TEST_F(DeadlineSchedulerTest, ReportsEachRequestsOwnError) {
+    DeadlineScheduler scheduler(SingleWorker());
+    ASSERT_TRUE(scheduler.AddModel("model", engine_));
+    ASSERT_TRUE(scheduler.Start());
+    gate_.Release();
+
+    const auto deadline = Clock::now() + std::chrono::seconds(10);
+    auto failed = scheduler.Submit("model", {-1.0f}, deadline);
+    auto succeeded = scheduler.Submit("model", {1.0f}, deadline);
+
+    InferenceResult result = failed.get();
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.error, ErrorCode::HARDWARE_ERROR);
+    result = succeeded.get();
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.error, ErrorCode::SUCCESS);
+    EXPECT_EQ(result.output, std::vector<float>{1.0f});
+}
+
+TEST_F(DeadlineSchedulerTest, RejectsUnknownModelsAndFullQueues) {
+    DeadlineSchedulerConfig config = SingleWorker();
+    config.max_queue_size = 1;
+    DeadlineScheduler scheduler(config);
+    ASSERT_TRUE(scheduler.AddModel("model", engine_));
+    ASSERT_TRUE(scheduler.Start());
+
+    const auto deadline = Clock::now() + std::chrono::seconds(10);
+    EXPECT_EQ(scheduler.Submit("other", {1.0f}, deadline).get().error, ErrorCode::INITIALIZATION_FAILED);
+
+    auto blocker = scheduler.Submit("model", {0.0f}, deadline);
+    gate_.WaitForFirst();
+    auto queued = scheduler.Submit("model", {1.0f}, deadline);
+    EXPECT_EQ(scheduler.Submit("model", {2.0f}, deadline).get().error, ErrorCode::RESOURCE_EXHAUSTED);
+    gate_.Release();
+
+    EXPECT_TRUE(blocker.get().success);
+    EXPECT_TRUE(queued.get().success);
+    EXPECT_EQ(scheduler.GetStats().interactive.requests_rejected, 2u);
+}
+
+TEST_F(DeadlineSchedulerTest, DropsRequestsThatExpiredInTheQueue) {
+    DeadlineSchedulerConfig config = SingleWorker();
+    config.drop_expired = true;
+    DeadlineScheduler scheduler(config);
+    ASSERT_TRUE(scheduler.AddModel("model", engine_));
+    ASSERT_TRUE(scheduler.Start());
+
+    const auto now = Clock::now();
+    auto blocker = scheduler.Submit("model", {0.0f}, now + std::chrono::hours(1));
+    gate_.WaitForFirst();
+    auto expired = scheduler.Submit("model", {1.0f}, now - std::chrono::seconds(1));
+    gate_.Release();
+
+    blocker.get();
+    InferenceResult result = expired.get();
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.error, ErrorCode::CANCELLED);
+    EXPECT_EQ(gate_.Order(), std::vector<float>{0.0f});
+    EXPECT_EQ(scheduler.GetStats().interactive.requests_dropped, 1u);
+}
+
+TEST_F(DeadlineSchedulerTest, CancelsRunningRequestsAtTheirDeadline) {
+    DeadlineSchedulerConfig config = SingleWorker();
+    config.drop_expired = true;
+    DeadlineScheduler scheduler(config);
+    ASSERT_TRUE(scheduler.AddModel("model", engine_));
+    ASSERT_TRUE(scheduler.Start());
+
+    auto late = scheduler.Submit("model", {0.0f}, Clock::now() + std::chrono::milliseconds(20));
+    gate_.WaitForFirst();
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    gate_.Release();
+
+    InferenceResult result = late.get();
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.error, ErrorCode::CANCELLED);
+    DeadlineSchedulerStats stats = scheduler.GetStats();
+    EXPECT_EQ(stats.interactive.requests_failed, 1u);
+    EXPECT_EQ(stats.interactive.deadlines_missed, 1u);
+}
+
+TEST_F(DeadlineSchedulerTest, RemovingABusyModelDoesNotStallOthers) {
+    ModelEngine other;
+    ModelConfig config;
+    config.max_execution_contexts = 1;
+    other.LoadModel("other.tflite", ModelFormat::TFLITE, config);
+
+    DeadlineSchedulerConfig scheduler_config = SingleWorker();
+    scheduler_config.num_workers = 2;
+    DeadlineScheduler scheduler(scheduler_config);
+    ASSERT_TRUE(scheduler.AddModel("model", engine_));
+    ASSERT_TRUE(scheduler.AddModel("other", other));
+    ASSERT_TRUE(scheduler.Start());
+
+    const auto deadline = Clock::now() + std::chrono::seconds(10);
+    auto blocker = scheduler.Submit("model", {0.0f}, deadline);
+    gate_.WaitForFirst();
+
+    // RemoveModel waits for the blocked request; a request for the other
+    // model must still wake the idle worker
+    std::thread remover([&scheduler] { scheduler.RemoveModel("model"); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto queued = scheduler.Submit("other", {1.0f}, deadline);
+    EXPECT_EQ(queued.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+
+    gate_.Release();
+    remover.join();
+    EXPECT_TRUE(blocker.get().success);
+    EXPECT_TRUE(queued.get().success);
+}
+
+} // namespace
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,155 @@
+#include "fake_model_engine.h"
+#include <atomic>
+#include <mutex>
+#include <utility>
+
+namespace mobileai {
+namespace inference {
+
+namespace {
+
+std::mutex inference_mutex;
+testing::FakeInference inference;
+testing::FakeLoad load;
+
+bool RunFake(const std::vector<float>& input, std::vector<float>& output) {
+    testing::FakeInference run;
+    {
+        std::lock_guard<std::mutex> lock(inference_mutex);
+        run = inference;
+    }
+    if (!run) {
+        output = input;
+        return true;
+    }
+    return run(input, output);
+}
+
+} // namespace
+
+namespace testing {
+
+void SetFakeInference(FakeInference run) {
+    std::lock_guard<std::mutex> lock(inference_mutex);
+    inference = std::move(run);
+}
+
+void SetFakeLoad(FakeLoad fake_load) {
+    std::lock_guard<std::mutex> lock(inference_mutex);
+    load = std::move(fake_load);
+}
+
+} // namespace testing
+
+class ModelEngine::Impl {
+public:
+    mutable std::mutex mutex;
+    ModelConfig config;
+    MemoryFootprint footprint;
+    bool loaded = false;
+    std::atomic<hardware::HardwareAccelerator::ErrorCode> last_error{
+        hardware::HardwareAccelerator::ErrorCode::SUCCESS};
+};
+
+ModelEngine::ModelEngine() : pImpl(std::make_unique<Impl>()) {}
+
+ModelEngine::~ModelEngine() = default;
+
+bool ModelEngine::LoadModel(const std::string& model_path, ModelFormat /*format*/,
+                            const ModelConfig& config) {
+    testing::FakeLoad run;
+    {
+        std::lock_guard<std::mutex> lock(inference_mutex);
+        run = load;
+    }
+    // Called unlocked, so a test can hold a load in progress
+    MemoryFootprint footprint;
+    if (run && !run(model_path, footprint)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->config = config;
+    pImpl->footprint = footprint;
+    pImpl->loaded = true;
+    return true;
+}
+
+void ModelEngine::UnloadModel() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    pImpl->footprint = MemoryFootprint();
+    pImpl->loaded = false;
+}
+
+MemoryFootprint ModelEngine::GetMemoryFootprint() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->footprint;
+}
+
+size_t ModelEngine::ShedArenas() {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return std::exchange(pImpl->footprint.arena_bytes, 0);
+}
+
+bool ModelEngine::IsModelLoaded() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->loaded;
+}
+
+ModelConfig ModelEngine::GetModelConfig() const {
+    std::lock_guard<std::mutex> lock(pImpl->mutex);
+    return pImpl->config;
+}
+
+bool ModelEngine::RunInference(const std::vector<float>& input,
+                               std::vector<float>& output,
+                               InferenceMetrics* /*metrics*/) {
+    if (!RunFake(input, output)) {
+        pImpl->last_error = hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR;
+        return false;
+    }
+    return true;
+}
+
+hardware::HardwareAccelerator::ErrorCode ModelEngine::GetLastError() const {
+    return pImpl->last_error;
+}
+
+bool ModelEngine::RunInference(const std::vector<float>& input, InferenceResult* result) {
+    result->success = RunFake(input, result->output);
+    result->error = result->success ? hardware::HardwareAccelerator::ErrorCode::SUCCESS
+                                    : hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR;
+    return result->success;
+}
+
+// Cancellation is checked before and after the run; a cancelled run fails
+// even if the fake inference succeeded
+bool ModelEngine::RunInference(const std::vector<float>& input, const CancellationToken& token,
+                               InferenceResult* result) {
+    result->success = !token.IsCancelled() && RunFake(input, result->output) && !token.IsCancelled();
+    if (result->success) {
+        result->error = hardware::HardwareAccelerator::ErrorCode::SUCCESS;
+    } else {
+        result->error = token.IsCancelled() ? hardware::HardwareAccelerator::ErrorCode::CANCELLED
+                                            : hardware::HardwareAccelerator::ErrorCode::HARDWARE_ERROR;
+    }
+    return result->success;
+}
+
+bool ModelEngine::RunBatchInference(const std::vector<std::vector<float>>& inputs,
+                                    std::vector<std::vector<float>>& outputs,
+                                    InferenceMetrics* /*metrics*/) {
+    if (inputs.empty() || inputs.size() > GetModelConfig().max_batch_size) {
+        return false;
+    }
+    outputs.resize(inputs.size());
+    for (size_t i = 0; i < inputs.size(); i++) {
+        if (!RunFake(inputs[i], outputs[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace inference
+} // namespace mobileai
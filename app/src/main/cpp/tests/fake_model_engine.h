@@ -0,0 +1,30 @@
+#pragma once
+
+#include "inference/model_engine.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace mobileai {
+namespace inference {
+namespace testing {
+
+// Tests link fake_model_engine.cpp in place of model_engine.cpp. LoadModel
+// records its config, and every inference call runs the function set
+// here, one sample at a time; the default echoes the input. Batches above
+// ModelConfig::max_batch_size fail like the real engine's. Failed runs report
+// HARDWARE_ERROR, through GetLastError too.
+using FakeInference = std::function<bool(const std::vector<float>& input,
+                                         std::vector<float>& output)>;
+void SetFakeInference(FakeInference inference);
+
+// LoadModel calls the function set here, when there is one, to decide
+// whether the load succeeds and to fill in what GetMemoryFootprint reports
+// until UnloadModel. ShedArenas frees the footprint's arena_bytes.
+using FakeLoad = std::function<bool(const std::string& model_path,
+                                    MemoryFootprint& footprint)>;
+void SetFakeLoad(FakeLoad load);
+
+} // namespace testing
+} // namespace inference
+} // namespace mobileai
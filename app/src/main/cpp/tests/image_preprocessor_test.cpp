@@ -0,0 +1,219 @@
+#include "inference/image_preprocessor.h"
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <random>
+
+namespace mobileai {
+namespace inference {
+namespace {
+
+TensorInfo Tensor(TensorType type, std::vector<int64_t> shape) {
+    TensorInfo info;
+    info.type = type;
+    info.shape = std::move(shape);
+    return info;
+}
+
+ImageBuffer Image(const std::vector<uint8_t>& pixels, int width, int height, PixelFormat format) {
+    ImageBuffer image;
+    image.data = pixels.data();
+    image.width = width;
+    image.height = height;
+    image.format = format;
+    return image;
+}
+
+template <typename T>
+std::vector<T> Preprocess(const PreprocessSpec& spec, const ImageBuffer& image, const TensorInfo& info) {
+    size_t count = 1;
+    for (int64_t dim : info.shape) {
+        count *= static_cast<size_t>(dim);
+    }
+    std::vector<T> out(count);
+    EXPECT_TRUE(ImagePreprocessor(spec).Run(image, info, out.data(), out.size() * sizeof(T)));
+    return out;
+}
+
+TEST(ImagePreprocessorTest, SameSizeGrayIsCopied) {
+    const std::vector<uint8_t> pixels = {0, 10, 20, 30, 40, 50};
+    auto out = Preprocess<float>(PreprocessSpec(), Image(pixels, 3, 2, PixelFormat::GRAY8),
+                                 Tensor(TensorType::FLOAT32, {1, 2, 3, 1}));
+    EXPECT_EQ(out, (std::vector<float>{0, 10, 20, 30, 40, 50}));
+}
+
+TEST(ImagePreprocessorTest, BilinearHalvingAveragesEachBlock) {
+    const std::vector<uint8_t> pixels = {
+        0,   20,  100, 100,
+        40,  60,  100, 100,
+        200, 200, 0,   8,
+        200, 200, 16,  24,
+    };
+    auto out = Preprocess<float>(PreprocessSpec(), Image(pixels, 4, 4, PixelFormat::GRAY8),
+                                 Tensor(TensorType::FLOAT32, {1, 2, 2, 1}));
+    ASSERT_EQ(out.size(), 4u);
+    EXPECT_FLOAT_EQ(out[0], 30.0f);
+    EXPECT_FLOAT_EQ(out[1], 100.0f);
+    EXPECT_FLOAT_EQ(out[2], 200.0f);
+    EXPECT_FLOAT_EQ(out[3], 12.0f);
+}
+
+TEST(ImagePreprocessorTest, NearestUpscaleRepeatsPixels) {
+    const std::vector<uint8_t> pixels = {10, 20};
+    PreprocessSpec spec;
+    spec.filter = ResizeFilter::NEAREST;
+    auto out = Preprocess<float>(spec, Image(pixels, 2, 1, PixelFormat::GRAY8),
+                                 Tensor(TensorType::FLOAT32, {1, 1, 4, 1}));
+    EXPECT_EQ(out, (std::vector<float>{10, 10, 20, 20}));
+}
+
+TEST(ImagePreprocessorTest, NormalizesPerChannelInModelOrder) {
+    const std::vector<uint8_t> pixels = {30, 60, 90};   // R, G, B
+    PreprocessSpec spec;
+    spec.mean[0] = 10.0f;
+    spec.mean[1] = 20.0f;
+    spec.mean[2] = 30.0f;
+    spec.stddev[0] = 2.0f;
+    spec.stddev[1] = 4.0f;
+    spec.stddev[2] = 5.0f;
+    auto rgb = Preprocess<float>(spec, Image(pixels, 1, 1, PixelFormat::RGB8),
+                                 Tensor(TensorType::FLOAT32, {1, 1, 1, 3}));
+    EXPECT_EQ(rgb, (std::vector<float>{10.0f, 10.0f, 12.0f}));
+
+    // Channel 0 is blue for a BGR model, and a BGRA source is read accordingly
+    spec.channel_order = ChannelOrder::BGR;
+    const std::vector<uint8_t> bgra = {90, 60, 30, 255};
+    auto bgr = Preprocess<float>(spec, Image(bgra, 1, 1, PixelFormat::BGRA8),
+                                 Tensor(TensorType::FLOAT32, {1, 1, 1, 3}));
+    EXPECT_EQ(bgr, (std::vector<float>{40.0f, 10.0f, 0.0f}));
+}
+
+TEST(ImagePreprocessorTest, NchwStoresOnePlanePerChannel) {
+    const std::vector<uint8_t> pixels = {1, 2, 3, 4, 5, 6};   // Two RGB pixels
+    PreprocessSpec spec;
+    spec.layout = TensorLayout::NCHW;
+    auto nchw = Preprocess<float>(spec, Image(pixels, 2, 1, PixelFormat::RGB8),
+                                  Tensor(TensorType::FLOAT32, {1, 3, 1, 2}));
+    EXPECT_EQ(nchw, (std::vector<float>{1, 4, 2, 5, 3, 6}));
+
+    spec.layout = TensorLayout::NHWC;
+    auto nhwc = Preprocess<float>(spec, Image(pixels, 2, 1, PixelFormat::RGB8),
+                                  Tensor(TensorType::FLOAT32, {1, 1, 2, 3}));
+    EXPECT_EQ(nhwc, (std::vector<float>{1, 2, 3, 4, 5, 6}));
+}
+
+TEST(ImagePreprocessorTest, QuantizesWithTheTensorsParameters) {
+    const std::vector<uint8_t> pixels = {0, 100, 255, 7};
+
+    TensorInfo u8 = Tensor(TensorType::UINT8, {1, 1, 4, 1});
+    u8.quantization.scale = 1.0f;
+    EXPECT_EQ(Preprocess<uint8_t>(PreprocessSpec(), Image(pixels, 4, 1, PixelFormat::GRAY8), u8),
+                                  (std::vector<uint8_t>{0, 100, 255, 7}));
+
+    // value = pixel / 255, q = value / (1 / 255) - 128
+    PreprocessSpec spec;
+    spec.stddev[0] = 255.0f;
+    TensorInfo s8 = Tensor(TensorType::INT8, {1, 1, 4, 1});
+    s8.quantization.scale = 1.0f / 255.0f;
+    s8.quantization.zero_point = -128;
+    EXPECT_EQ(Preprocess<int8_t>(spec, Image(pixels, 4, 1, PixelFormat::GRAY8), s8),
+                                 (std::vector<int8_t>{-128, -28, 127, -121}));
+
+    // Out of range values saturate
+    spec.stddev[0] = 0.5f;
+    EXPECT_EQ(Preprocess<uint8_t>(spec, Image(pixels, 4, 1, PixelFormat::GRAY8), u8),
+                                  (std::vector<uint8_t>{0, 200, 255, 14}));
+}
+
+TEST(ImagePreprocessorTest, LetterboxPadsTheShortSide) {
+    const std::vector<uint8_t> pixels(4 * 2, 50);
+    PreprocessSpec spec;
+    spec.resize = ResizeMode::LETTERBOX;
+    spec.pad_value = 9.0f;
+    auto out = Preprocess<float>(spec, Image(pixels, 4, 2, PixelFormat::GRAY8),
+                                 Tensor(TensorType::FLOAT32, {1, 4, 4, 1}));
+    for (int y = 0; y < 4; y++) {
+        const float expected = (y == 1 || y == 2) ? 50.0f : 9.0f;
+        for (int x = 0; x < 4; x++) {
+            EXPECT_EQ(out[y * 4 + x], expected) << "at " << x << "," << y;
+        }
+    }
+}
+
+TEST(ImagePreprocessorTest, RejectsUnsupportedInputs) {
+    const std::vector<uint8_t> pixels(16, 0);
+    ImagePreprocessor preprocessor{PreprocessSpec()};
+    std::vector<float> out(16);
+    const ImageBuffer image = Image(pixels, 4, 4, PixelFormat::GRAY8);
+    EXPECT_FALSE(preprocessor.Run(image, Tensor(TensorType::FLOAT32, {1, 4, 4, 2}),
+                                  out.data(), out.size() * sizeof(float)));
+    EXPECT_FALSE(preprocessor.Run(image, Tensor(TensorType::FLOAT32, {4, 4, 1}),
+                                  out.data(), out.size() * sizeof(float)));
+    EXPECT_FALSE(preprocessor.Run(image, Tensor(TensorType::INT32, {1, 4, 4, 1}),
+                                  out.data(), out.size() * sizeof(float)));
+    EXPECT_FALSE(preprocessor.Run(image, Tensor(TensorType::FLOAT32, {1, 4, 4, 1}),
+                                  out.data(), 15 * sizeof(float)));
+}
+
+class ImagePreprocessorKernelsTest : public ::testing::Test {
+protected:
+    void TearDown() override {
+        ImagePreprocessor::SetKernels(nullptr);
+    }
+};
+
+TEST_F(ImagePreprocessorKernelsTest, SimdMatchesScalar) {
+    const std::string best = ImagePreprocessor::GetKernelName();
+    EXPECT_TRUE(ImagePreprocessor::SetKernels("scalar"));
+    EXPECT_STREQ(ImagePreprocessor::GetKernelName(), "scalar");
+    EXPECT_FALSE(ImagePreprocessor::SetKernels("unknown"));
+    if (best == "scalar") {
+        GTEST_SKIP() << "No SIMD kernels on this CPU";
+    }
+
+    // Odd sizes exercise the kernels' scalar tails too
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<uint8_t> pixels(37 * 23 * 4);
+    for (auto& pixel : pixels) {
+        pixel = static_cast<uint8_t>(byte(rng));
+    }
+    const ImageBuffer image = Image(pixels, 37, 23, PixelFormat::RGBA8);
+
+    PreprocessSpec spec;
+    spec.mean[0] = 123.7f;
+    spec.mean[1] = 116.3f;
+    spec.mean[2] = 103.5f;
+    spec.stddev[0] = 58.4f;
+    spec.stddev[1] = 57.1f;
+    spec.stddev[2] = 57.4f;
+    spec.layout = TensorLayout::NCHW;
+    const TensorInfo planar = Tensor(TensorType::FLOAT32, {1, 3, 19, 29});
+    TensorInfo quantized = Tensor(TensorType::UINT8, {1, 19, 29, 3});
+    quantized.quantization.scale = 0.02f;
+    quantized.quantization.zero_point = 128;
+
+    ASSERT_TRUE(ImagePreprocessor::SetKernels("scalar"));
+    auto scalar_float = Preprocess<float>(spec, image, planar);
+    spec.layout = TensorLayout::NHWC;
+    auto scalar_u8 = Preprocess<uint8_t>(spec, image, quantized);
+
+    ASSERT_TRUE(ImagePreprocessor::SetKernels(best.c_str()));
+    EXPECT_EQ(best, ImagePreprocessor::GetKernelName());
+    auto simd_u8 = Preprocess<uint8_t>(spec, image, quantized);
+    spec.layout = TensorLayout::NCHW;
+    auto simd_float = Preprocess<float>(spec, image, planar);
+
+    ASSERT_EQ(simd_float.size(), scalar_float.size());
+    for (size_t i = 0; i < simd_float.size(); i++) {
+        EXPECT_NEAR(simd_float[i], scalar_float[i], 1e-4f) << "at " << i;
+    }
+    // Fused multiply-add may move a value across a rounding boundary
+    ASSERT_EQ(simd_u8.size(), scalar_u8.size());
+    for (size_t i = 0; i < simd_u8.size(); i++) {
+        EXPECT_LE(std::abs(simd_u8[i] - scalar_u8[i]), 1) << "at " << i;
+    }
+}
+
+} // namespace
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,114 @@
+#include "inference/memory_blocks.h"
+#include <gtest/gtest.h>
+#include <cstring>
+
+namespace mobileai {
+namespace inference {
+namespace {
+
+MemoryBlock Block(size_t bytes, int first_use, int last_use, int64_t offset = -1) {
+    MemoryBlock block;
+    block.bytes = bytes;
+    block.first_use = first_use;
+    block.last_use = last_use;
+    block.offset = offset;
+    return block;
+}
+
+void ExpectNoLiveOverlap(const std::vector<MemoryBlock>& blocks) {
+    for (size_t i = 0; i < blocks.size(); i++) {
+        for (size_t j = i + 1; j < blocks.size(); j++) {
+            const MemoryBlock& a = blocks[i];
+            const MemoryBlock& b = blocks[j];
+            if (a.first_use > b.last_use || b.first_use > a.last_use) {
+                continue;
+            }
+            const bool disjoint = a.offset + static_cast<int64_t>(a.bytes) <= b.offset ||
+                                  b.offset + static_cast<int64_t>(b.bytes) <= a.offset;
+            EXPECT_TRUE(disjoint) << "blocks " << i << " and " << j;
+        }
+    }
+}
+
+std::string OfflinePlan(const std::vector<int32_t>& values) {
+    std::string metadata(values.size() * sizeof(int32_t), '\0');
+    std::memcpy(&metadata[0], values.data(), metadata.size());
+    return metadata;
+}
+
+TEST(MemoryBlocksTest, BlocksWithDisjointLifetimesShareMemory) {
+    std::vector<MemoryBlock> blocks = {Block(1024, 0, 1), Block(512, 2, 3), Block(256, 4, 4)};
+    size_t arena = 0;
+    ASSERT_TRUE(PlanMemoryBlocks(&blocks, 64, &arena));
+    EXPECT_EQ(arena, 1024u);
+    for (const auto& block : blocks) {
+        EXPECT_EQ(block.offset, 0);
+    }
+}
+
+TEST(MemoryBlocksTest, LiveBlocksNeverOverlap) {
+    std::vector<MemoryBlock> blocks = {
+        Block(1000, 0, 2), Block(300, 1, 1), Block(2000, 2, 4), Block(700, 3, 5),
+        Block(100, 0, 5), Block(1500, 5, 6), Block(64, 4, 6), Block(900, 1, 3),
+    };
+    size_t arena = 0;
+    ASSERT_TRUE(PlanMemoryBlocks(&blocks, 64, &arena));
+    ExpectNoLiveOverlap(blocks);
+    for (const auto& block : blocks) {
+        EXPECT_EQ(block.offset % 64, 0);
+        EXPECT_LE(static_cast<size_t>(block.offset) + block.bytes, arena);
+    }
+    EXPECT_GE(arena, PeakLiveBytes(blocks, 1));
+}
+
+TEST(MemoryBlocksTest, SmallBlockFillsGapBetweenLiveBlocks) {
+    // The 1024-byte block dies before the 256-byte one is born, leaving a
+    // gap below the long-lived 512-byte block
+    std::vector<MemoryBlock> blocks = {Block(1024, 0, 1), Block(512, 0, 3), Block(256, 2, 3)};
+    size_t arena = 0;
+    ASSERT_TRUE(PlanMemoryBlocks(&blocks, 16, &arena));
+    EXPECT_EQ(arena, 1536u);
+    EXPECT_EQ(blocks[2].offset, 0);
+    ExpectNoLiveOverlap(blocks);
+}
+
+TEST(MemoryBlocksTest, PreassignedBlocksKeepTheirOffsets) {
+    std::vector<MemoryBlock> blocks = {Block(256, 0, 2, 512), Block(512, 1, 2)};
+    size_t arena = 0;
+    ASSERT_TRUE(PlanMemoryBlocks(&blocks, 16, &arena));
+    EXPECT_EQ(blocks[0].offset, 512);
+    EXPECT_EQ(blocks[1].offset, 0);
+    EXPECT_EQ(arena, 768u);
+}
+
+TEST(MemoryBlocksTest, OverlappingPreassignedBlocksAreRejected) {
+    std::vector<MemoryBlock> blocks = {Block(256, 0, 2, 0), Block(256, 1, 3, 128)};
+    size_t arena = 0;
+    EXPECT_FALSE(PlanMemoryBlocks(&blocks, 16, &arena));
+
+    // The same placement is fine when the blocks are never live together
+    blocks = {Block(256, 0, 1, 0), Block(256, 2, 3, 128)};
+    EXPECT_TRUE(PlanMemoryBlocks(&blocks, 16, &arena));
+}
+
+TEST(MemoryBlocksTest, PeakLiveBytesRoundsEachBlockUp) {
+    std::vector<MemoryBlock> blocks = {Block(100, 0, 1), Block(10, 1, 2), Block(1000, 2, 2)};
+    EXPECT_EQ(PeakLiveBytes(blocks, 1), 1010u);
+    EXPECT_EQ(PeakLiveBytes(blocks, 64), 1088u);
+    EXPECT_EQ(PeakLiveBytes({}, 64), 0u);
+}
+
+TEST(MemoryBlocksTest, ParsesOfflinePlanForItsSubgraph) {
+    std::vector<int64_t> offsets;
+    ASSERT_TRUE(ParseOfflineMemoryPlan(OfflinePlan({1, 0, 3, 0, -1, 64}), 0, &offsets));
+    EXPECT_EQ(offsets, (std::vector<int64_t>{0, -1, 64}));
+
+    EXPECT_FALSE(ParseOfflineMemoryPlan(OfflinePlan({1, 0, 3, 0, -1, 64}), 1, &offsets));
+    EXPECT_FALSE(ParseOfflineMemoryPlan(OfflinePlan({2, 0, 1, 0}), 0, &offsets));
+    EXPECT_FALSE(ParseOfflineMemoryPlan(OfflinePlan({1, 0, 4, 0, -1, 64}), 0, &offsets));
+    EXPECT_FALSE(ParseOfflineMemoryPlan(std::string("\x01\x00", 2), 0, &offsets));
+}
+
+} // namespace
+} // namespace inference
+} // namespace mobileai
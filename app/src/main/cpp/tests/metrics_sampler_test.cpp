@@ -0,0 +1,89 @@
+#include "monitoring/metrics_sampler.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace mobileai {
+namespace monitoring {
+namespace {
+
+TEST(ProcStatTest, ParsesCpuTimeAndResidentPages) {
+    // Command names may contain spaces and parentheses
+    const char* line =
+        "4242 (my (odd) app) S 1 4242 4242 0 -1 4194560 1523 0 12 0 "
+        "731 209 0 0 20 0 17 0 88123 2147483648 5120 18446744073709551615 "
+        "1 1 0 0 0 0 0 4096 1260 0 0 0 17 3 0 0 0 0 0\n";
+    ProcStatFields fields;
+    ASSERT_TRUE(ProcessStatsSampler::ParseProcStat(line, &fields));
+    EXPECT_EQ(fields.cpu_ticks, 731u + 209u);
+    EXPECT_EQ(fields.resident_pages, 5120u);
+}
+
+TEST(ProcStatTest, RejectsTruncatedLines) {
+    ProcStatFields fields;
+    EXPECT_FALSE(ProcessStatsSampler::ParseProcStat("", &fields));
+    EXPECT_FALSE(ProcessStatsSampler::ParseProcStat("4242 app S 1 4242", &fields));
+    EXPECT_FALSE(ProcessStatsSampler::ParseProcStat("4242 (app) S 1 4242 4242 0 -1 4194560", &fields));
+}
+
+TEST(ProcessStatsSamplerTest, ReportsThisProcess) {
+    ProcessStatsSampler sampler(std::chrono::milliseconds(10));
+    EXPECT_GT(sampler.Get().memory_usage_mb, 0.0f);
+    EXPECT_EQ(ProcessStatsSampler::Shared(), ProcessStatsSampler::Shared());
+}
+
+// Each thread records 1..100 ms once per round, so the exact percentiles
+// are 50, 95 and 99 ms
+TEST(LatencyRecorderTest, ConcurrentRecordsAreAllCounted) {
+    constexpr int kThreads = 8;
+    constexpr int kRounds = 50;
+    LatencyRecorder recorder;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+        threads.emplace_back([&recorder] {
+            for (int round = 0; round < kRounds; round++) {
+                for (int ms = 1; ms <= 100; ms++) {
+                    recorder.Record(static_cast<float>(ms), ms % 10 != 0);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    LatencySnapshot snapshot = recorder.Snapshot();
+    EXPECT_EQ(snapshot.requests, static_cast<uint64_t>(kThreads * kRounds * 100));
+    EXPECT_EQ(snapshot.failures, static_cast<uint64_t>(kThreads * kRounds * 10));
+    EXPECT_NEAR(snapshot.average_ms, 50.5f, 0.01f);
+    EXPECT_FLOAT_EQ(snapshot.max_ms, 100.0f);
+
+    const float tolerance = std::sqrt(2.0f) * 1.001f;
+    const std::pair<float, float> percentiles[] = {
+        {snapshot.p50_ms, 50.0f}, {snapshot.p95_ms, 95.0f}, {snapshot.p99_ms, 99.0f}};
+    for (const auto& percentile : percentiles) {
+        EXPECT_GE(percentile.first, percentile.second / tolerance);
+        EXPECT_LE(percentile.first, percentile.second * tolerance);
+    }
+    EXPECT_LE(snapshot.p50_ms, snapshot.p95_ms);
+    EXPECT_LE(snapshot.p95_ms, snapshot.p99_ms);
+}
+
+TEST(LatencyRecorderTest, ResetClearsEverySlot) {
+    LatencyRecorder recorder;
+    std::thread([&recorder] { recorder.Record(5.0f, false); }).join();
+    recorder.Record(3.0f, true);
+    recorder.Reset();
+
+    LatencySnapshot snapshot = recorder.Snapshot();
+    EXPECT_EQ(snapshot.requests, 0u);
+    EXPECT_EQ(snapshot.failures, 0u);
+    EXPECT_EQ(snapshot.max_ms, 0.0f);
+    EXPECT_EQ(snapshot.p99_ms, 0.0f);
+}
+
+} // namespace
+} // namespace monitoring
+} // namespace mobileai
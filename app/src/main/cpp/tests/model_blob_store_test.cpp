@@ -0,0 +1,71 @@
+#include "core/model_blob_store.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+
+namespace mobileai {
+namespace core {
+namespace {
+
+class ModelBlobStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = std::filesystem::temp_directory_path() /
+               ("model_blob_store_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) +
+                "_" + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        std::filesystem::create_directories(dir_);
+    }
+
+    void TearDown() override {
+        std::error_code ec;
+        std::filesystem::remove_all(dir_, ec);
+    }
+
+    std::string Write(const std::string& name, const std::string& contents) {
+        const std::string path = (dir_ / name).string();
+        std::ofstream(path, std::ios::binary) << contents;
+        return path;
+    }
+
+    std::filesystem::path dir_;
+};
+
+TEST_F(ModelBlobStoreTest, IdenticalFilesShareOneMapping) {
+    auto& store = ModelBlobStore::Instance();
+    auto a = store.Acquire(Write("a.tflite", "weights-0123456789"));
+    auto b = store.Acquire(Write("b.tflite", "weights-0123456789"));
+    ASSERT_TRUE(a);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(store.Acquire(a->path()), a);
+}
+
+TEST_F(ModelBlobStoreTest, SameSizeDifferentContentsAreKeptApart) {
+    auto& store = ModelBlobStore::Instance();
+    auto a = store.Acquire(Write("a.tflite", "weights-0123456789"));
+    auto b = store.Acquire(Write("b.tflite", "weights-9876543210"));
+    ASSERT_TRUE(a && b);
+    EXPECT_NE(a, b);
+    EXPECT_NE(a->content_hash(), b->content_hash());
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(b->data()), b->size()), "weights-9876543210");
+}
+
+TEST_F(ModelBlobStoreTest, ContentHashIsStableAcrossPaths) {
+    auto& store = ModelBlobStore::Instance();
+    auto a = store.Acquire(Write("a.tflite", "hash-me"));
+    ASSERT_TRUE(a);
+    const uint64_t hash = a->content_hash();
+    a.reset();
+
+    // Once unmapped, the next load maps the file afresh
+    auto b = store.Acquire(Write("b.tflite", "hash-me"));
+    ASSERT_TRUE(b);
+    EXPECT_EQ(b->content_hash(), hash);
+}
+
+TEST_F(ModelBlobStoreTest, MissingFileFails) {
+    EXPECT_FALSE(ModelBlobStore::Instance().Acquire((dir_ / "missing.tflite").string()));
+}
+
+} // namespace
+} // namespace core
+} // namespace mobileai
@@ -0,0 +1,128 @@
+#include "inference/model_cascade.h"
+#include "fake_model_engine.h"
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace mobileai {
+namespace inference {
+namespace {
+
+// The fake engines echo their input; a negative first value fails the run.
+// Stage confidences are fixed, so the thresholds alone decide escalation.
+class ModelCascadeTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        testing::SetFakeInference([](const std::vector<float>& input, std::vector<float>& output) {
+            output = input;
+            return input[0] >= 0.0f;
+        });
+    }
+
+    void TearDown() override {
+        testing::SetFakeInference(nullptr);
+    }
+
+    static CascadeStage Stage(const std::string& name, float confidence, float threshold) {
+        CascadeStage stage;
+        stage.name = name;
+        stage.engine = std::make_shared<ModelEngine>();
+        stage.confidence = [confidence](const std::vector<float>&) { return confidence; };
+        stage.threshold = threshold;
+        return stage;
+    }
+};
+
+TEST_F(ModelCascadeTest, AcceptsTheFirstConfidentStage) {
+    ModelCascade cascade({Stage("small", 0.95f, 0.9f), Stage("large", 1.0f, 0.9f)});
+    std::vector<float> output;
+    CascadeResult result;
+    ASSERT_TRUE(cascade.RunInference({1.0f, 2.0f}, output, &result));
+    EXPECT_EQ(output, (std::vector<float>{1.0f, 2.0f}));
+    EXPECT_EQ(result.stage, 0u);
+    EXPECT_FLOAT_EQ(result.confidence, 0.95f);
+
+    CascadeStats stats = cascade.GetStats();
+    EXPECT_EQ(stats.requests, 1u);
+    EXPECT_EQ(stats.stages[0].accepted, 1u);
+    EXPECT_EQ(stats.stages[1].requests, 0u);
+}
+
+TEST_F(ModelCascadeTest, EscalatesBelowTheThreshold) {
+    ModelCascade cascade({Stage("small", 0.5f, 0.9f), Stage("medium", 0.7f, 0.9f),
+                          Stage("large", 0.1f, 0.9f)});
+    std::vector<float> output;
+    CascadeResult result;
+
+    // The last stage is accepted whatever its confidence
+    ASSERT_TRUE(cascade.RunInference({1.0f}, output, &result));
+    EXPECT_EQ(result.stage, 2u);
+
+    // Exactly at the threshold counts as confident
+    cascade.SetThreshold(1, 0.7f);
+    ASSERT_TRUE(cascade.RunInference({1.0f}, output, &result));
+    EXPECT_EQ(result.stage, 1u);
+    EXPECT_FLOAT_EQ(result.confidence, 0.7f);
+
+    cascade.SetThreshold(0, 0.4f);
+    ASSERT_TRUE(cascade.RunInference({1.0f}, output, &result));
+    EXPECT_EQ(result.stage, 0u);
+
+    CascadeStats stats = cascade.GetStats();
+    EXPECT_EQ(stats.requests, 3u);
+    EXPECT_EQ(stats.stages[0].requests, 3u);
+    EXPECT_EQ(stats.stages[1].requests, 2u);
+    EXPECT_EQ(stats.stages[2].requests, 1u);
+}
+
+TEST_F(ModelCascadeTest, FailedStagesEscalate) {
+    std::vector<CascadeStage> stages = {Stage("small", 1.0f, 0.9f), Stage("large", 1.0f, 0.9f)};
+    stages[0].engine.reset();
+    ModelCascade cascade(std::move(stages));
+    std::vector<float> output;
+    CascadeResult result;
+    ASSERT_TRUE(cascade.RunInference({1.0f}, output, &result));
+    EXPECT_EQ(result.stage, 1u);
+
+    // When every stage fails, so does the request
+    output = {5.0f};
+    EXPECT_FALSE(cascade.RunInference({-1.0f}, output, &result));
+    EXPECT_TRUE(output.empty());
+    EXPECT_EQ(cascade.GetStats().failures, 1u);
+
+    cascade.ResetStats();
+    EXPECT_EQ(cascade.GetStats().requests, 0u);
+    EXPECT_EQ(cascade.GetStats().failures, 0u);
+}
+
+TEST_F(ModelCascadeTest, EveryStageSeesThePreparedInput) {
+    ModelCascade cascade({Stage("small", 0.0f, 0.9f), Stage("large", 0.0f, 0.9f)},
+                         [](const std::vector<float>& input, std::vector<float>& prepared) {
+                             if (input.empty()) {
+                                 return false;
+                             }
+                             prepared.assign(input.begin(), input.end());
+                             prepared.push_back(9.0f);
+                             return true;
+                         });
+    std::vector<float> output;
+    ASSERT_TRUE(cascade.RunInference({1.0f}, output));
+    EXPECT_EQ(output, (std::vector<float>{1.0f, 9.0f}));
+
+    EXPECT_FALSE(cascade.RunInference({}, output));
+    EXPECT_EQ(cascade.GetStats().failures, 1u);
+}
+
+TEST(CascadeConfidenceTest, SoftmaxMeasures) {
+    EXPECT_FLOAT_EQ(MaxSoftmaxConfidence({0.0f, 0.0f}), 0.5f);
+    EXPECT_FLOAT_EQ(MaxSoftmaxConfidence({std::log(3.0f), 0.0f}), 0.75f);
+    EXPECT_FLOAT_EQ(SoftmaxMarginConfidence({std::log(3.0f), 0.0f}), 0.5f);
+    // Large logits must not overflow
+    EXPECT_NEAR(MaxSoftmaxConfidence({1000.0f, 0.0f}), 1.0f, 1e-6f);
+    EXPECT_FLOAT_EQ(MaxProbabilityConfidence({0.2f, 0.7f, 0.1f}), 0.7f);
+    EXPECT_EQ(MaxSoftmaxConfidence({}), 0.0f);
+    EXPECT_EQ(MaxProbabilityConfidence({}), 0.0f);
+}
+
+} // namespace
+} // namespace inference
+} // namespace mobileai
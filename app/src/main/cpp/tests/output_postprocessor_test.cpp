@@ -0,0 +1,165 @@
+#include "inference/output_postprocessor.h"
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace mobileai {
+namespace inference {
+namespace {
+
+template <typename T>
+TensorView View(std::vector<T>& values) {
+    TensorView view;
+    view.data = values.data();
+    view.bytes = values.size() * sizeof(T);
+    view.type = TensorTypeOf<T>::value;
+    return view;
+}
+
+TensorInfo Info(TensorType type, std::vector<int64_t> shape, float scale = 0.0f, int32_t zero_point = 0) {
+    TensorInfo info;
+    info.type = type;
+    info.shape = std::move(shape);
+    info.quantization.scale = scale;
+    info.quantization.zero_point = zero_point;
+    return info;
+}
+
+TEST(TopKTest, ReturnsLargestEntriesBestFirst) {
+    std::vector<float> logits = {0.1f, 2.0f, -1.0f, 3.5f, 0.7f, 2.0f};
+    std::vector<Classification> results;
+    ASSERT_TRUE(TopK(View(logits), Info(TensorType::FLOAT32, {1, 6}), 3, false, &results));
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[0].index, 3);
+    EXPECT_FLOAT_EQ(results[0].score, 3.5f);
+    EXPECT_FLOAT_EQ(results[1].score, 2.0f);
+    EXPECT_FLOAT_EQ(results[2].score, 2.0f);
+    EXPECT_TRUE((results[1].index == 1 && results[2].index == 5) ||
+                (results[1].index == 5 && results[2].index == 1));
+}
+
+TEST(TopKTest, SoftmaxScoresAreProbabilitiesOverAllEntries) {
+    std::vector<float> logits = {1.0f, 2.0f, 3.0f, 4.0f};
+    std::vector<Classification> results;
+    ASSERT_TRUE(TopK(View(logits), Info(TensorType::FLOAT32, {4}), 2, true, &results));
+    ASSERT_EQ(results.size(), 2u);
+
+    float denominator = 0.0f;
+    for (float logit : logits) {
+        denominator += std::exp(logit);
+    }
+    EXPECT_EQ(results[0].index, 3);
+    EXPECT_NEAR(results[0].score, std::exp(4.0f) / denominator, 1e-4f);
+    EXPECT_EQ(results[1].index, 2);
+    EXPECT_NEAR(results[1].score, std::exp(3.0f) / denominator, 1e-4f);
+}
+
+TEST(TopKTest, QuantizedScoresAreDequantized) {
+    std::vector<uint8_t> scores = {10, 200, 128, 50};
+    std::vector<Classification> results;
+    ASSERT_TRUE(TopK(View(scores), Info(TensorType::UINT8, {1, 4}, 0.5f, 128), 2, false, &results));
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].index, 1);
+    EXPECT_FLOAT_EQ(results[0].score, 36.0f);
+    EXPECT_EQ(results[1].index, 2);
+    EXPECT_FLOAT_EQ(results[1].score, 0.0f);
+}
+
+TEST(TopKTest, KIsClampedToTheEntryCount) {
+    std::vector<float> logits = {1.0f, 0.0f};
+    std::vector<Classification> results;
+    ASSERT_TRUE(TopK(View(logits), Info(TensorType::FLOAT32, {2}), 5, false, &results));
+    EXPECT_EQ(results.size(), 2u);
+}
+
+TEST(SoftmaxTest, SumsToOneAndWorksInPlace) {
+    std::vector<float> values = {1000.0f, 1001.0f, 999.0f, -5.0f, 0.0f};
+    Softmax(values, values);
+    float sum = 0.0f;
+    for (float value : values) {
+        EXPECT_GE(value, 0.0f);
+        sum += value;
+    }
+    EXPECT_NEAR(sum, 1.0f, 1e-5f);
+    EXPECT_GT(values[1], values[0]);
+    EXPECT_GT(values[0], values[2]);
+}
+
+// Rows of xmin, ymin, xmax, ymax, then one score per class
+class DetectionsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        rows_ = {
+            0.00f, 0.00f, 0.50f, 0.50f,   0.90f, 0.10f,
+            0.02f, 0.02f, 0.52f, 0.52f,   0.80f, 0.10f,   // Overlaps row 0, same class
+            0.02f, 0.02f, 0.52f, 0.52f,   0.10f, 0.85f,   // Overlaps row 0, other class
+            0.60f, 0.60f, 1.00f, 1.00f,   0.70f, 0.00f,
+            0.60f, 0.00f, 1.00f, 0.40f,   0.30f, 0.20f,   // Below the threshold
+        };
+        info_ = Info(TensorType::FLOAT32, {1, 5, 6});
+        spec_.encoding = BoxEncoding::CORNERS;
+        spec_.score_offset = 4;
+        spec_.score_threshold = 0.5f;
+        spec_.iou_threshold = 0.5f;
+    }
+
+    std::vector<float> rows_;
+    TensorInfo info_;
+    DetectionSpec spec_;
+};
+
+TEST_F(DetectionsTest, SuppressesOverlapsWithinAClass) {
+    std::vector<Detection> detections;
+    ASSERT_TRUE(DecodeDetections(View(rows_), info_, View(rows_), info_, spec_, &detections));
+    ASSERT_EQ(detections.size(), 3u);
+    EXPECT_FLOAT_EQ(detections[0].score, 0.90f);
+    EXPECT_EQ(detections[0].class_id, 0);
+    EXPECT_FLOAT_EQ(detections[1].score, 0.85f);
+    EXPECT_EQ(detections[1].class_id, 1);
+    EXPECT_FLOAT_EQ(detections[2].score, 0.70f);
+    EXPECT_FLOAT_EQ(detections[2].xmin, 0.60f);
+}
+
+TEST_F(DetectionsTest, ClassAgnosticSuppressesAcrossClasses) {
+    spec_.class_agnostic = true;
+    std::vector<Detection> detections;
+    ASSERT_TRUE(DecodeDetections(View(rows_), info_, View(rows_), info_, spec_, &detections));
+    ASSERT_EQ(detections.size(), 2u);
+    EXPECT_FLOAT_EQ(detections[0].score, 0.90f);
+    EXPECT_FLOAT_EQ(detections[1].score, 0.70f);
+}
+
+TEST_F(DetectionsTest, StopsAtMaxDetections) {
+    spec_.max_detections = 1;
+    std::vector<Detection> detections;
+    ASSERT_TRUE(DecodeDetections(View(rows_), info_, View(rows_), info_, spec_, &detections));
+    ASSERT_EQ(detections.size(), 1u);
+    EXPECT_FLOAT_EQ(detections[0].score, 0.90f);
+}
+
+TEST_F(DetectionsTest, DecodesCenterSizeBoxes) {
+    std::vector<float> boxes = {0.5f, 0.5f, 0.2f, 0.4f};
+    std::vector<float> scores = {0.9f};
+    spec_.encoding = BoxEncoding::CENTER_SIZE;
+    spec_.score_offset = 0;
+    std::vector<Detection> detections;
+    ASSERT_TRUE(DecodeDetections(View(boxes), Info(TensorType::FLOAT32, {1, 1, 4}),
+                                 View(scores), Info(TensorType::FLOAT32, {1, 1, 1}),
+                                 spec_, &detections));
+    ASSERT_EQ(detections.size(), 1u);
+    EXPECT_FLOAT_EQ(detections[0].xmin, 0.4f);
+    EXPECT_FLOAT_EQ(detections[0].ymin, 0.3f);
+    EXPECT_FLOAT_EQ(detections[0].xmax, 0.6f);
+    EXPECT_FLOAT_EQ(detections[0].ymax, 0.7f);
+}
+
+TEST_F(DetectionsTest, RejectsMismatchedRowCounts) {
+    std::vector<float> scores = {0.9f, 0.1f};
+    std::vector<Detection> detections;
+    spec_.score_offset = 0;
+    EXPECT_FALSE(DecodeDetections(View(rows_), info_, View(scores), Info(TensorType::FLOAT32, {1, 1, 2}),
+                                  spec_, &detections));
+}
+
+} // namespace
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,126 @@
+#include "inference/pipeline_executor.h"
+#include "fake_model_engine.h"
+#include <gtest/gtest.h>
+#include <mutex>
+
+namespace mobileai {
+namespace inference {
+namespace {
+
+using ErrorCode = hardware::HardwareAccelerator::ErrorCode;
+
+// Every stage appends its position, which it can tell from the input's
+// length, so a frame's output records the order the stages ran in. A frame
+// whose first value is negative fails in the stage given by its magnitude.
+class PipelineExecutorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        testing::SetFakeInference([](const std::vector<float>& input, std::vector<float>& output) {
+            const float stage = static_cast<float>(input.size());
+            if (input[0] < 0.0f && -input[0] == stage) {
+                return false;
+            }
+            output = input;
+            output.push_back(stage);
+            return true;
+        });
+    }
+
+    void TearDown() override {
+        testing::SetFakeInference(nullptr);
+    }
+
+    static std::vector<PipelineStage> Stages(size_t count) {
+        std::vector<PipelineStage> stages;
+        for (size_t i = 0; i < count; i++) {
+            stages.push_back({"stage" + std::to_string(i), std::make_shared<ModelEngine>()});
+        }
+        return stages;
+    }
+};
+
+TEST_F(PipelineExecutorTest, StagesRunInOrder) {
+    PipelineExecutor pipeline(Stages(3));
+    ASSERT_TRUE(pipeline.Start());
+
+    InferenceResult result = pipeline.Submit({7.0f}).get();
+    ASSERT_TRUE(result.success);
+    EXPECT_EQ(result.error, ErrorCode::SUCCESS);
+    EXPECT_EQ(result.output, (std::vector<float>{7.0f, 1.0f, 2.0f, 3.0f}));
+
+    PipelineStats stats = pipeline.GetStats();
+    EXPECT_EQ(stats.frames_completed, 1u);
+    ASSERT_EQ(stats.stages.size(), 3u);
+    for (const auto& stage : stats.stages) {
+        EXPECT_EQ(stage.frames, 1u);
+    }
+    EXPECT_EQ(stats.stages[2].name, "stage2");
+}
+
+TEST_F(PipelineExecutorTest, FramesCompleteInSubmissionOrder) {
+    PipelineConfig config;
+    config.max_queue_size = 64;
+    PipelineExecutor pipeline(Stages(3), config);
+    ASSERT_TRUE(pipeline.Start());
+
+    std::mutex mutex;
+    std::vector<uint64_t> completed;
+    std::vector<std::future<InferenceResult>> futures;
+    for (int i = 0; i < 32; i++) {
+        futures.push_back(pipeline.Submit({static_cast<float>(i)}, [&](const InferenceResult& result) {
+            std::lock_guard<std::mutex> lock(mutex);
+            completed.push_back(result.request_id);
+        }));
+    }
+    for (int i = 0; i < 32; i++) {
+        InferenceResult result = futures[i].get();
+        ASSERT_TRUE(result.success);
+        EXPECT_EQ(result.output, (std::vector<float>{static_cast<float>(i), 1.0f, 2.0f, 3.0f}));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(completed.size(), 32u);
+    for (size_t i = 1; i < completed.size(); i++) {
+        EXPECT_LT(completed[i - 1], completed[i]);
+    }
+}
+
+TEST_F(PipelineExecutorTest, StageErrorsFailTheFrameOnly) {
+    PipelineExecutor pipeline(Stages(3));
+    ASSERT_TRUE(pipeline.Start());
+
+    InferenceResult failed = pipeline.Submit({-2.0f}).get();
+    EXPECT_FALSE(failed.success);
+    EXPECT_EQ(failed.error, ErrorCode::HARDWARE_ERROR);
+    EXPECT_TRUE(failed.output.empty());
+
+    InferenceResult next = pipeline.Submit({1.0f}).get();
+    EXPECT_TRUE(next.success);
+
+    PipelineStats stats = pipeline.GetStats();
+    EXPECT_EQ(stats.frames_failed, 1u);
+    EXPECT_EQ(stats.frames_completed, 1u);
+    EXPECT_EQ(stats.stages[1].frames, 2u);
+    EXPECT_EQ(stats.stages[2].frames, 1u);
+}
+
+TEST_F(PipelineExecutorTest, RejectsFramesWhenNotRunning) {
+    PipelineExecutor pipeline(Stages(2));
+    EXPECT_EQ(pipeline.Submit({1.0f}).get().error, ErrorCode::INITIALIZATION_FAILED);
+
+    ASSERT_TRUE(pipeline.Start());
+    pipeline.Stop();
+    EXPECT_FALSE(pipeline.IsRunning());
+    EXPECT_EQ(pipeline.Submit({1.0f}).get().error, ErrorCode::INITIALIZATION_FAILED);
+    // Start resets the stats, so only the second rejection is counted
+    EXPECT_EQ(pipeline.GetStats().frames_rejected, 1u);
+
+    std::vector<PipelineStage> missing = Stages(2);
+    missing[1].engine.reset();
+    EXPECT_FALSE(PipelineExecutor(std::move(missing)).Start());
+    EXPECT_FALSE(PipelineExecutor({}).Start());
+}
+
+} // namespace
+} // namespace inference
+} // namespace mobileai
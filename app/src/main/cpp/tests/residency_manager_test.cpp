@@ -0,0 +1,183 @@
+#include "inference/residency_manager.h"
+#include "fake_model_engine.h"
+#include <gtest/gtest.h>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace mobileai {
+namespace inference {
+namespace {
+
+constexpr size_t kMB = 1024 * 1024;
+
+// Models are sparse files whose size is both the manager's load estimate and
+// the weights the fake engine reports once loaded. A load of the held path
+// blocks until released.
+class ResidencyManagerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dir_ = std::filesystem::temp_directory_path() /
+               ("residency_manager_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) +
+                "_" + ::testing::UnitTest::GetInstance()->current_test_info()->name());
+        std::filesystem::create_directories(dir_);
+        testing::SetFakeLoad([this](const std::string& path, MemoryFootprint& footprint) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (path == held_path_) {
+                loading_ = true;
+                cv_.notify_all();
+                cv_.wait(lock, [this] { return held_path_.empty(); });
+            }
+            footprint.weights_bytes = std::filesystem::file_size(path);
+            footprint.arena_bytes = arena_bytes_[path];
+            return true;
+        });
+    }
+
+    void TearDown() override {
+        ReleaseLoad();
+        testing::SetFakeLoad(nullptr);
+        std::error_code ec;
+        std::filesystem::remove_all(dir_, ec);
+    }
+
+    void Register(ResidencyManager& manager, const std::string& model_id,
+                  size_t weights_mb, size_t arena_mb = 0) {
+        const std::string path = (dir_ / (model_id + ".tflite")).string();
+        std::ofstream(path, std::ios::binary).close();
+        std::filesystem::resize_file(path, weights_mb * kMB);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            arena_bytes_[path] = arena_mb * kMB;
+        }
+        auto engine = std::make_shared<ModelEngine>();
+        ASSERT_TRUE(manager.RegisterModel(model_id, engine, path, ModelFormat::TFLITE));
+    }
+
+    void HoldLoad(const std::string& model_id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_path_ = (dir_ / (model_id + ".tflite")).string();
+    }
+
+    void WaitForHeldLoad() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return loading_; });
+    }
+
+    void ReleaseLoad() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        held_path_.clear();
+        cv_.notify_all();
+    }
+
+    static ModelResidency Find(const ResidencyManager& manager, const std::string& model_id) {
+        for (const auto& residency : manager.GetResidency()) {
+            if (residency.model_id == model_id) {
+                return residency;
+            }
+        }
+        ADD_FAILURE() << "no residency for " << model_id;
+        return ModelResidency();
+    }
+
+    std::filesystem::path dir_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::map<std::string, size_t> arena_bytes_;
+    std::string held_path_;
+    bool loading_ = false;
+};
+
+TEST_F(ResidencyManagerTest, LoadsOnFirstAcquireOnly) {
+    ResidencyManager manager;
+    Register(manager, "a", 2);
+    EXPECT_EQ(manager.Acquire("unknown"), nullptr);
+    EXPECT_FALSE(Find(manager, "a").loaded);
+
+    auto lease = manager.Acquire("a");
+    ASSERT_TRUE(lease);
+    EXPECT_TRUE(lease->IsModelLoaded());
+    EXPECT_EQ(manager.Acquire("a"), lease);
+    EXPECT_EQ(Find(manager, "a").loads, 1u);
+    EXPECT_EQ(manager.GetResidentBytes(), 2 * kMB);
+}
+
+TEST_F(ResidencyManagerTest, EvictsUnpinnedModelsToFitTheBudget) {
+    ResidencyConfig config;
+    config.memory_budget_mb = 10;
+    ResidencyManager manager(config);
+    Register(manager, "a", 6);
+    Register(manager, "b", 6);
+
+    ASSERT_TRUE(manager.Acquire("a"));
+    ASSERT_TRUE(manager.Acquire("b"));
+    EXPECT_FALSE(Find(manager, "a").loaded);
+    EXPECT_EQ(Find(manager, "a").evictions, 1u);
+    EXPECT_TRUE(Find(manager, "b").loaded);
+    EXPECT_EQ(manager.GetResidentBytes(), 6 * kMB);
+}
+
+TEST_F(ResidencyManagerTest, LeasedModelsArePinned) {
+    ResidencyConfig config;
+    config.memory_budget_mb = 10;
+    ResidencyManager manager(config);
+    Register(manager, "a", 6);
+    Register(manager, "b", 6);
+
+    auto lease = manager.Acquire("a");
+    ASSERT_TRUE(lease);
+    ASSERT_TRUE(manager.Acquire("b"));
+    EXPECT_TRUE(lease->IsModelLoaded());
+    EXPECT_EQ(Find(manager, "a").evictions, 0u);
+
+    // Once released it is evictable again
+    lease.reset();
+    manager.SetMemoryBudget(10);
+    EXPECT_LE(manager.GetResidentBytes(), 10 * kMB);
+}
+
+TEST_F(ResidencyManagerTest, ShedsArenasBeforeUnloadingWeights) {
+    ResidencyConfig config;
+    config.memory_budget_mb = 10;
+    ResidencyManager manager(config);
+    Register(manager, "a", 4, 4);
+    Register(manager, "b", 4);
+
+    ASSERT_TRUE(manager.Acquire("a"));
+    EXPECT_EQ(manager.GetResidentBytes(), 8 * kMB);
+    ASSERT_TRUE(manager.Acquire("b"));
+    ModelResidency a = Find(manager, "a");
+    EXPECT_TRUE(a.loaded);
+    EXPECT_EQ(a.footprint.arena_bytes, 0u);
+    EXPECT_EQ(a.evictions, 0u);
+    EXPECT_EQ(manager.GetResidentBytes(), 8 * kMB);
+}
+
+TEST_F(ResidencyManagerTest, LoadsInProgressCountAgainstTheBudget) {
+    ResidencyConfig config;
+    config.memory_budget_mb = 10;
+    ResidencyManager manager(config);
+    Register(manager, "a", 4);
+    Register(manager, "b", 4);
+    Register(manager, "c", 4);
+    ASSERT_TRUE(manager.Acquire("c"));
+
+    // c fits beside a's reservation, but not beside a and b together
+    HoldLoad("a");
+    std::thread loader([&] { EXPECT_TRUE(manager.Acquire("a")); });
+    WaitForHeldLoad();
+    EXPECT_TRUE(Find(manager, "c").loaded);
+    ASSERT_TRUE(manager.Acquire("b"));
+    EXPECT_FALSE(Find(manager, "c").loaded);
+
+    ReleaseLoad();
+    loader.join();
+    EXPECT_TRUE(Find(manager, "a").loaded);
+}
+
+} // namespace
+} // namespace inference
+} // namespace mobileai
@@ -0,0 +1,149 @@
+#include "inference/result_cache.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace mobileai {
+namespace inference {
+namespace {
+
+// Compute that doubles the input and counts its runs
+ResultCache::Compute Doubler(const std::vector<float>& input, std::atomic<int>* runs) {
+    return [&input, runs](std::vector<float>& output) {
+        runs->fetch_add(1);
+        output.clear();
+        for (float value : input) {
+            output.push_back(2.0f * value);
+        }
+        return true;
+    };
+}
+
+// Bytes one entry with this many input and output elements is charged
+size_t EntryBytes(size_t elements) {
+    ResultCache cache(1 << 20);
+    std::vector<float> input(elements, 1.0f);
+    std::vector<float> output;
+    std::atomic<int> runs{0};
+    cache.GetOrCompute(1, input, output, Doubler(input, &runs));
+    return cache.GetStats().bytes;
+}
+
+TEST(ResultCacheTest, RepeatedInputIsServedFromTheCache) {
+    ResultCache cache(1 << 20);
+    std::vector<float> input = {1.0f, 2.0f, 3.0f};
+    std::vector<float> output;
+    std::atomic<int> runs{0};
+
+    ASSERT_TRUE(cache.GetOrCompute(1, input, output, Doubler(input, &runs)));
+    output.clear();
+    ASSERT_TRUE(cache.GetOrCompute(1, input, output, Doubler(input, &runs)));
+    EXPECT_EQ(output, (std::vector<float>{2.0f, 4.0f, 6.0f}));
+    EXPECT_EQ(runs.load(), 1);
+
+    ResultCacheStats stats = cache.GetStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.entries, 1u);
+}
+
+TEST(ResultCacheTest, ModelVersionIsPartOfTheKey) {
+    ResultCache cache(1 << 20);
+    std::vector<float> input = {1.0f};
+    std::vector<float> output;
+    std::atomic<int> runs{0};
+
+    cache.GetOrCompute(1, input, output, Doubler(input, &runs));
+    cache.GetOrCompute(2, input, output, Doubler(input, &runs));
+    EXPECT_EQ(runs.load(), 2);
+}
+
+TEST(ResultCacheTest, FailedRunsAreNotCached) {
+    ResultCache cache(1 << 20);
+    std::vector<float> input = {1.0f};
+    std::vector<float> output;
+    int runs = 0;
+    auto failing = [&runs](std::vector<float>&) {
+        runs++;
+        return false;
+    };
+
+    EXPECT_FALSE(cache.GetOrCompute(1, input, output, failing));
+    EXPECT_FALSE(cache.GetOrCompute(1, input, output, failing));
+    EXPECT_EQ(runs, 2);
+    EXPECT_EQ(cache.GetStats().entries, 0u);
+}
+
+TEST(ResultCacheTest, EvictsLeastRecentlyUsedWithinBudget) {
+    const size_t entry_bytes = EntryBytes(2);
+    ResultCache cache(entry_bytes * 2 + entry_bytes / 2);
+    std::vector<float> a = {1.0f, 1.0f};
+    std::vector<float> b = {2.0f, 2.0f};
+    std::vector<float> c = {3.0f, 3.0f};
+    std::vector<float> output;
+    std::atomic<int> runs{0};
+
+    cache.GetOrCompute(1, a, output, Doubler(a, &runs));
+    cache.GetOrCompute(1, b, output, Doubler(b, &runs));
+    cache.GetOrCompute(1, a, output, Doubler(a, &runs));   // a is now the most recent
+    cache.GetOrCompute(1, c, output, Doubler(c, &runs));   // Evicts b
+    EXPECT_EQ(runs.load(), 3);
+
+    cache.GetOrCompute(1, a, output, Doubler(a, &runs));
+    EXPECT_EQ(runs.load(), 3);
+    cache.GetOrCompute(1, b, output, Doubler(b, &runs));
+    EXPECT_EQ(runs.load(), 4);
+
+    ResultCacheStats stats = cache.GetStats();
+    EXPECT_EQ(stats.entries, 2u);
+    EXPECT_LE(stats.bytes, entry_bytes * 2);
+    EXPECT_EQ(stats.evictions, 2u);
+}
+
+TEST(ResultCacheTest, ConcurrentIdenticalRequestsComputeOnce) {
+    ResultCache cache(1 << 20);
+    std::vector<float> input = {4.0f};
+    std::atomic<int> runs{0};
+    auto slow = [&runs](std::vector<float>& output) {
+        runs.fetch_add(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        output = {8.0f};
+        return true;
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<std::vector<float>> outputs(4);
+    for (size_t i = 0; i < outputs.size(); i++) {
+        threads.emplace_back([&, i] { cache.GetOrCompute(1, input, outputs[i], slow); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(runs.load(), 1);
+    for (const auto& output : outputs) {
+        EXPECT_EQ(output, std::vector<float>{8.0f});
+    }
+    ResultCacheStats stats = cache.GetStats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.coalesced + stats.hits, 3u);
+}
+
+TEST(ResultCacheTest, ClearDropsEntries) {
+    ResultCache cache(1 << 20);
+    std::vector<float> input = {1.0f};
+    std::vector<float> output;
+    std::atomic<int> runs{0};
+
+    cache.GetOrCompute(1, input, output, Doubler(input, &runs));
+    cache.Clear();
+    EXPECT_EQ(cache.GetStats().entries, 0u);
+    EXPECT_EQ(cache.GetStats().bytes, 0u);
+    cache.GetOrCompute(1, input, output, Doubler(input, &runs));
+    EXPECT_EQ(runs.load(), 2);
+}
+
+} // namespace
+} // namespace inference
+} // namespace mobileai
@@ -54,12 +54,14 @@ class ModelManager(private val hardwareManager: HardwareManager) {
         }
 
         synchronized(this) {
-            if (isModelLoaded) {
-                release()
-            }
-            
             try {
-                if (nativeLoadModel(modelPath, format)) {
+                // Swap in place so requests keep being served during the update
+                val loaded = if (isModelLoaded) {
+                    nativeReplaceModel(modelPath, format)
+                } else {
+                    nativeLoadModel(modelPath, format)
+                }
+                if (loaded) {
                     isModelLoaded = true
                     currentModelPath = modelPath
                     currentFormat = format
@@ -214,6 +216,7 @@ class ModelManager(private val hardwareManager: HardwareManager) {
     }
 
     private external fun nativeLoadModel(modelPath: String, format: ModelFormat): Boolean
+    private external fun nativeReplaceModel(modelPath: String, format: ModelFormat): Boolean
     private external fun nativeRunInference(input: FloatArray): FloatArray
     private external fun nativeGetModelInfo(): String
     private external fun nativeSetNumThreads(numThreads: Int)